@@ -0,0 +1,109 @@
+/**
+ * \file
+ * \brief Benchmark for the callback receiving each decoded buffer, comparing the callable inlined
+ * into a templated loop against util::FunctionRef (used by Decoder) and std::function
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "util/function_ref.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using AudioCallback = util::FunctionRef<bool(void*, int, int64_t&)>;
+
+static constexpr int kChannels = 2;       //!< Number of interleaved channels
+static constexpr int kSamples = 1024;     //!< Frames per decoded buffer (as asked by Player)
+static constexpr int kBuffers = 1 << 20;  //!< Buffers sent to callback on each run
+static constexpr int kRuns = 5;           //!< Number of runs (best one is reported)
+
+/**
+ * @brief Same as done by FFmpeg::Decode, but without decoding: send the same buffer to callback
+ * until it asks to stop (kept out of line, as Decode lives in another translation unit)
+ */
+template <typename Callback>
+__attribute__((noinline)) int64_t DecodeLoop(float* buffer, Callback callback) {
+  int64_t position = 0;
+
+  for (int i = 0; i < kBuffers; i++) {
+    if (!callback(buffer, kSamples, position)) break;
+    position += kSamples;
+  }
+
+  return position;
+}
+
+//! Measure callback invoked through the given type, returning time spent per buffer (in ns)
+template <typename Callback, typename Callable>
+double BenchmarkCallback(Callable& callable) {
+  std::vector<float> buffer(kSamples * kChannels, 0.5f);
+  double best = 0;
+
+  for (int run = 0; run < kRuns; run++) {
+    auto start = Clock::now();
+    int64_t position = DecodeLoop<Callback>(buffer.data(), callable);
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+
+    if (position != static_cast<int64_t>(kBuffers) * kSamples) return -1;
+
+    double result = elapsed.count() / kBuffers;
+    if (run == 0 || result < best) best = result;
+  }
+
+  return best;
+}
+
+//! Print a single result line
+void Print(const std::string& name, double ns_per_buffer) {
+  std::cout << std::setw(40) << std::left << name;
+
+  if (ns_per_buffer < 0)
+    std::cout << "failed\n";
+  else
+    std::cout << std::fixed << std::setprecision(3) << ns_per_buffer << " ns/buffer\n";
+}
+
+//! Run benchmark for every way to pass the same callable
+template <typename Callable>
+void BenchmarkAll(Callable& callable) {
+  Print("  template (inlined)", BenchmarkCallback<Callable&>(callable));
+  Print("  util::FunctionRef", BenchmarkCallback<AudioCallback>(callable));
+  Print("  std::function", BenchmarkCallback<std::function<bool(void*, int, int64_t&)>>(callable));
+}
+
+}  // namespace
+
+/* ********************************************************************************************** */
+
+int main() {
+  std::cout << "Callback invoked for " << kBuffers << " buffers of " << kSamples
+            << " stereo frames, best of " << kRuns << " runs\n\n";
+
+  // Only the cost from calling it (checking a flag, as Player does without any command)
+  volatile bool keep_decoding = true;
+  auto empty = [&keep_decoding](void*, int, int64_t&) { return keep_decoding; };
+
+  std::cout << "Empty callback:\n";
+  BenchmarkAll(empty);
+
+  // Something closer to Player, which touches every sample (e.g. copying into audio buffer)
+  std::vector<float> output(kSamples * kChannels);
+  auto copy = [&output](void* buffer, int size, int64_t&) {
+    const auto* data = static_cast<const float*>(buffer);
+    std::copy(data, data + size * kChannels, output.begin());
+    return true;
+  };
+
+  std::cout << "\nCallback copying samples:\n";
+  BenchmarkAll(copy);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,131 @@
+/**
+ * \file
+ * \brief Benchmark for decoding speed (relative to realtime), comparing codec threading modes
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "audio/driver/ffmpeg.h"
+#include "model/application_error.h"
+#include "model/song.h"
+#include "wave_file.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr int kSampleRate = 44100;  //!< Sample rate (same as decoder output)
+static constexpr int kChannels = 2;        //!< Number of interleaved channels
+static constexpr int kDuration = 300;      //!< Audio duration for generated file (in seconds)
+static constexpr int kSamples = 1024;      //!< Maximum number of frames per buffer
+static constexpr int kRuns = 3;            //!< Number of runs (best one is reported)
+
+//! Threading modes to compare, as passed to decoder constructor
+static const std::vector<std::pair<std::string, int>> kModes{
+    {"off", driver::FFmpeg::kNoThreads},
+    {"2", 2},
+    {"4", 4},
+    {"auto", driver::FFmpeg::kAutoThreads},
+};
+
+//! Create interleaved stereo signal with a simple sine wave
+std::vector<float> CreateSignal(int frames) {
+  const double kPi = std::acos(-1);
+  std::vector<float> samples(static_cast<size_t>(frames) * kChannels);
+
+  for (int i = 0; i < frames; i++) {
+    auto value = static_cast<float>(0.5 * std::sin(2 * kPi * 440 * i / kSampleRate));
+    for (int channel = 0; channel < kChannels; channel++) samples[i * kChannels + channel] = value;
+  }
+
+  return samples;
+}
+
+//! Measure whole file decoding with the given number of threads, returning speed as x-realtime
+double BenchmarkDecode(int threads, const std::filesystem::path& filepath) {
+  double best = -1;
+
+  for (int run = 0; run < kRuns; run++) {
+    driver::FFmpeg decoder{driver::DspBackend::Filtergraph, true, threads};
+    model::Song song{.filepath = filepath.string()};
+    int64_t frames = 0;
+
+    auto start = Clock::now();
+
+    if (decoder.OpenFile(song) != error::kSuccess) return -1;
+
+    decoder.Decode(kSamples, [&](void*, int size, int64_t&) {
+      frames += size;
+      return true;
+    });
+
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+    decoder.ClearCache();
+
+    if (frames == 0 || elapsed.count() <= 0) return -1;
+
+    double speed = static_cast<double>(frames) / kSampleRate / elapsed.count();
+    if (speed > best) best = speed;
+  }
+
+  return best;
+}
+
+//! Print result line for a single file, with one column per threading mode
+void Print(const std::filesystem::path& filepath) {
+  std::string codec = filepath.extension().string();
+  if (!codec.empty()) codec.erase(0, 1);
+
+  std::cout << "  " << std::setw(8) << std::left << codec << std::setw(32)
+            << filepath.filename().string().substr(0, 30);
+
+  for (const auto& [name, threads] : kModes) {
+    double speed = BenchmarkDecode(threads, filepath);
+
+    if (speed < 0) {
+      std::cout << std::setw(12) << std::right << "failed";
+      continue;
+    }
+
+    std::cout << std::fixed << std::setprecision(1) << std::setw(11) << std::right << speed << "x";
+  }
+
+  std::cout << "\n";
+}
+
+}  // namespace
+
+/* ********************************************************************************************** */
+
+int main(int argc, char** argv) {
+  std::vector<std::filesystem::path> corpus{argv + 1, argv + argc};
+  std::filesystem::path generated;
+
+  // Without a corpus given by command-line, fallback to a generated WAV file (single-threaded)
+  if (corpus.empty()) {
+    generated = std::filesystem::temp_directory_path() / "spectrum_benchmark_threads.wav";
+    benchmark::CreateWaveFile(generated, CreateSignal(kSampleRate * kDuration), kChannels,
+                              kSampleRate);
+    corpus.push_back(generated);
+  }
+
+  std::cout << "Decoding speed (x-realtime) for each codec threading mode, best of " << kRuns
+            << " runs (file in page cache)\n\n";
+
+  std::cout << "  " << std::setw(8) << std::left << "codec" << std::setw(32) << "file";
+  for (const auto& mode : kModes) std::cout << std::setw(12) << std::right << mode.first;
+  std::cout << "\n";
+
+  for (const auto& filepath : corpus) Print(filepath);
+
+  if (!generated.empty()) std::filesystem::remove(generated);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,150 @@
+/**
+ * \file
+ * \brief Benchmark for volume and equalization, comparing native DSP chain against libavfilter
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "audio/driver/dsp_chain.h"
+#include "audio/driver/ffmpeg.h"
+#include "model/application_error.h"
+#include "model/audio_filter.h"
+#include "model/song.h"
+#include "model/volume.h"
+#include "wave_file.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Kernel = driver::DspChain::Kernel;
+
+static constexpr int kSampleRate = 44100;  //!< Sample rate
+static constexpr int kChannels = 2;        //!< Number of interleaved channels
+static constexpr int kDuration = 60;       //!< Audio duration used on each run (in seconds)
+static constexpr int kSamples = 1024;      //!< Maximum number of frames per buffer
+static constexpr int kRuns = 5;            //!< Number of runs (best one is reported)
+
+static constexpr char kPreset[] = "Rock";  //!< EQ preset used on every benchmark
+
+//! Create interleaved stereo signal mixing a bass and a treble sine wave
+std::vector<float> CreateSignal(int frames) {
+  const double kPi = std::acos(-1);
+  std::vector<float> samples(static_cast<size_t>(frames) * kChannels);
+
+  for (int i = 0; i < frames; i++) {
+    double t = static_cast<double>(i) / kSampleRate;
+    auto value = static_cast<float>(0.3 * std::sin(2 * kPi * 64 * t) +
+                                    0.2 * std::sin(2 * kPi * 9000 * t));
+
+    for (int channel = 0; channel < kChannels; channel++) samples[i * kChannels + channel] = value;
+  }
+
+  return samples;
+}
+
+//! Measure DspChain processing, returning time spent per sample (in nanoseconds)
+double BenchmarkKernel(Kernel kernel, const std::vector<float>& input) {
+  driver::DspChain chain{kChannels, kSampleRate, kernel};
+  chain.SetVolume(model::Volume{0.8f});
+  chain.UpdateFilters(model::AudioFilter::CreatePresets()[kPreset]);
+
+  std::vector<float> output(kSamples * kChannels);
+  const int frames = static_cast<int>(input.size()) / kChannels;
+  double best = 0;
+
+  for (int run = 0; run < kRuns; run++) {
+    auto start = Clock::now();
+
+    for (int offset = 0; offset < frames; offset += kSamples) {
+      int size = std::min(kSamples, frames - offset);
+      chain.Process(input.data() + offset * kChannels, output.data(), size);
+    }
+
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    double result = elapsed.count() / static_cast<double>(input.size());
+    if (run == 0 || result < best) best = result;
+  }
+
+  return best;
+}
+
+//! Measure decoding with FFmpeg, returning time spent per sample (in nanoseconds)
+double BenchmarkDecoder(driver::DspBackend backend, const std::filesystem::path& filepath) {
+  double best = 0;
+
+  for (int run = 0; run < kRuns; run++) {
+    driver::FFmpeg decoder{backend};
+    decoder.SetVolume(model::Volume{0.8f});
+    decoder.UpdateFilters(model::AudioFilter::CreatePresets()[kPreset]);
+
+    model::Song song{.filepath = filepath.string()};
+    if (decoder.OpenFile(song) != error::kSuccess) return -1;
+
+    int64_t samples = 0;
+    auto start = Clock::now();
+
+    decoder.Decode(kSamples, [&samples](void*, int size, int64_t&) {
+      samples += size * kChannels;
+      return true;
+    });
+
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    double result = elapsed.count() / static_cast<double>(samples);
+    if (run == 0 || result < best) best = result;
+
+    decoder.ClearCache();
+  }
+
+  return best;
+}
+
+//! Print a single result line
+void Print(const std::string& name, double ns_per_sample) {
+  std::cout << std::setw(40) << std::left << name;
+
+  if (ns_per_sample < 0)
+    std::cout << "failed\n";
+  else
+    std::cout << std::fixed << std::setprecision(3) << ns_per_sample << " ns/sample\n";
+}
+
+}  // namespace
+
+/* ********************************************************************************************** */
+
+int main() {
+  auto signal = CreateSignal(kSampleRate * kDuration);
+
+  std::cout << "Volume + " << model::equalizer::kFiltersPerPreset << " biquad filters (preset \""
+            << kPreset << "\") over " << kDuration << "s of stereo audio, best of " << kRuns
+            << " runs\n\n";
+
+  // Native DSP chain only (no decoding at all)
+  std::cout << "DspChain kernels:\n";
+  Print("  scalar", BenchmarkKernel(Kernel::Scalar, signal));
+
+  for (auto [kernel, name] : {std::pair{Kernel::Sse, "  sse2"}, std::pair{Kernel::Avx2, "  avx2"},
+                              std::pair{Kernel::Neon, "  neon"}}) {
+    if (driver::DspChain::IsSupported(kernel)) Print(name, BenchmarkKernel(kernel, signal));
+  }
+
+  // Complete decoding path (the same file for both backends)
+  auto filepath = std::filesystem::temp_directory_path() / "spectrum_benchmark.wav";
+  benchmark::CreateWaveFile(filepath, signal, kChannels, kSampleRate);
+
+  std::cout << "\nFFmpeg decoding:\n";
+  Print("  libavfilter (volume + equalizer)",
+        BenchmarkDecoder(driver::DspBackend::Filtergraph, filepath));
+  Print("  native DspChain", BenchmarkDecoder(driver::DspBackend::Native, filepath));
+
+  std::filesystem::remove(filepath);
+  return EXIT_SUCCESS;
+}
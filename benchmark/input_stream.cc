@@ -0,0 +1,130 @@
+/**
+ * \file
+ * \brief Benchmark for reading input stream, comparing memory-mapped file against default FFmpeg I/O
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "audio/driver/ffmpeg.h"
+#include "model/application_error.h"
+#include "model/song.h"
+#include "wave_file.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr int kSampleRate = 44100;  //!< Sample rate
+static constexpr int kChannels = 2;        //!< Number of interleaved channels
+static constexpr int kDuration = 300;      //!< Audio duration (in seconds)
+static constexpr int kSamples = 1024;      //!< Maximum number of frames per buffer
+static constexpr int kRuns = 5;            //!< Number of runs (best one is reported)
+
+//! Result from a single benchmark
+struct Result {
+  double latency_us = -1;       //!< Time from opening file until first decoded buffer
+  double syscalls_per_min = 0;  //!< Read syscalls issued per minute of decoded audio
+};
+
+//! Create interleaved stereo signal with a simple sine wave
+std::vector<float> CreateSignal(int frames) {
+  const double kPi = std::acos(-1);
+  std::vector<float> samples(static_cast<size_t>(frames) * kChannels);
+
+  for (int i = 0; i < frames; i++) {
+    auto value = static_cast<float>(0.5 * std::sin(2 * kPi * 440 * i / kSampleRate));
+    for (int channel = 0; channel < kChannels; channel++) samples[i * kChannels + channel] = value;
+  }
+
+  return samples;
+}
+
+//! Get number of read syscalls issued by this process so far (from procfs)
+int64_t CountReadSyscalls() {
+  std::ifstream file("/proc/self/io");
+  std::string key;
+  int64_t value = 0;
+
+  while (file >> key >> value) {
+    if (key == "syscr:") return value;
+  }
+
+  return 0;
+}
+
+//! Measure decoding, with or without memory-mapped file
+Result BenchmarkInput(bool map_files, const std::filesystem::path& filepath) {
+  Result best;
+
+  for (int run = 0; run < kRuns; run++) {
+    driver::FFmpeg decoder{driver::DspBackend::Filtergraph, map_files};
+    model::Song song{.filepath = filepath.string()};
+
+    int64_t syscalls = CountReadSyscalls();
+    auto start = Clock::now();
+    Clock::time_point first_sample;
+    int64_t frames = 0;
+
+    if (decoder.OpenFile(song) != error::kSuccess) return Result{};
+
+    decoder.Decode(kSamples, [&](void*, int size, int64_t&) {
+      if (frames == 0) first_sample = Clock::now();
+      frames += size;
+      return true;
+    });
+
+    syscalls = CountReadSyscalls() - syscalls;
+    decoder.ClearCache();
+
+    if (frames == 0) return Result{};
+
+    std::chrono::duration<double, std::micro> latency = first_sample - start;
+    double minutes = static_cast<double>(frames) / kSampleRate / 60;
+
+    if (run == 0 || latency.count() < best.latency_us) best.latency_us = latency.count();
+    best.syscalls_per_min = static_cast<double>(syscalls) / minutes;
+  }
+
+  return best;
+}
+
+//! Print a single result line
+void Print(const std::string& name, const Result& result) {
+  std::cout << std::setw(24) << std::left << name;
+
+  if (result.latency_us < 0) {
+    std::cout << "failed\n";
+    return;
+  }
+
+  std::cout << std::fixed << std::setprecision(1) << std::setw(12) << std::right
+            << result.latency_us << " us" << std::setw(12) << result.syscalls_per_min
+            << " read syscalls/min\n";
+}
+
+}  // namespace
+
+/* ********************************************************************************************** */
+
+int main() {
+  auto filepath = std::filesystem::temp_directory_path() / "spectrum_benchmark_input.wav";
+  benchmark::CreateWaveFile(filepath, CreateSignal(kSampleRate * kDuration), kChannels,
+                            kSampleRate);
+
+  std::cout << "Startup latency (until first decoded buffer) and read syscalls over " << kDuration
+            << "s of stereo audio, best of " << kRuns << " runs (file in page cache)\n\n";
+
+  Print("  default I/O", BenchmarkInput(false, filepath));
+  Print("  memory-mapped file", BenchmarkInput(true, filepath));
+
+  std::filesystem::remove(filepath);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,141 @@
+/**
+ * \file
+ * \brief Benchmark for control-to-audible latency and CPU wakeups, comparing latency profiles
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "audio/driver/alsa.h"
+#include "model/application_error.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr int kSampleRate = 44100;  //!< Sample rate
+static constexpr int kChannels = 2;        //!< Number of interleaved channels
+static constexpr int kDuration = 5;        //!< Audio duration played for each profile (in seconds)
+
+//! Latency profiles to compare
+static const std::vector<std::pair<std::string, driver::LatencyProfile>> kProfiles{
+    {"ultra-low", driver::LatencyProfile::UltraLow},
+    {"balanced", driver::LatencyProfile::Balanced},
+    {"power-save", driver::LatencyProfile::PowerSave},
+};
+
+//! Result from a single benchmark
+struct Result {
+  uint32_t period_size = 0;  //!< Period size granted by device (in frames)
+  uint32_t buffer_size = 0;  //!< Buffer size granted by device (in frames)
+  double mean_ms = -1;       //!< Average latency from control event until it is heard
+  double max_ms = 0;         //!< Worst latency from control event until it is heard
+  double wakeups = 0;        //!< Number of times per second that writer is woken up
+};
+
+//! Create interleaved stereo signal with a simple sine wave (quiet enough to play aloud)
+std::vector<float> CreateSignal(int frames) {
+  const double kPi = std::acos(-1);
+  std::vector<float> samples(static_cast<size_t>(frames) * kChannels);
+
+  for (int i = 0; i < frames; i++) {
+    auto value = static_cast<float>(0.05 * std::sin(2 * kPi * 440 * i / kSampleRate));
+    for (int channel = 0; channel < kChannels; channel++) samples[i * kChannels + channel] = value;
+  }
+
+  return samples;
+}
+
+/**
+ * Play signal on default device with the given latency profile, one period per callback (just like
+ * the playback thread from Player). A control event (pause, seek, volume...) happening at a random
+ * moment between two callbacks is picked up by the next one, on average half a callback later, and
+ * then it is only heard after every frame already queued in device buffer is played.
+ */
+Result BenchmarkProfile(driver::LatencyProfile profile, std::vector<float>& signal) {
+  driver::Alsa playback{true, driver::PlaybackAccess::Mmap, profile};
+
+  if (playback.CreatePlaybackStream() != error::kSuccess ||
+      playback.ConfigureParameters() != error::kSuccess ||
+      playback.Prepare() != error::kSuccess) {
+    return Result{};
+  }
+
+  auto period = static_cast<int>(playback.GetPeriodSize());
+  int frames = static_cast<int>(signal.size()) / kChannels;
+
+  double total_ms = 0, max_ms = 0;
+  int events = 0;
+
+  auto start = Clock::now();
+  auto previous = start;
+
+  for (int offset = 0; offset + period <= frames; offset += period) {
+    auto now = Clock::now();
+    double pickup_ms = std::chrono::duration<double, std::milli>(now - previous).count();
+    double queued_ms = static_cast<double>(playback.GetDelay()) * 1000 / kSampleRate;
+    previous = now;
+
+    // Skip the first callbacks, while device buffer is still being filled
+    if (offset >= static_cast<int>(playback.GetBufferSize())) {
+      total_ms += pickup_ms / 2 + queued_ms;
+      max_ms = std::max(max_ms, pickup_ms + queued_ms);
+      events++;
+    }
+
+    playback.AudioCallback(signal.data() + static_cast<size_t>(offset) * kChannels, period);
+  }
+
+  std::chrono::duration<double> elapsed = Clock::now() - start;
+  playback.Pause();
+
+  return Result{
+      .period_size = playback.GetPeriodSize(),
+      .buffer_size = playback.GetBufferSize(),
+      .mean_ms = events > 0 ? total_ms / events : 0,
+      .max_ms = max_ms,
+      .wakeups = static_cast<double>(frames / period) / elapsed.count(),
+  };
+}
+
+//! Print a single result line
+void Print(const std::string& name, const Result& result) {
+  std::cout << "  " << std::setw(12) << std::left << name;
+
+  if (result.mean_ms < 0) {
+    std::cout << "failed (no playback device)\n";
+    return;
+  }
+
+  std::cout << std::setw(8) << std::right << result.period_size << std::setw(8)
+            << result.buffer_size << std::fixed << std::setprecision(1) << std::setw(10)
+            << result.mean_ms << std::setw(10) << result.max_ms << std::setw(10) << result.wakeups
+            << "\n";
+}
+
+}  // namespace
+
+/* ********************************************************************************************** */
+
+int main() {
+  auto signal = CreateSignal(kSampleRate * kDuration);
+
+  std::cout << "Control-to-audible latency while playing " << kDuration
+            << "s of stereo audio on default device (with audio buffer from player disabled)\n\n";
+
+  std::cout << "  " << std::setw(12) << std::left << "profile" << std::setw(8) << std::right
+            << "period" << std::setw(8) << "buffer" << std::setw(10) << "mean ms" << std::setw(10)
+            << "max ms" << std::setw(10) << "wakeup/s"
+            << "\n";
+
+  for (const auto& [name, profile] : kProfiles) Print(name, BenchmarkProfile(profile, signal));
+
+  return EXIT_SUCCESS;
+}
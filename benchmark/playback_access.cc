@@ -0,0 +1,112 @@
+/**
+ * \file
+ * \brief Benchmark for writing samples into playback stream, comparing read/write and mmap access
+ */
+#include <time.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "audio/driver/alsa.h"
+#include "model/application_error.h"
+
+namespace {
+
+static constexpr int kSampleRate = 44100;  //!< Sample rate
+static constexpr int kChannels = 2;        //!< Number of interleaved channels
+static constexpr int kDuration = 10;       //!< Audio duration played for each access (in seconds)
+
+//! Result from a single benchmark
+struct Result {
+  double cpu_ms_per_min = -1;   //!< CPU time spent by process per minute of audio played
+  double copies_per_frame = 0;  //!< Number of times each frame was copied between buffers
+  bool fallback = false;        //!< Device does not support requested access
+};
+
+//! Get CPU time consumed by this process so far (in milliseconds)
+double GetCpuTime() {
+  timespec time{};
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+  return static_cast<double>(time.tv_sec) * 1e3 + static_cast<double>(time.tv_nsec) / 1e6;
+}
+
+//! Create interleaved stereo signal with a simple sine wave (quiet enough to play aloud)
+std::vector<float> CreateSignal(int frames) {
+  const double kPi = std::acos(-1);
+  std::vector<float> samples(static_cast<size_t>(frames) * kChannels);
+
+  for (int i = 0; i < frames; i++) {
+    auto value = static_cast<float>(0.05 * std::sin(2 * kPi * 440 * i / kSampleRate));
+    for (int channel = 0; channel < kChannels; channel++) samples[i * kChannels + channel] = value;
+  }
+
+  return samples;
+}
+
+//! Play signal on default device using the given access method
+Result BenchmarkAccess(driver::PlaybackAccess access, std::vector<float>& signal) {
+  driver::Alsa playback{true, access};
+
+  if (playback.CreatePlaybackStream() != error::kSuccess ||
+      playback.ConfigureParameters() != error::kSuccess ||
+      playback.Prepare() != error::kSuccess) {
+    return Result{};
+  }
+
+  auto period = static_cast<int>(playback.GetPeriodSize());
+  int frames = static_cast<int>(signal.size()) / kChannels;
+  double start = GetCpuTime();
+
+  // Write the whole signal in periods, just like the playback thread from Player
+  for (int offset = 0; offset + period <= frames; offset += period) {
+    playback.AudioCallback(signal.data() + static_cast<size_t>(offset) * kChannels, period);
+  }
+
+  playback.Stop();
+
+  double minutes = static_cast<double>(frames) / kSampleRate / 60;
+  auto statistics = playback.GetStatistics();
+
+  return Result{
+      .cpu_ms_per_min = (GetCpuTime() - start) / minutes,
+      .copies_per_frame = static_cast<double>(statistics.copied_frames) /
+                          static_cast<double>(std::max<int64_t>(statistics.frames, 1)),
+      .fallback = playback.GetAccess() != access,
+  };
+}
+
+//! Print a single result line
+void Print(const std::string& name, const Result& result) {
+  std::cout << std::setw(24) << std::left << name;
+
+  if (result.cpu_ms_per_min < 0) {
+    std::cout << "failed (no playback device)\n";
+    return;
+  }
+
+  std::cout << std::fixed << std::setprecision(1) << std::setw(10) << std::right
+            << result.cpu_ms_per_min << " ms CPU/min" << std::setw(8) << result.copies_per_frame
+            << " copies/frame" << (result.fallback ? " (fallback to read/write)" : "") << "\n";
+}
+
+}  // namespace
+
+/* ********************************************************************************************** */
+
+int main() {
+  auto signal = CreateSignal(kSampleRate * kDuration);
+
+  std::cout << "CPU time and copies per frame while playing " << kDuration
+            << "s of stereo audio (16-bit) on default device\n\n";
+
+  Print("  read/write access", BenchmarkAccess(driver::PlaybackAccess::ReadWrite, signal));
+  Print("  mmap access", BenchmarkAccess(driver::PlaybackAccess::Mmap, signal));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,60 @@
+/**
+ * \file
+ * \brief Helper to create WAV files used as input for benchmarking
+ */
+
+#ifndef BENCHMARK_WAVE_FILE_H_
+#define BENCHMARK_WAVE_FILE_H_
+
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace benchmark {
+
+/**
+ * @brief Write interleaved signal into a WAV file (using the same format as decoder output)
+ * @param filepath Path to output file
+ * @param samples Interleaved samples (in range [-1, 1])
+ * @param channels Number of channels
+ * @param sample_rate Sample rate
+ */
+inline void CreateWaveFile(const std::filesystem::path& filepath, const std::vector<float>& samples,
+                           int channels, int sample_rate) {
+  std::ofstream file(filepath, std::ios::binary);
+
+  // Write value in little-endian
+  auto write = [&file](uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) file.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+  };
+
+  const auto data_size = static_cast<uint32_t>(samples.size() * sizeof(int16_t));
+
+  // RIFF header
+  file << "RIFF";
+  write(36 + data_size, 4);
+  file << "WAVE";
+
+  // Format chunk (PCM)
+  file << "fmt ";
+  write(16, 4);
+  write(1, 2);
+  write(channels, 2);
+  write(sample_rate, 4);
+  write(sample_rate * channels * sizeof(int16_t), 4);
+  write(channels * sizeof(int16_t), 2);
+  write(16, 2);
+
+  // Data chunk
+  file << "data";
+  write(data_size, 4);
+
+  for (float sample : samples) {
+    write(static_cast<uint16_t>(static_cast<int16_t>(std::lrint(sample * 32767.f))), 2);
+  }
+}
+
+}  // namespace benchmark
+#endif  // BENCHMARK_WAVE_FILE_H_
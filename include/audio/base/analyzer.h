@@ -48,6 +48,19 @@ class Analyzer {
    */
   virtual int GetBufferSize() = 0;
 
+  /**
+   * @brief Set period size from playback stream, which decides how many samples are consumed on
+   * each analysis (so it runs at the same pace that samples are played)
+   * @param size Period size (in frames)
+   */
+  virtual void SetPeriodSize(int size) = 0;
+
+  /**
+   * @brief Set sample rate from audio data, which decides the frequency represented by each bar
+   * @param sample_rate Number of frames per second
+   */
+  virtual void SetSampleRate(int sample_rate) = 0;
+
   /**
    * @brief Get output buffer size
    * @return Size for output vector (considering number of bars multiplied per number of channels)
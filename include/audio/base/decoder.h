@@ -6,16 +6,25 @@
 #ifndef INCLUDE_AUDIO_BASE_DECODER_H_
 #define INCLUDE_AUDIO_BASE_DECODER_H_
 
-#include <functional>
 #include <vector>
 
 #include "model/application_error.h"
 #include "model/audio_filter.h"
+#include "model/audio_format.h"
 #include "model/song.h"
 #include "model/volume.h"
+#include "util/function_ref.h"
 
 namespace driver {
 
+/**
+ * @brief Implementation used to apply volume and equalization over decoded audio samples
+ */
+enum class DspBackend {
+  Filtergraph = 0,  //!< Filters from decoder library (e.g. libavfilter from FFmpeg)
+  Native = 1,       //!< Cascade of biquad filters using SIMD instructions (see DspChain)
+};
+
 /**
  * @brief Common interface to read audio file as an input stream, decode it, apply biquad IIR
  * filters on extracted audio data and finally, send the result to audio callback
@@ -36,10 +45,14 @@ class Decoder {
   //! Public API for Decoder
 
   /**
-   * @brief Function invoked after resample is available.
+   * @brief Function invoked after resample is available, receiving buffer with interleaved float
+   * samples, number of frames in buffer and position of its first frame (counted in samples at the
+   * output sample rate). Callback may change position to seek, so decoder jumps exactly to the new
+   * sample. It is only a reference to the callable object, which must live until Decode returns
+   * (it is invoked for every decoded buffer, so nothing is allocated or copied to pass it).
    * (for better understanding: take a look at Audio Loop from Player, and also Playback class)
    */
-  using AudioCallback = std::function<bool(void*, int, int64_t&)>;
+  using AudioCallback = util::FunctionRef<bool(void*, int, int64_t&)>;
 
   /**
    * @brief Open file as input stream and check for codec compatibility for decoding
@@ -48,6 +61,16 @@ class Decoder {
    */
   virtual error::Code OpenFile(model::Song& audio_info) = 0;
 
+  /**
+   * @brief Set format for decoded samples, agreed with playback. When it matches the song format,
+   * samples are not resampled at all
+   * @param format Audio format for decoded samples
+   * @param passthrough Allow to skip volume and equalizer while they would not change any sample
+   * (volume at maximum and flat equalizer), so decoded samples are bit-perfect
+   * @return error::Code Application error code
+   */
+  virtual error::Code SetOutputFormat(const model::AudioFormat& format, bool passthrough) = 0;
+
   /**
    * @brief Decode and resample input stream to desired sample format/rate
    * @param samples Maximum value of samples
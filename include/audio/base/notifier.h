@@ -67,13 +67,13 @@ class Notifier {
 
   /**
    * @brief Notify Audio Player to seek forward position in current playing song
-   * @param value Offset value
+   * @param value Offset value (in milliseconds)
    */
   virtual void SeekForwardPosition(int value) = 0;
 
   /**
    * @brief Notify Audio Player to seek backward position in current playing song
-   * @param value Offset value
+   * @param value Offset value (in milliseconds)
    */
   virtual void SeekBackwardPosition(int value) = 0;
 
@@ -82,6 +82,13 @@ class Notifier {
    * @param frequencies Vector of audio filters
    */
   virtual void ApplyAudioFilters(const model::EqualizerPreset& filters) = 0;
+
+  /**
+   * @brief Notify Audio Player about file expected to be played right after the current song, so
+   * it can be opened in advance and played without any gap
+   * @param file Full path to file (may be a song or not)
+   */
+  virtual void NotifyNextFileSelection(const std::filesystem::path& file) = 0;
 };
 
 }  // namespace interface
@@ -6,12 +6,45 @@
 #ifndef INCLUDE_AUDIO_BASE_PLAYBACK_H_
 #define INCLUDE_AUDIO_BASE_PLAYBACK_H_
 
+#include <array>
 #include <cstdint>
+#include <functional>
+#include <iostream>
+
 #include "model/application_error.h"
+#include "model/audio_format.h"
 #include "model/volume.h"
 
 namespace driver {
 
+/**
+ * @brief Method used to write samples into playback stream
+ */
+enum class PlaybackAccess {
+  ReadWrite = 0,  //!< Samples are converted into an intermediate buffer, then copied by driver
+  Mmap = 1,       //!< Samples are converted straight into device buffer, mapped into memory
+};
+
+/**
+ * @brief Trade-off between responsiveness and power consumption for playback stream, which decides
+ * buffer and period sizes requested to device (sizes effectively granted may differ a bit)
+ */
+enum class LatencyProfile {
+  UltraLow = 0,   //!< Around 10ms of buffered audio, so controls are heard almost immediately
+  Balanced = 1,   //!< Around 93ms of buffered audio (1024 frames per period at 44.1kHz)
+  PowerSave = 2,  //!< Around 500ms of buffered audio split in long periods, so CPU wakes up rarely
+};
+
+/**
+ * @brief Destination for samples played by player
+ */
+enum class PlaybackOutput {
+  Alsa = 0,  //!< Sound device, using ALSA
+  Null = 1,  //!< Nowhere, samples are discarded as soon as they arrive (or at real-time pace)
+  Wav = 2,   //!< WAV file
+  Raw = 3,   //!< Raw file, with interleaved samples and no header
+};
+
 /**
  * @brief Common interface to create and handle playback audio stream
  */
@@ -27,6 +60,42 @@ class Playback {
    */
   virtual ~Playback() = default;
 
+  /**
+   * @brief Counters from samples written into playback stream (telemetry)
+   */
+  struct Statistics {
+    static constexpr std::array<int64_t, 7> kJitterBounds{
+        100, 250, 500, 1000, 2000, 5000, 10000};  //!< Upper bound from each histogram bucket (in
+                                                  //!< microseconds), last bucket is unbounded
+
+    int64_t frames = 0;             //!< Number of frames written
+    int64_t copied_frames = 0;      //!< Number of frames copied between buffers (with conversion)
+    uint64_t underruns = 0;         //!< Number of times that device ran out of samples (xrun)
+    uint64_t recoveries = 0;        //!< Number of times that playback stream recovered from error
+    int64_t max_write_latency = 0;  //!< Longest time writing a single buffer (in microseconds)
+
+    std::array<uint64_t, kJitterBounds.size() + 1> jitter{};  //!< Histogram of deviation between
+                                                              //!< expected and real interval from
+                                                              //!< consecutive writes
+
+    //! Output statistics to ostream
+    friend std::ostream& operator<<(std::ostream& out, const Statistics& s) {
+      out << "{frames:" << s.frames << " copied_frames:" << s.copied_frames
+          << " underruns:" << s.underruns << " recoveries:" << s.recoveries
+          << " max_write_latency:" << s.max_write_latency << "us jitter:{";
+
+      for (size_t i = 0; i < s.jitter.size(); i++) {
+        if (i < kJitterBounds.size()) {
+          out << "<" << kJitterBounds[i] << "us:" << s.jitter[i] << " ";
+        } else {
+          out << ">=" << kJitterBounds.back() << "us:" << s.jitter[i];
+        }
+      }
+
+      return out << "}}";
+    }
+  };
+
   /* ******************************************************************************************** */
   //! Public API
 
@@ -42,6 +111,29 @@ class Playback {
    */
   virtual error::Code ConfigureParameters() = 0;
 
+  /**
+   * @brief Check if playback device accepts the given format (without changing current one)
+   * @param format Audio format
+   * @return true if format is supported, false otherwise
+   */
+  virtual bool IsFormatSupported(const model::AudioFormat& format) = 0;
+
+  /**
+   * @brief Reconfigure playback stream to use another format (samples already written to playback
+   * stream are played before changing it)
+   * @param format Audio format
+   * @return error::Code Playback error converted to application error code
+   */
+  virtual error::Code SetFormat(const model::AudioFormat& format) = 0;
+
+  /**
+   * @brief Reconfigure playback stream to use another latency profile (samples already written to
+   * playback stream are faded out and dropped, as this may be called from UI thread)
+   * @param profile Latency profile
+   * @return error::Code Playback error converted to application error code
+   */
+  virtual error::Code SetLatencyProfile(LatencyProfile profile) = 0;
+
   /**
    * @brief Make playback stream ready to play
    * @return error::Code Playback error converted to application error code
@@ -49,11 +141,18 @@ class Playback {
   virtual error::Code Prepare() = 0;
 
   /**
-   * @brief Pause current song on playback stream
+   * @brief Pause current song on playback stream, keeping samples already written to it (so they
+   * are played right after resume)
    * @return error::Code Playback error converted to application error code
    */
   virtual error::Code Pause() = 0;
 
+  /**
+   * @brief Resume current song on playback stream, after it was paused
+   * @return error::Code Playback error converted to application error code
+   */
+  virtual error::Code Resume() = 0;
+
   /**
    * @brief Stop playing song on playback stream
    * @return error::Code Playback error converted to application error code
@@ -61,10 +160,20 @@ class Playback {
   virtual error::Code Stop() = 0;
 
   /**
-   * @brief Directly write audio buffer to playback stream (this should be called by decoder)
+   * @brief Inform that no more samples are coming for now (song finished naturally), so samples
+   * already written are played even if they are not enough to start playback stream by itself
+   * (e.g. a song shorter than device buffer). It does not wait for them to be played.
+   * @return error::Code Playback error converted to application error code
+   */
+  virtual error::Code Finish() { return error::kSuccess; }
+
+  /**
+   * @brief Directly write audio buffer to playback stream (this should be called by decoder).
+   * Samples are converted to the format from playback stream only here, as the whole pipeline
+   * before it works with float samples
    *
-   * @param buffer Audio data buffer
-   * @param size Buffer size
+   * @param buffer Audio data buffer (interleaved float samples)
+   * @param size Buffer size (in frames)
    * @return error::Code Playback error converted to application error code
    */
   virtual error::Code AudioCallback(void* buffer, int size) = 0;
@@ -83,11 +192,33 @@ class Playback {
    */
   virtual model::Volume GetVolume() = 0;
 
+  //! Callback to inform about volume changed outside of this application (e.g. by another mixer)
+  using VolumeListener = std::function<void(model::Volume)>;
+
+  /**
+   * @brief Set listener for volume changes on playback stream (called from a background thread)
+   * @param listener Callback invoked only when volume value actually changes
+   */
+  virtual void SetVolumeListener(VolumeListener listener) = 0;
+
   /**
    * @brief Get period size
    * @return uint32_t Period size
    */
   virtual uint32_t GetPeriodSize() const = 0;
+
+  /**
+   * @brief Get counters from samples written into playback stream (safe to call from any thread)
+   * @return Statistics Counters
+   */
+  virtual Statistics GetStatistics() const = 0;
+
+  /**
+   * @brief Get number of frames already written but not heard yet, as measured right after the
+   * last write (safe to call from any thread). Playback without a device buffer has no delay.
+   * @return int64_t Delay (in frames)
+   */
+  virtual int64_t GetOutputDelay() const { return 0; }
 };
 
 }  // namespace driver
@@ -11,6 +11,7 @@
 #include <variant>
 #include <vector>
 
+#include "audio/base/playback.h"
 #include "model/audio_filter.h"
 #include "model/volume.h"
 
@@ -31,6 +32,7 @@ struct Command {
     SetVolume = 8006,
     UpdateAudioFilters = 8007,
     Exit = 8008,
+    SetLatencyProfile = 8009,
   };
 
   //! Overloaded operators
@@ -52,11 +54,12 @@ struct Command {
   static Command SeekBackward(int offset);
   static Command SetVolume(const model::Volume& value);
   static Command UpdateAudioFilters(const model::EqualizerPreset& filters);
+  static Command SetLatencyProfile(driver::LatencyProfile profile);
   static Command Exit();
 
   //! Possible types for content
-  using Content =
-      std::variant<std::monostate, std::string, int, model::Volume, model::EqualizerPreset>;
+  using Content = std::variant<std::monostate, std::string, int, model::Volume,
+                               model::EqualizerPreset, driver::LatencyProfile>;
 
   //! Getter for command identifier
   Identifier GetId() const { return id; }
@@ -8,10 +8,21 @@
 
 #include <alsa/asoundlib.h>
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "audio/base/playback.h"
+#include "audio/driver/sample_converter.h"
 #include "model/application_error.h"
+#include "model/audio_format.h"
 
 namespace driver {
 
@@ -22,13 +33,20 @@ class Alsa final : public Playback {
  public:
   /**
    * @brief Construct a new Alsa object
+   * @param dither Add TPDF dither when converting samples to 16 bits
+   * @param access Method used to write samples (in case that device does not support memory
+   * mapping, it falls back to read/write access)
+   * @param profile Latency profile deciding buffer and period sizes requested to device
+   * @param device Device requested by user (when empty, it is picked automatically)
    */
-  Alsa() = default;
+  explicit Alsa(bool dither = true, PlaybackAccess access = PlaybackAccess::Mmap,
+                LatencyProfile profile = LatencyProfile::Balanced, std::string device = "")
+      : device_{std::move(device)}, access_{access}, profile_{profile}, converter_{dither} {}
 
   /**
-   * @brief Destroy the Alsa object
+   * @brief Destroy the Alsa object (stopping mixer watcher thread, if running)
    */
-  ~Alsa() override = default;
+  ~Alsa() override;
 
   /* ******************************************************************************************** */
   //! Public API
@@ -39,11 +57,36 @@ class Alsa final : public Playback {
   error::Code CreatePlaybackStream() override;
 
   /**
-   * @brief Configure Playback Stream parameters (sample format, etc...) using ALSA API
+   * @brief Configure Playback Stream parameters (sample format, buffer and period sizes, etc...)
+   * using ALSA API
    * @return error::Code Playback error converted to application error code
    */
   error::Code ConfigureParameters() override;
 
+  /**
+   * @brief Check if playback device accepts the given format, by testing it against the hardware
+   * parameters space from ALSA API (without changing current configuration)
+   * @param format Audio format
+   * @return true if format is supported, false otherwise
+   */
+  bool IsFormatSupported(const model::AudioFormat& format) override;
+
+  /**
+   * @brief Reconfigure playback stream to use another format (after playing remaining samples,
+   * waiting for them no longer than kDrainTimeout)
+   * @param format Audio format
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code SetFormat(const model::AudioFormat& format) override;
+
+  /**
+   * @brief Reconfigure playback stream to use another latency profile (fading out and dropping
+   * remaining samples, instead of blocking caller until they are played)
+   * @param profile Latency profile
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code SetLatencyProfile(LatencyProfile profile) override;
+
   /**
    * @brief Ask ALSA API to make playback stream ready to play
    * @return error::Code Playback error converted to application error code
@@ -51,22 +94,38 @@ class Alsa final : public Playback {
   error::Code Prepare() override;
 
   /**
-   * @brief Pause current song on playback stream
+   * @brief Pause current song on playback stream, using hardware pause when device supports it
+   * (otherwise, stream is dropped and samples not played yet are kept to be written again)
    * @return error::Code Playback error converted to application error code
    */
   error::Code Pause() override;
 
   /**
-   * @brief Stop playing song on playback stream
+   * @brief Resume current song on playback stream, releasing hardware pause or writing again
+   * samples kept from pause
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code Resume() override;
+
+  /**
+   * @brief Stop playing song on playback stream right away, fading out samples about to be played
+   * instead of draining the whole device buffer
    * @return error::Code Playback error converted to application error code
    */
   error::Code Stop() override;
 
   /**
-   * @brief Directly write audio buffer to playback stream (this should be called by decoder)
+   * @brief Start playback stream in case that samples written so far did not reach its start
+   * threshold yet
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code Finish() override;
+
+  /**
+   * @brief Convert float samples to the format from playback stream and write them to it
    *
-   * @param buffer Audio data buffer
-   * @param size Buffer size
+   * @param buffer Audio data buffer (interleaved float samples)
+   * @param size Buffer size (in frames)
    * @return error::Code Playback error converted to application error code
    */
   error::Code AudioCallback(void* buffer, int size) override;
@@ -86,11 +145,55 @@ class Alsa final : public Playback {
   model::Volume GetVolume() override;
 
   /**
-   * @brief Get period size (previously filled by ALSA API)
+   * @brief Set listener for volume changes on master playback, made by any mixer (called from
+   * mixer watcher thread)
+   * @param listener Callback invoked only when volume value actually changes
+   */
+  void SetVolumeListener(VolumeListener listener) override;
+
+  /**
+   * @brief Get period size (granted by ALSA API, based on latency profile)
    * @return uint32_t Period size
    */
   uint32_t GetPeriodSize() const override { return (uint32_t)period_size_; }
 
+  /**
+   * @brief Get buffer size (granted by ALSA API, based on latency profile)
+   * @return uint32_t Buffer size (in frames)
+   */
+  uint32_t GetBufferSize() const { return (uint32_t)buffer_size_; }
+
+  /**
+   * @brief Get latency profile used by playback stream
+   * @return LatencyProfile Latency profile
+   */
+  LatencyProfile GetLatencyProfile() const { return profile_; }
+
+  /**
+   * @brief Get number of frames already written to playback stream but not heard yet (i.e. time
+   * that any change on samples takes to become audible)
+   * @return int64_t Delay (in frames), or zero when it cannot be queried
+   */
+  int64_t GetDelay();
+
+  /**
+   * @brief Get method effectively used to write samples (after fallback, if any)
+   * @return PlaybackAccess Access method
+   */
+  PlaybackAccess GetAccess() const { return access_; }
+
+  /**
+   * @brief Get counters from samples written into playback stream (safe to call from any thread)
+   * @return Statistics Counters
+   */
+  Statistics GetStatistics() const override;
+
+  /**
+   * @brief Get delay measured right after the last write (safe to call from any thread)
+   * @return int64_t Delay (in frames)
+   */
+  int64_t GetOutputDelay() const override { return output_delay_; }
+
   /* ******************************************************************************************** */
   //! Utility
  private:
@@ -100,12 +203,170 @@ class Alsa final : public Playback {
    */
   snd_mixer_elem_t* GetMasterPlayback();
 
+  /**
+   * @brief Read current volume from master playback (mixer must be locked by caller)
+   * @return model::Volume Volume percentage (in a range between 0.f and 1.f)
+   */
+  model::Volume ReadVolume();
+
+  /**
+   * @brief Wait for events from mixer (without polling it periodically), informing listener about
+   * volume changes until woken up by destructor
+   */
+  void WatchMixer();
+
+  /**
+   * @brief Convert audio format to PCM format (S16, S24 in 32 bits, S32 or float, little-endian)
+   * @param format Audio format
+   * @return PCM format from ALSA API (SND_PCM_FORMAT_UNKNOWN when not supported)
+   */
+  static snd_pcm_format_t ToPcmFormat(const model::AudioFormat& format);
+
+  /**
+   * @brief Set hardware parameters on playback stream, requesting buffer and period sizes
+   * explicitly (instead of letting ALSA decide them), based on latency profile
+   * @param access Access type from ALSA API
+   * @return int Zero on success, otherwise negative error code from ALSA API
+   */
+  int SetHardwareParameters(snd_pcm_access_t access);
+
+  /**
+   * @brief Set software parameters on playback stream, so writer is only woken up when there is
+   * room for a whole period
+   * @return int Zero on success, otherwise negative error code from ALSA API
+   */
+  int SetSoftwareParameters();
+
+  /**
+   * @brief Convert float samples to the format from playback stream
+   * @param input Interleaved float samples
+   * @param output Output buffer (with enough room for samples in playback stream format)
+   * @param frames Number of frames
+   */
+  void Convert(const float* input, void* output, snd_pcm_uframes_t frames);
+
+  /**
+   * @brief Convert samples into an intermediate buffer, which is copied by ALSA into device buffer
+   * @param input Interleaved float samples
+   * @param size Number of frames
+   */
+  void WriteInterleaved(const float* input, int size);
+
+  /**
+   * @brief Convert samples straight into device buffer, mapped into memory (so there is no
+   * intermediate buffer and no extra copy)
+   * @param input Interleaved float samples
+   * @param size Number of frames
+   */
+  void WriteMmap(const float* input, int size);
+
+  /**
+   * @brief Start playback stream that is still prepared, once the given number of frames is
+   * written into device buffer (snd_pcm_writei does the same by itself for the start threshold, but
+   * committing samples into mapped buffer never starts it)
+   * @param threshold Minimum number of frames written (at least one frame is always required)
+   */
+  void StartIfReady(snd_pcm_uframes_t threshold);
+
+  /**
+   * @brief Play samples remaining in device buffer and then drop playback stream, so it can be
+   * reconfigured (unlike snd_pcm_drain, waiting no longer than kDrainTimeout)
+   */
+  void PlayRemaining();
+
+  /**
+   * @brief Keep copy of the latest samples written (as many as fit in device buffer), used to
+   * write again samples dropped by pause when device cannot pause by itself, or to fade out samples
+   * taken back from device on stop
+   * @param input Interleaved float samples
+   * @param size Number of frames
+   */
+  void KeepHistory(const float* input, int size);
+
+  /**
+   * @brief Copy samples written to device but not played yet from history, so they are written
+   * again on resume
+   */
+  void SaveUnplayed();
+
+  /**
+   * @brief Take back queued samples from device buffer (as many as it allows) and write them again
+   * fading to silence, then wait for the fade to be played
+   */
+  void FadeOut();
+
+  /**
+   * @brief Update jitter histogram with interval since previous write (only while device is
+   * running, as writes are expected to follow the pace that device consumes samples)
+   * @param now Time when current write started
+   */
+  void UpdateJitter(std::chrono::steady_clock::time_point now);
+
+  /**
+   * @brief Try to recover playback stream from error (e.g. underrun)
+   * @param error Error returned by ALSA API
+   * @return true if playback stream was recovered, false otherwise
+   */
+  bool Recover(int error);
+
   /* ******************************************************************************************** */
   //! Default Constants for Audio Parameters
   static constexpr const char kSelemName[] = "Master";
   static constexpr int kChannels = 2;
   static constexpr int kSampleRate = 44100;
-  static constexpr snd_pcm_format_t kSampleFormat = SND_PCM_FORMAT_S16_LE;
+  static constexpr int kBitDepth = 16;
+  static constexpr int kWaitTimeout = 1000;  //!< Maximum wait for room in device buffer (in ms)
+  static constexpr int kFadeTime = 5;        //!< Fade out applied on stop (in ms)
+  static constexpr int kDrainTimeout = 600;  //!< Maximum wait for remaining samples (in ms)
+
+  /**
+   * @brief Buffer and period sizes requested to device for each latency profile
+   */
+  struct LatencyTarget {
+    unsigned int buffer_time;  //!< Buffer time (in microseconds)
+    unsigned int periods;      //!< Number of periods in buffer
+  };
+
+  /**
+   * @brief Get buffer and period sizes to request to device
+   * @param profile Latency profile
+   * @return LatencyTarget Buffer time and number of periods
+   */
+  static constexpr LatencyTarget GetLatencyTarget(LatencyProfile profile) {
+    switch (profile) {
+      case LatencyProfile::UltraLow:
+        return LatencyTarget{.buffer_time = 10000, .periods = 2};
+      case LatencyProfile::PowerSave:
+        return LatencyTarget{.buffer_time = 500000, .periods = 2};
+      case LatencyProfile::Balanced:
+      default:
+        // with latency as 92900us, we get a period size equal to 1024 (for 44100Hz)
+        return LatencyTarget{.buffer_time = 92900, .periods = 4};
+    }
+  }
+
+  /**
+   * @brief Counters updated by thread writing samples and read by any thread (one atomic per field,
+   * so writing thread never blocks)
+   */
+  struct AtomicStatistics {
+    std::atomic<int64_t> frames = 0;
+    std::atomic<int64_t> copied_frames = 0;
+    std::atomic<uint64_t> underruns = 0;
+    std::atomic<uint64_t> recoveries = 0;
+    std::atomic<int64_t> max_write_latency = 0;
+    std::array<std::atomic<uint64_t>, Statistics::kJitterBounds.size() + 1> jitter{};
+  };
+
+  /**
+   * @brief How playback stream was paused, which decides how to resume it
+   */
+  enum class PauseMethod {
+    None,        //!< Stream is not paused
+    NotStarted,  //!< Stream was not started yet, so samples just wait in device buffer
+    Hardware,    //!< Device paused by itself, keeping samples in its buffer
+    Requeue,     //!< Stream was dropped, and samples not played yet are written again on resume
+  };
 
   /* ******************************************************************************************** */
   //! Custom declarations with deleters
@@ -129,7 +390,39 @@ class Alsa final : public Playback {
 
   PcmPlayback playback_handle_;  //! Playback stream handled by ALSA API
   MixerControl mixer_;           //! High level control interface from ALSA API (to manage volume)
+  snd_mixer_elem_t* master_ = nullptr;  //! Master playback (resolved once, managed by mixer)
+  std::mutex mixer_mutex_;              //! Control access to mixer (shared with watcher thread)
+  VolumeListener volume_listener_;      //! Inform about volume changes made by any mixer
+  model::Volume volume_;                //! Last volume read, so only actual changes are informed
+  std::thread mixer_watcher_;           //! Wait for events from mixer
+  int wakeup_[2] = {-1, -1};            //! Pipe used to wake up mixer watcher on destruction
   snd_pcm_uframes_t period_size_ = 0;  //! Period size (necessary in order to discover buffer size)
+  snd_pcm_uframes_t buffer_size_ = 0;  //! Buffer size (as granted by device)
+
+  snd_pcm_uframes_t start_threshold_ = 0;  //! Frames written before stream starts by itself
+
+  model::AudioFormat format_{kSampleRate, kChannels, kBitDepth};  //! Format from playback stream
+  std::string device_;      //! Device requested by user (empty to pick it automatically)
+  PlaybackAccess access_;   //! Method used to write samples into playback stream
+  LatencyProfile profile_;  //! Decide buffer and period sizes requested to device
+  AtomicStatistics statistics_;            //! Counters from samples written
+  std::atomic<int64_t> output_delay_ = 0;  //! Delay measured after the last write (in frames)
+
+  std::chrono::steady_clock::time_point last_write_;  //! Time when previous write started
+  int last_write_size_ = 0;                           //! Number of frames from previous write
+
+  bool can_pause_ = false;                 //! Device supports hardware pause
+  PauseMethod pause_ = PauseMethod::None;  //! How playback stream is currently paused
+  std::vector<float> history_;             //! Latest samples written to device
+  size_t history_end_ = 0;                 //! Position after the newest sample in history
+  size_t history_size_ = 0;                //! Number of samples in history
+  std::vector<float> requeue_;             //! Samples to write again on resume
+  std::vector<float> fade_;                //! Samples faded out on stop
+
+  SampleConverter converter_;        //! Convert float samples to format from playback stream
+  std::vector<int16_t> output_s16_;  //! Converted samples (when playback stream uses 16 bits)
+  std::vector<int32_t> output_s32_;  //! Converted samples (when playback stream uses 24/32 bits)
+  std::vector<float> output_f32_;    //! Converted samples (when playback stream uses float)
 };
 
 }  // namespace driver
@@ -0,0 +1,156 @@
+/**
+ * \file
+ * \brief  Class for native audio processing (volume and equalization)
+ */
+
+#ifndef INCLUDE_AUDIO_DRIVER_DSP_CHAIN_H_
+#define INCLUDE_AUDIO_DRIVER_DSP_CHAIN_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "model/audio_filter.h"
+#include "model/volume.h"
+
+namespace driver {
+
+/**
+ * @brief Apply volume and a cascade of biquad filters (peaking equalizers) over interleaved float
+ * samples in a single pass (conversion to the playback format is done later by the playback
+ * itself). Filters are computed in double precision, as low frequency bands are too sensitive to
+ * rounding errors in single precision.
+ *
+ * As a biquad filter is recursive in time, SIMD kernels cannot process consecutive frames at once.
+ * Instead, they process both channels from a stereo frame together, and pipeline the cascade: on
+ * each iteration, stage N processes the frame that stage N-1 has finished on the previous one, so
+ * all stages run independently from each other. Output matches the scalar kernel within less than
+ * 1 LSB from a 16-bit sample (AVX2 and NEON kernels use fused multiply-add, which rounds
+ * differently, so it is not bit-identical).
+ */
+class DspChain {
+ public:
+  /**
+   * @brief Available implementations for the processing kernel
+   */
+  enum class Kernel {
+    Scalar = 0,  //!< Portable implementation
+    Sse = 1,     //!< x86 SSE2 (one stage per register)
+    Avx2 = 2,    //!< x86 AVX2 + FMA (two stages per register)
+    Neon = 3,    //!< ARM NEON on AArch64 (one stage per register)
+  };
+
+  /**
+   * @brief Construct a new DspChain object using the best kernel supported by CPU
+   * @param channels Number of interleaved channels
+   * @param sample_rate Sample rate (used to calculate filter coefficients)
+   */
+  explicit DspChain(int channels = 2, int sample_rate = 44100);
+
+  /**
+   * @brief Construct a new DspChain object using a specific kernel (in case that it is not
+   * supported by CPU, or number of channels is not 2, scalar kernel is used instead)
+   * @param channels Number of interleaved channels
+   * @param sample_rate Sample rate (used to calculate filter coefficients)
+   * @param kernel Processing kernel
+   */
+  DspChain(int channels, int sample_rate, Kernel kernel);
+
+  /**
+   * @brief Destroy the DspChain object
+   */
+  ~DspChain() = default;
+
+  /* ******************************************************************************************** */
+  //! Public API
+
+  /**
+   * @brief Find the best processing kernel supported by CPU
+   * @return Processing kernel
+   */
+  static Kernel DetectKernel();
+
+  /**
+   * @brief Check if processing kernel is supported by CPU
+   * @param kernel Processing kernel
+   * @return true if supported, false otherwise
+   */
+  static bool IsSupported(Kernel kernel);
+
+  /**
+   * @brief Get processing kernel in use
+   * @return Processing kernel
+   */
+  Kernel GetKernel() const { return kernel_; }
+
+  /**
+   * @brief Set volume applied before equalization
+   * @param value Desired volume (in a range between 0.f and 1.f)
+   */
+  void SetVolume(model::Volume value);
+
+  /**
+   * @brief Calculate coefficients for biquad filters (state from each filter is preserved, unless
+   * number of filters has changed)
+   * @param filters Audio filters
+   */
+  void UpdateFilters(const model::EqualizerPreset& filters);
+
+  /**
+   * @brief Remove all biquad filters (only volume is applied)
+   */
+  void ClearFilters() { cascade_ = Cascade{}; }
+
+  /**
+   * @brief Apply volume and biquad filters over input samples (result is not clamped, so boosted
+   * samples keep their headroom until conversion to the playback format)
+   * @param input Interleaved float samples (in a range between -1.f and 1.f)
+   * @param output Interleaved float samples (it may be the same buffer as input)
+   * @param frames Number of frames (samples per channel)
+   */
+  void Process(const float* input, float* output, int frames);
+
+  /**
+   * @brief Clear internal state from all biquad filters (use it when input is not contiguous)
+   */
+  void Reset();
+
+  /* ******************************************************************************************** */
+  //! Internal operations
+ private:
+  void ProcessScalar(const float* input, float* output, int frames);
+  void ProcessSse(const float* input, float* output, int frames);
+  void ProcessAvx2(const float* input, float* output, int frames);
+  void ProcessNeon(const float* input, float* output, int frames);
+
+  /* ******************************************************************************************** */
+  //! Default Constants
+
+  static constexpr int kSimdChannels = 2;    //!< Number of channels supported by SIMD kernels
+  static constexpr int kStageAlignment = 2;  //!< Number of stages is padded to a multiple of this
+
+  /* ******************************************************************************************** */
+  //! Variables
+
+  /**
+   * @brief Cascade of biquad filters in transposed direct form II, stored as structure of arrays
+   * indexed by "stage * channels + channel". Coefficients are replicated for every channel, so SIMD
+   * kernels can load coefficients and state from consecutive stages with a single instruction.
+   */
+  struct Cascade {
+    int stages = 0;                  //!< Number of biquad filters (including padding)
+    std::vector<double> b0, b1, b2;  //!< Feedforward coefficients
+    std::vector<double> a1, a2;      //!< Feedback coefficients (normalized by a0)
+    std::vector<double> z1, z2;      //!< State variables
+    std::vector<double> y;           //!< Last output from each stage (used by SIMD kernels)
+  };
+
+  int channels_;     //!< Number of interleaved channels
+  int sample_rate_;  //!< Sample rate
+  Kernel kernel_;    //!< Processing kernel
+
+  double volume_ = 1;  //!< Linear volume
+  Cascade cascade_;    //!< Cascade of biquad filters
+};
+
+}  // namespace driver
+#endif  // INCLUDE_AUDIO_DRIVER_DSP_CHAIN_H_
@@ -18,16 +18,25 @@ extern "C" {
 }
 
 #include <array>
-#include <functional>
 #include <map>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "audio/base/decoder.h"
+#include "audio/driver/dsp_chain.h"
+#include "audio/driver/pcm_cache.h"
 #include "model/application_error.h"
 #include "model/song.h"
 #include "model/volume.h"
+#include "util/mapped_file.h"
+
+#ifdef ENABLE_TESTS
+namespace {
+class FFmpegTest;
+}
+#endif
 
 namespace driver {
 
@@ -36,10 +45,19 @@ namespace driver {
  */
 class FFmpeg final : public Decoder {
  public:
+  static constexpr int kAutoThreads = 0;  //!< Let decoder choose number of threads for codec
+  static constexpr int kNoThreads = 1;    //!< Always decode on a single thread
+
   /**
    * @brief Construct a new FFmpeg object
+   * @param backend Implementation used for volume and equalization
+   * @param map_files Read local files mapped into memory, instead of using default I/O from FFmpeg
+   * @param threads Number of threads for codec: kAutoThreads (chosen by codec policy), kNoThreads
+   * or any other fixed value (only applied to codecs allowed to use threads by policy)
+   * @param cache Cache with decoded songs, played again without any codec work (optional)
    */
-  FFmpeg();
+  explicit FFmpeg(DspBackend backend = DspBackend::Filtergraph, bool map_files = true,
+                  int threads = kAutoThreads, std::shared_ptr<PcmCache> cache = nullptr);
 
   /**
    * @brief Destroy the FFmpeg object
@@ -50,9 +68,34 @@ class FFmpeg final : public Decoder {
   //! Internal operations
  private:
   error::Code OpenInputStream(const std::string& filepath);
+
+  /**
+   * @brief Create custom I/O context reading from local file mapped into memory
+   * @param filepath Path to local file
+   * @return AVIOContext to be used by input stream, or nullptr in case that file cannot be mapped
+   */
+  AVIOContext* CreateMappedIoContext(const std::string& filepath);
+
   error::Code ConfigureDecoder();
   error::Code ConfigureFilters();
 
+  /**
+   * @brief Threading configuration applied to codec context
+   */
+  struct Threading {
+    int count;  //!< Number of threads (1 means that codec decodes on the caller thread)
+    int type;   //!< Combination of FF_THREAD_FRAME and FF_THREAD_SLICE (or zero)
+  };
+
+  /**
+   * @brief Choose threading for codec, considering both its capabilities and the policy table
+   * (small-frame codecs would only get latency from threading, so they never use it)
+   * @param codec Codec used to decode input stream
+   * @param requested Number of threads requested (kAutoThreads, kNoThreads or fixed value)
+   * @return Threading configuration
+   */
+  static Threading ChooseThreading(const AVCodec* codec, int requested);
+
   //! These are ffmpeg-specific filters
   error::Code CreateFilterAbufferSrc();
   error::Code CreateFilterVolume();
@@ -60,22 +103,89 @@ class FFmpeg final : public Decoder {
   error::Code CreateFilterAbufferSink();
   error::Code CreateFilterEqualizer(const std::string& name, const model::AudioFilter& filter);
 
+  /**
+   * @brief Move parameters from equalizer filters in the running filtergraph towards the values
+   * received from UpdateFilters (gain is changed in small steps to avoid audible clicks)
+   * @return error::Code Application error code
+   */
+  error::Code SmoothFilters();
+
+  /**
+   * @brief Send command to a single equalizer filter in the running filtergraph
+   * @param name Equalizer filter name
+   * @param command Equalizer option
+   * @param value New value for option
+   * @return error::Code Application error code
+   */
+  error::Code SendEqualizerCommand(const std::string& name, const char* command, double value);
+
   /**
    * @brief Connect all filters created in the filtergraph as a linear chain
    * P.S. in general, this is the filter chain:
    *            _________    ________    ______________    _________    _____________
    * RAW DATA->| abuffer |->| volume |->| equalizer(s) |->| aformat |->| abuffersink |-> OUTPUT
    *            ---------    --------    --------------    ---------    -------------
+   * P.S. 2 for native DSP backend, volume and equalizer filters are replaced by DspChain, applied
+   * on the output from abuffersink (which is always float)
+   * P.S. 3 when filters are bypassed, volume and equalizer are not linked at all (neither DspChain)
    * @return error::Code Application error code
    */
   error::Code ConnectFilters();
 
+  /**
+   * @brief Get output samples from filtered frame, in case of native DSP backend, frame content is
+   * processed by DspChain before
+   * @param filtered Frame received from filtergraph
+   * @return Pointer to interleaved float samples
+   */
+  void* GetOutputSamples(AVFrame* filtered);
+
+  /**
+   * @brief Check if volume and equalizer can be left out from processing, as they would not change
+   * any sample (only allowed when passthrough is enabled)
+   * @return true if filters can be bypassed, false otherwise
+   */
+  bool CanBypassFilters() const;
+
   /**
    * @brief Extract all metadata from current song and fill the structure with it
    * @param audio_info Audio information structure
    */
   void FillAudioInformation(model::Song& audio_info);
 
+  /**
+   * @brief Create DspChain for the current output sample rate, with volume and equalizer filters
+   * already applied
+   * @param kernel SIMD kernel used to process samples
+   * @return DspChain instance
+   */
+  std::unique_ptr<DspChain> CreateDspChain(DspChain::Kernel kernel) const;
+
+  /**
+   * @brief Try to open song from PCM cache (so there is no need for input stream and codec)
+   * @param audio_info (In/Out) In case of cache hit, this is filled with cached audio information
+   * @return true if song is served from cache, false otherwise
+   */
+  bool OpenCachedSong(model::Song& audio_info);
+
+  /**
+   * @brief Send samples from cached song to Audio Player API callback, applying volume and
+   * equalizer by DspChain (if they are not neutral)
+   * @param samples Maximum number of samples to send to Audio Player API callback
+   * @param callback Audio Player API callback
+   * @return error::Code Application error code
+   */
+  error::Code DecodeCachedSong(int samples, AudioCallback& callback);
+
+  /**
+   * @brief Write filtered frame into PCM cache entry. This is only possible while samples are not
+   * changed by volume and equalizer, and song is decoded in sequence from its beginning (so after
+   * seeking or enabling filters, song is not stored into cache anymore). With filtergraph backend,
+   * it means that only songs decoded with passthrough, full volume and flat equalizer are stored
+   * @param filtered Frame received from filtergraph
+   */
+  void StoreOutputSamples(AVFrame* filtered);
+
   /* ******************************************************************************************** */
  public:
   /**
@@ -85,6 +195,15 @@ class FFmpeg final : public Decoder {
    */
   error::Code OpenFile(model::Song& audio_info) override;
 
+  /**
+   * @brief Set format for decoded samples (only sample rate may change, as output is always stereo
+   * with float samples, converted later by playback to its own bit depth)
+   * @param format Audio format for decoded samples
+   * @param passthrough Allow to skip volume and equalizer filters while they are neutral
+   * @return error::Code Application error code
+   */
+  error::Code SetOutputFormat(const model::AudioFormat& format, bool passthrough) override;
+
   /**
    * @brief Decode and resample input stream to desired sample format/rate
    * @param samples Maximum value of samples
@@ -145,6 +264,13 @@ class FFmpeg final : public Decoder {
     }
   };
 
+  struct IoContextDeleter {
+    void operator()(AVIOContext* p) const {
+      av_freep(&p->buffer);
+      avio_context_free(&p);
+    }
+  };
+
   struct FilterGraphDeleter {
     void operator()(AVFilterGraph* p) const { avfilter_graph_free(&p); }
   };
@@ -156,6 +282,7 @@ class FFmpeg final : public Decoder {
   };
 
   using FormatContext = std::unique_ptr<AVFormatContext, FormatContextDeleter>;
+  using IoContext = std::unique_ptr<AVIOContext, IoContextDeleter>;
   using CodecContext = std::unique_ptr<AVCodecContext, CodecContextDeleter>;
 
   using Packet = std::unique_ptr<AVPacket, PacketDeleter>;
@@ -168,8 +295,8 @@ class FFmpeg final : public Decoder {
   //! Default Constants
 
   static constexpr int kChannels = 2;                                 //!< Output number of channels
-  static constexpr int kSampleRate = 44100;                           //!< Output sample rate
-  static constexpr AVSampleFormat kSampleFormat = AV_SAMPLE_FMT_S16;  //!< Output sample format
+  static constexpr int kSampleRate = 44100;                           //!< Default output rate
+  static constexpr AVSampleFormat kSampleFormat = AV_SAMPLE_FMT_FLT;  //!< Output sample format
 
   //! All filters used from AVFilter library
   static constexpr char kFilterAbufferSrc[] = "abuffer";
@@ -180,7 +307,11 @@ class FFmpeg final : public Decoder {
 
   static constexpr int kDefaultFilterCount =
       4;  //!< Number of filters without considering equalizer filters
-  static constexpr int kResponseSize = 64;  //!< Response message size from AVFilter command
+  static constexpr int kResponseSize = 64;         //!< Response message size from AVFilter command
+  static constexpr int kIoBufferSize = 64 * 1024;  //!< Buffer size for custom I/O context
+
+  static constexpr double kMaxGainStep = 2;  //!< Maximum gain change (in dB) applied to equalizer
+                                             //!< filter per decoded frame
 
   /* ******************************************************************************************** */
   //! Utilities
@@ -211,6 +342,28 @@ class FFmpeg final : public Decoder {
       {"s64p", 64, 1, AV_SAMPLE_FMT_S64P},
   }};
 
+  struct ThreadingPolicy {
+    AVCodecID codec_id;  //! Codec identifier
+    int max_threads;     //! Maximum number of threads chosen automatically
+  };
+
+  /**
+   * @brief Codecs allowed to decode using multiple threads. These have large frames (thousands of
+   * samples) and high bitrate, so frame threading pays off, while the extra frames of delay it adds
+   * are still negligible. Any codec not listed here is decoded on a single thread
+   */
+  static constexpr std::array<ThreadingPolicy, 9> kThreadingPolicies{{
+      {AV_CODEC_ID_FLAC, 4},
+      {AV_CODEC_ID_ALAC, 4},
+      {AV_CODEC_ID_WAVPACK, 4},
+      {AV_CODEC_ID_TAK, 4},
+      {AV_CODEC_ID_TTA, 4},
+      {AV_CODEC_ID_DSD_LSBF, 2},
+      {AV_CODEC_ID_DSD_MSBF, 2},
+      {AV_CODEC_ID_DSD_LSBF_PLANAR, 2},
+      {AV_CODEC_ID_DSD_MSBF_PLANAR, 2},
+  }};
+
   /* ******************************************************************************************** */
   //! Decoding
 
@@ -219,7 +372,10 @@ class FFmpeg final : public Decoder {
    */
   struct DecodingData {
     AVRational time_base;  //!< Unit of time from input stream
-    int64_t position;      //!< Current audio position
+    int64_t start_time;    //!< Timestamp of the first sample from input stream (in time_base)
+    int64_t position;      //!< Position of the next sample sent to callback (in output samples)
+    int64_t seek_target;   //!< Samples before this position are discarded (in output samples)
+    bool seeking;          //!< Control flag for waiting the first decoded frame after seeking
 
     Packet packet;         //!< Raw audio data read from input stream
     Frame frame_decoded;   //!< Frame received from decoder
@@ -261,8 +417,42 @@ class FFmpeg final : public Decoder {
    *
    * @param samples Maximum number of samples to send to Audio Player API callback
    * @param callback Audio Player API callback
+   * @return true if callback has changed position (and input stream was sought), false otherwise
+   */
+  bool ProcessFrame(int samples, AudioCallback& callback);
+
+  /**
+   * @brief Send filtered frame to Audio Player API callback, discarding samples before the seek
+   * target (so it starts exactly on the requested sample) and keeping track of current position
+   *
+   * @param filtered Frame received from filtergraph
+   * @param callback Audio Player API callback
+   * @return true if callback has changed position (i.e. requested to seek), false otherwise
+   */
+  bool SendOutputSamples(AVFrame* filtered, AudioCallback& callback);
+
+  /**
+   * @brief Seek input stream to the position requested by Audio Player API callback. As stream is
+   * moved to the closest frame before it, remaining samples are discarded later while decoding
+   */
+  void SeekPosition();
+
+  /**
+   * @brief After seeking, check if decoded frame ends before the requested position. Otherwise, it
+   * is the first frame to be filtered, so current position is synchronized with its timestamp
+   * @return true if frame must be discarded, false otherwise
+   */
+  bool DiscardDecodedFrame();
+
+  /**
+   * @brief Mark end of stream in the filter chain and send all remaining samples to Audio Player
+   * API callback
+   *
+   * @param samples Maximum number of samples to send to Audio Player API callback
+   * @param callback Audio Player API callback
+   * @return true if callback has changed position (i.e. requested to seek), false otherwise
    */
-  void ProcessFrame(int samples, AudioCallback& callback);
+  bool FlushFilters(int samples, AudioCallback& callback);
 
   /* ******************************************************************************************** */
   //! Variables
@@ -278,13 +468,22 @@ class FFmpeg final : public Decoder {
   static constexpr int kChannelLayout = AV_CH_LAYOUT_STEREO;
 #endif
 
-  FormatContext input_stream_;  //!< Input stream from file
+  bool map_files_;                                 //!< Read local files mapped into memory
+  int threads_;                                    //!< Number of threads requested for codec
+  std::unique_ptr<util::MappedFile> mapped_file_;  //!< Local file mapped into memory
+  IoContext io_context_;                           //!< Custom I/O reading from mapped file
+
+  FormatContext input_stream_;  //!< Input stream from file (must be released before custom I/O)
   CodecContext decoder_;        //!< Specific codec compatible with the input stream
 
   int stream_index_ = 0;  //!< Audio stream index read in input stream
 
   model::Volume volume_ = model::Volume{1.f};  //!< Playback stream volume
 
+  int sample_rate_ = kSampleRate;  //!< Output sample rate (agreed with playback)
+  bool passthrough_ = false;       //!< Allow to bypass volume and equalizer while they are neutral
+  bool bypass_filters_ = false;    //!< Running filtergraph was created without volume and equalizer
+
   FilterGraph filter_graph_;      //!< Directed graph of connected filters
   FilterContext buffersrc_ctx_;   //!< Input buffer for audio frames in the filter chain
   FilterContext buffersink_ctx_;  //!< Output buffer from filter chain
@@ -292,7 +491,29 @@ class FFmpeg final : public Decoder {
   using FilterName = std::string;
   std::map<FilterName, model::AudioFilter, std::less<>> audio_filters_;  //!< Equalization filters
 
+  //! Equalization filters with parameters currently applied in the running filtergraph
+  std::map<FilterName, model::AudioFilter, std::less<>> applied_filters_;
+
+  int graph_rebuilds_ = 0;  //!< Number of times that filtergraph was rebuilt while decoding
+
+  std::unique_ptr<DspChain> dsp_;    //!< Native volume and equalization (only for native backend)
+  std::vector<float> dsp_output_;    //!< Output samples processed by DspChain
+
   DecodingData shared_context_;  //!< Shared context for decoding and equalizing audio data
+
+  std::shared_ptr<PcmCache> cache_;                 //!< Cache with decoded songs (optional)
+  std::unique_ptr<PcmCache::Entry> cached_song_;    //!< Opened song served from cache
+  std::unique_ptr<PcmCache::Writer> cache_writer_;  //!< Decoded samples being written into cache
+  std::unique_ptr<DspChain> cache_dsp_;  //!< Volume and equalization for cached songs (only for
+                                         //!< filtergraph backend, as there is no filtergraph)
+  std::vector<float> cache_output_;      //!< Samples read from cached song
+
+  /* ******************************************************************************************** */
+  //! Friend class for testing purpose
+
+#ifdef ENABLE_TESTS
+  friend class ::FFmpegTest;
+#endif
 };
 
 }  // namespace driver
@@ -50,10 +50,23 @@ class FFTW final : public Analyzer {
   error::Code Execute(double *in, int size, double *out) override;
 
   /**
-   * @brief Get internal buffer size
+   * @brief Get internal buffer size, following period size from playback stream (but never smaller
+   * than base size, to avoid running FFT too often with ultra-low latency)
    * @return Maximum size for input vector
    */
-  int GetBufferSize() override { return kBufferSize; }
+  int GetBufferSize() override;
+
+  /**
+   * @brief Set period size from playback stream
+   * @param size Period size (in frames)
+   */
+  void SetPeriodSize(int size) override;
+
+  /**
+   * @brief Set sample rate from audio data (recalculating cut off frequencies, if changed)
+   * @param sample_rate Number of frames per second
+   */
+  void SetSampleRate(int sample_rate) override;
 
   /**
    * @brief Get output buffer size
@@ -114,10 +127,13 @@ class FFTW final : public Analyzer {
   static constexpr int kNumberBars = 10;     //!< Quantity of bars to represent audio spectrum
   static constexpr int kNumberChannels = 2;  //!< Always consider input audio data as stereo
 
+  static constexpr int kMaxInputSize =
+      kBufferSize * 8 * kNumberChannels;  //!< Same size as input buffer (used by bass analysis)
+
   static constexpr int kLowCutOff = 50;      //!< Low frequency to cut off (in Hz)
   static constexpr int kHighCutOff = 10000;  //!< High frequency to cut off (in Hz)
 
-  static constexpr int kSampleRate = 44100;  //!< Audio data sample rate
+  static constexpr int kDefaultSampleRate = 44100;  //!< Audio data sample rate (until informed)
 
   static constexpr float kNoiseReduction =
       0.77f;  //!< Adjusts the integral and gravity filters to keep the signal smooth
@@ -130,8 +146,10 @@ class FFTW final : public Analyzer {
   FreqAnalysis bass_, mid_, treble_;  //!< Split audio spectrum analysis between three audio ranges
 
   //! Input data
-  double input_size_;          //!< Maximum size for input buffer
-  std::vector<double> input_;  //!< Input buffer with raw audio data
+  double input_size_;                     //!< Maximum size for input buffer
+  int period_size_ = 0;                   //!< Period size from playback stream (in frames)
+  int sample_rate_ = kDefaultSampleRate;  //!< Sample rate from playback stream
+  std::vector<double> input_;             //!< Input buffer with raw audio data
 
   //! To smooth results after applying FFT
   std::vector<double> previous_output_, memory_, peak_;
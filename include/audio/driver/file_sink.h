@@ -0,0 +1,188 @@
+/**
+ * \file
+ * \brief  Class for playback that writes samples into a file (WAV or raw PCM)
+ */
+
+#ifndef INCLUDE_AUDIO_DRIVER_FILE_SINK_H_
+#define INCLUDE_AUDIO_DRIVER_FILE_SINK_H_
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#include "audio/base/playback.h"
+#include "audio/driver/sample_converter.h"
+#include "model/application_error.h"
+#include "model/audio_format.h"
+#include "model/volume.h"
+
+namespace driver {
+
+/**
+ * @brief Playback that writes samples into a file as fast as they arrive, so songs are rendered
+ * offline (with volume and equalizer applied). Every song played is appended to the same file, so
+ * all of them must share the same format (i.e. once the first sample is written, only this format
+ * is supported, and player resamples other songs to it when possible).
+ */
+class FileSink final : public Playback {
+ public:
+  /**
+   * @brief Layout from output file
+   */
+  enum class Container {
+    Wav,  //!< WAV file (RIFF header followed by PCM samples), header is updated on every stop
+    Raw,  //!< Interleaved PCM samples only (signed integer, little-endian)
+  };
+
+  /**
+   * @brief Construct a new FileSink object
+   * @param path Output file (overwritten if it already exists)
+   * @param container Layout from output file
+   * @param dither Add TPDF dither when converting samples to 16 bits
+   */
+  FileSink(const std::filesystem::path& path, Container container, bool dither = true)
+      : path_{path}, container_{container}, converter_{dither} {}
+
+  /**
+   * @brief Destroy the FileSink object (updating header from output file)
+   */
+  ~FileSink() override;
+
+  /* ******************************************************************************************** */
+  //! Public API
+
+  /**
+   * @brief Create output file
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code CreatePlaybackStream() override;
+
+  /**
+   * @brief Configure Playback Stream parameters (nothing to configure)
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code ConfigureParameters() override { return error::kSuccess; }
+
+  /**
+   * @brief Check if output file accepts the given format (only 16 or 32 bits integer, and only the
+   * format from samples already written, if any)
+   * @param format Audio format
+   * @return true if format is supported, false otherwise
+   */
+  bool IsFormatSupported(const model::AudioFormat& format) override;
+
+  /**
+   * @brief Change format from samples written into output file
+   * @param format Audio format
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code SetFormat(const model::AudioFormat& format) override;
+
+  /**
+   * @brief Reconfigure playback stream to use another latency profile (no effect)
+   * @param profile Latency profile
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code SetLatencyProfile(LatencyProfile profile) override { return error::kSuccess; }
+
+  /**
+   * @brief Make playback stream ready to play
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code Prepare() override { return error::kSuccess; }
+
+  /**
+   * @brief Pause current song on playback stream
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code Pause() override { return error::kSuccess; }
+
+  /**
+   * @brief Resume current song on playback stream
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code Resume() override { return error::kSuccess; }
+
+  /**
+   * @brief Stop playing song, updating header and flushing output file (so it is valid from now)
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code Stop() override;
+
+  /**
+   * @brief Convert audio samples and append them to output file
+   * @param buffer Audio samples (interleaved float)
+   * @param size Number of frames
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code AudioCallback(void* buffer, int size) override;
+
+  /**
+   * @brief Set volume on playback stream (only kept, as volume is applied by decoder)
+   * @param value Desired volume (in a range between 0.f and 1.f)
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code SetVolume(model::Volume value) override;
+
+  /**
+   * @brief Get volume from playback stream
+   * @return model::Volume Volume percentage (in a range between 0.f and 1.f)
+   */
+  model::Volume GetVolume() override;
+
+  /**
+   * @brief Set listener for volume changes on playback stream (never called, as nothing else
+   * changes volume)
+   * @param listener Callback invoked only when volume value actually changes
+   */
+  void SetVolumeListener(VolumeListener listener) override {}
+
+  /**
+   * @brief Get period size
+   * @return uint32_t Period size
+   */
+  uint32_t GetPeriodSize() const override { return kPeriodSize; }
+
+  /**
+   * @brief Get counters from samples written (safe to call from any thread)
+   * @return Statistics Counters
+   */
+  Statistics GetStatistics() const override;
+
+  /* ******************************************************************************************** */
+  //! Internal operations
+ private:
+  /**
+   * @brief Write WAV header at the beginning of output file, with sizes from samples written so
+   * far (position is restored afterwards)
+   */
+  void WriteHeader();
+
+  /* ******************************************************************************************** */
+  //! Default Constants
+
+  static constexpr uint32_t kPeriodSize = 1024;  //!< Frames per period
+  static constexpr uint32_t kHeaderSize = 44;    //!< Size of WAV header (with PCM format chunk)
+
+  /* ******************************************************************************************** */
+  //! Variables
+
+  std::filesystem::path path_;               //!< Output file
+  Container container_;                      //!< Layout from output file
+  std::ofstream file_;                       //!< Output file stream
+  model::AudioFormat format_{44100, 2, 16};  //!< Format from samples written
+  model::Volume volume_;                     //!< Volume kept for GetVolume
+  std::mutex mutex_;                         //!< Control access to volume
+  uint64_t data_size_ = 0;                   //!< Size of samples written (in bytes)
+  std::atomic<int64_t> frames_ = 0;          //!< Number of frames written
+
+  SampleConverter converter_;        //!< Convert float samples to format from output file
+  std::vector<int16_t> output_s16_;  //!< Converted samples (when output file uses 16 bits)
+  std::vector<int32_t> output_s32_;  //!< Converted samples (when output file uses 32 bits)
+};
+
+}  // namespace driver
+#endif  // INCLUDE_AUDIO_DRIVER_FILE_SINK_H_
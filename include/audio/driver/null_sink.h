@@ -0,0 +1,169 @@
+/**
+ * \file
+ * \brief  Class for playback that discards every sample (no sound device needed)
+ */
+
+#ifndef INCLUDE_AUDIO_DRIVER_NULL_SINK_H_
+#define INCLUDE_AUDIO_DRIVER_NULL_SINK_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include "audio/base/playback.h"
+#include "model/application_error.h"
+#include "model/audio_format.h"
+#include "model/volume.h"
+
+namespace driver {
+
+/**
+ * @brief Playback that consumes samples without playing them, so the whole pipeline (decoding,
+ * equalizer and analysis) runs on machines without sound hardware. By default, samples are
+ * consumed as soon as they arrive (faster than real-time, limited only by decoding), otherwise
+ * each write blocks just like a sound device consuming samples at the sample rate.
+ */
+class NullSink final : public Playback {
+ public:
+  /**
+   * @brief Construct a new NullSink object
+   * @param paced Consume samples at real-time pace, instead of as fast as they arrive
+   */
+  explicit NullSink(bool paced = false) : paced_{paced} {}
+
+  /**
+   * @brief Destroy the NullSink object (logging throughput achieved)
+   */
+  ~NullSink() override;
+
+  /* ******************************************************************************************** */
+  //! Public API
+
+  /**
+   * @brief Create a Playback Stream (nothing to open)
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code CreatePlaybackStream() override;
+
+  /**
+   * @brief Configure Playback Stream parameters (nothing to configure)
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code ConfigureParameters() override { return error::kSuccess; }
+
+  /**
+   * @brief Check if playback accepts the given format (any one is accepted)
+   * @param format Audio format
+   * @return true if format is supported, false otherwise
+   */
+  bool IsFormatSupported(const model::AudioFormat& format) override;
+
+  /**
+   * @brief Reconfigure playback stream to use another format
+   * @param format Audio format
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code SetFormat(const model::AudioFormat& format) override;
+
+  /**
+   * @brief Reconfigure playback stream to use another latency profile (no effect, as there is no
+   * device buffer)
+   * @param profile Latency profile
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code SetLatencyProfile(LatencyProfile profile) override { return error::kSuccess; }
+
+  /**
+   * @brief Make playback stream ready to play
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code Prepare() override;
+
+  /**
+   * @brief Pause current song on playback stream
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code Pause() override { return error::kSuccess; }
+
+  /**
+   * @brief Resume current song on playback stream (pace restarts from now)
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code Resume() override;
+
+  /**
+   * @brief Stop playing song on playback stream
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code Stop() override { return error::kSuccess; }
+
+  /**
+   * @brief Consume audio samples, blocking only when paced
+   * @param buffer Audio samples (interleaved float)
+   * @param size Number of frames
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code AudioCallback(void* buffer, int size) override;
+
+  /**
+   * @brief Set volume on playback stream (only kept, as samples are discarded anyway)
+   * @param value Desired volume (in a range between 0.f and 1.f)
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code SetVolume(model::Volume value) override;
+
+  /**
+   * @brief Get volume from playback stream
+   * @return model::Volume Volume percentage (in a range between 0.f and 1.f)
+   */
+  model::Volume GetVolume() override;
+
+  /**
+   * @brief Set listener for volume changes on playback stream (never called, as nothing else
+   * changes volume)
+   * @param listener Callback invoked only when volume value actually changes
+   */
+  void SetVolumeListener(VolumeListener listener) override {}
+
+  /**
+   * @brief Get period size
+   * @return uint32_t Period size
+   */
+  uint32_t GetPeriodSize() const override { return kPeriodSize; }
+
+  /**
+   * @brief Get counters from samples consumed (safe to call from any thread)
+   * @return Statistics Counters
+   */
+  Statistics GetStatistics() const override;
+
+  /**
+   * @brief Get how fast samples are consumed compared to real-time, since the first write
+   * @return double Throughput (e.g. 10 means ten seconds of audio consumed per second)
+   */
+  double GetRealtimeFactor() const;
+
+  /* ******************************************************************************************** */
+  //! Default Constants
+ private:
+  static constexpr uint32_t kPeriodSize = 1024;  //!< Frames per period
+
+  /* ******************************************************************************************** */
+  //! Variables
+
+  using Clock = std::chrono::steady_clock;
+
+  bool paced_;                               //!< Consume samples at real-time pace
+  model::AudioFormat format_{44100, 2, 16};  //!< Format from playback stream
+  model::Volume volume_;                     //!< Volume kept for GetVolume
+  Clock::time_point deadline_;               //!< When samples written so far would be played
+
+  mutable std::mutex mutex_;         //!< Control access to throughput data and volume
+  Clock::time_point started_;        //!< Time from the first write
+  double audio_seconds_ = 0;         //!< Audio consumed (sample rate may change between songs)
+  std::atomic<int64_t> frames_ = 0;  //!< Number of frames consumed
+};
+
+}  // namespace driver
+#endif  // INCLUDE_AUDIO_DRIVER_NULL_SINK_H_
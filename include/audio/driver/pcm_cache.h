@@ -0,0 +1,231 @@
+/**
+ * \file
+ * \brief  Class for caching decoded songs on disk as raw PCM
+ */
+
+#ifndef INCLUDE_AUDIO_DRIVER_PCM_CACHE_H_
+#define INCLUDE_AUDIO_DRIVER_PCM_CACHE_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "model/song.h"
+#include "util/mapped_file.h"
+
+#ifdef ENABLE_TESTS
+namespace {
+class PcmCacheTest;
+}
+#endif
+
+namespace driver {
+
+/**
+ * @brief On-disk cache of decoded songs, where each entry holds interleaved stereo float samples
+ * (at the output sample rate, without volume and equalizer) preceded by song metadata. Entries are
+ * keyed by song path, modification time and size (so an edited file is never served stale), plus
+ * the output sample rate.
+ *
+ * Cached songs are read from a file mapped into memory, so playing them again is only a memcpy
+ * from the mapped region and seeking is just moving the read position. Total size is capped by
+ * evicting the least recently used entries, where modification time of each entry file is
+ * refreshed whenever it is found (so usage history survives application restart).
+ */
+class PcmCache {
+ protected:
+  /**
+   * @brief Construct a new PcmCache object
+   * @param directory Directory holding cache entries
+   * @param max_size Maximum size of all entries (in bytes)
+   */
+  PcmCache(const std::filesystem::path& directory, uintmax_t max_size);
+
+ public:
+  /**
+   * @brief Create a new PcmCache instance (creating directory when it does not exist yet)
+   * @param directory Directory holding cache entries
+   * @param max_size Maximum size of all entries (in bytes)
+   * @return PcmCache instance, or nullptr in case that directory cannot be used
+   */
+  static std::shared_ptr<PcmCache> Create(const std::filesystem::path& directory,
+                                          uintmax_t max_size);
+
+  /**
+   * @brief Destroy the PcmCache object
+   */
+  ~PcmCache() = default;
+
+  //! Remove these
+  PcmCache(const PcmCache& other) = delete;             // copy constructor
+  PcmCache(PcmCache&& other) = delete;                  // move constructor
+  PcmCache& operator=(const PcmCache& other) = delete;  // copy assignment
+  PcmCache& operator=(PcmCache&& other) = delete;       // move assignment
+
+  /* ******************************************************************************************** */
+  //! Cache entries
+
+  /**
+   * @brief Cached song opened for reading, mapped into memory
+   */
+  class Entry {
+   public:
+    /**
+     * @brief Construct a new Entry object
+     * @param file Entry file mapped into memory
+     * @param data_offset Offset of the first sample in file
+     * @param song Song metadata stored in entry
+     * @param sample_rate Sample rate from cached samples
+     * @param frames Number of cached frames
+     */
+    Entry(std::unique_ptr<util::MappedFile>&& file, int64_t data_offset, const model::Song& song,
+          int sample_rate, int64_t frames);
+
+    /**
+     * @brief Copy samples from current position and move position forward
+     * @param buffer Output buffer for interleaved samples
+     * @param frames Maximum number of frames to read
+     * @return Number of frames effectively read (zero when reaching the end of song)
+     */
+    int Read(float* buffer, int frames);
+
+    /**
+     * @brief Change current position (always exact, as samples are stored without compression)
+     * @param frame New position (in frames)
+     * @return true if position is valid, false otherwise
+     */
+    bool Seek(int64_t frame);
+
+    //! Getters
+    const model::Song& GetSong() const { return song_; }
+    int GetSampleRate() const { return sample_rate_; }
+    int64_t GetFrames() const { return frames_; }
+
+   private:
+    std::unique_ptr<util::MappedFile> file_;  //!< Entry file mapped into memory
+    int64_t data_offset_;                     //!< Offset of the first sample in file
+    model::Song song_;                        //!< Song metadata
+    int sample_rate_;                         //!< Sample rate from cached samples
+    int64_t frames_;                          //!< Number of cached frames
+  };
+
+  /**
+   * @brief Entry being written while song is decoded, it is only visible in cache after stored
+   * (otherwise, temporary file is removed on destruction)
+   */
+  class Writer {
+   public:
+    /**
+     * @brief Construct a new Writer object
+     * @param filepath Path to entry file
+     * @param temporary Path to temporary file, renamed to entry file only when stored
+     * @param song Song metadata
+     * @param sample_rate Sample rate from samples
+     * @param max_frames Maximum number of frames accepted (so entry fits in cache)
+     */
+    Writer(const std::filesystem::path& filepath, const std::filesystem::path& temporary,
+           const model::Song& song, int sample_rate, int64_t max_frames);
+
+    /**
+     * @brief Destroy the Writer object (removing temporary file, in case it was not stored)
+     */
+    ~Writer();
+
+    /**
+     * @brief Append samples to entry
+     * @param samples Interleaved samples
+     * @param frames Number of frames
+     * @return true if samples were written, false in case of error or entry getting too big
+     */
+    bool Write(const float* samples, int frames);
+
+    //! Getters
+    const model::Song& GetSong() const { return song_; }
+    int64_t GetFrames() const { return frames_; }
+
+   private:
+    friend class PcmCache;
+
+    std::filesystem::path filepath_;   //!< Path to entry file
+    std::filesystem::path temporary_;  //!< Path to temporary file (empty after stored)
+    std::ofstream file_;               //!< Temporary file
+    model::Song song_;                 //!< Song metadata
+    int sample_rate_;                  //!< Sample rate from samples
+    int64_t frames_ = 0;               //!< Number of frames written
+    int64_t max_frames_;               //!< Maximum number of frames accepted
+  };
+
+  /* ******************************************************************************************** */
+  //! Public API
+
+  /**
+   * @brief Find song in cache, refreshing its last usage in case of hit
+   * @param filepath Path to song
+   * @param sample_rate Output sample rate
+   * @return Cached song ready to read, or nullptr in case of miss
+   */
+  std::unique_ptr<Entry> Find(const std::string& filepath, int sample_rate);
+
+  /**
+   * @brief Start writing a new entry for song
+   * @param song Song metadata (filepath must be filled)
+   * @param sample_rate Output sample rate
+   * @return Entry writer, or nullptr in case that song cannot be cached
+   */
+  std::unique_ptr<Writer> CreateWriter(const model::Song& song, int sample_rate);
+
+  /**
+   * @brief Make entry written until now visible in cache, evicting the least recently used ones
+   * when cache gets bigger than allowed
+   * @param writer Entry writer (after decoding the whole song)
+   * @return true if entry was stored, false otherwise
+   */
+  bool Store(std::unique_ptr<Writer>&& writer);
+
+  /* ******************************************************************************************** */
+  //! Internal operations
+ private:
+  /**
+   * @brief Get entry filename for song
+   * @param filepath Path to song
+   * @param sample_rate Output sample rate
+   * @return Filename, or empty in case that song file cannot be read
+   */
+  static std::string GetFilename(const std::string& filepath, int sample_rate);
+
+  /**
+   * @brief Remove least recently used entries until cache fits in maximum size
+   */
+  void Evict();
+
+  /* ******************************************************************************************** */
+  //! Default Constants
+
+  static constexpr char kExtension[] = ".pcm";   //!< Extension from entry files
+  static constexpr char kMagic[] = "SPCM";       //!< Signature at the beginning of entry files
+  static constexpr uint32_t kVersion = 1;        //!< Version from entry file layout
+  static constexpr uint32_t kChannels = 2;       //!< Number of interleaved channels
+  static constexpr int64_t kFramesOffset = 16;   //!< Offset of number of frames in entry file
+  static constexpr int64_t kDataAlignment = 16;  //!< Alignment of the first sample in entry file
+
+  /* ******************************************************************************************** */
+  //! Variables
+
+  std::filesystem::path directory_;  //!< Directory holding cache entries
+  uintmax_t max_size_;               //!< Maximum size of all entries (in bytes)
+  int writers_ = 0;                  //!< Number of writers created (used for temporary files)
+  std::mutex mutex_;                 //!< Control access to directory (shared by decoders)
+
+  /* ******************************************************************************************** */
+  //! Friend class for testing purpose
+
+#ifdef ENABLE_TESTS
+  friend class ::PcmCacheTest;
+#endif
+};
+
+}  // namespace driver
+#endif  // INCLUDE_AUDIO_DRIVER_PCM_CACHE_H_
@@ -0,0 +1,98 @@
+/**
+ * \file
+ * \brief  Class for converting float samples to the playback format
+ */
+
+#ifndef INCLUDE_AUDIO_DRIVER_SAMPLE_CONVERTER_H_
+#define INCLUDE_AUDIO_DRIVER_SAMPLE_CONVERTER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace driver {
+
+/**
+ * @brief Convert interleaved float samples (in a range between -1.f and 1.f) to samples accepted
+ * by playback device (signed integer or float), saturating values out of range. This is the only
+ * place in the audio pipeline where samples leave float representation.
+ *
+ * When converting to 16 bits, TPDF (triangular probability density function) dither can be added
+ * before rounding, so quantization error becomes a constant noise floor instead of a distortion
+ * correlated to the signal. Samples that are already exact in the target format (e.g. digital
+ * silence, or a 16-bit song untouched by volume and equalizer) are never dithered, so they are
+ * played bit-perfect.
+ */
+class SampleConverter {
+ public:
+  /**
+   * @brief Construct a new SampleConverter object
+   * @param dither Add TPDF dither when converting to 16 bits
+   */
+  explicit SampleConverter(bool dither = true) : dither_{dither} {}
+
+  /**
+   * @brief Destroy the SampleConverter object
+   */
+  ~SampleConverter() = default;
+
+  /* ******************************************************************************************** */
+  //! Public API
+
+  /**
+   * @brief Convert float samples to S16
+   * @param input Float samples
+   * @param output S16 samples
+   * @param size Number of samples (considering all channels)
+   */
+  void Convert(const float* input, int16_t* output, size_t size);
+
+  /**
+   * @brief Convert float samples to S32, or to S24 stored in the lower bits of 32 bits (float
+   * precision is not above 1 LSB from S24, so no dither needed)
+   * @param input Float samples
+   * @param output S32 samples
+   * @param size Number of samples (considering all channels)
+   * @param bit_depth Number of significant bits in each output sample (24 or 32)
+   */
+  void Convert(const float* input, int32_t* output, size_t size, int bit_depth = 32);
+
+  /**
+   * @brief Copy float samples, only saturating values out of range (as devices taking float
+   * samples do not handle them consistently)
+   * @param input Float samples
+   * @param output Float samples
+   * @param size Number of samples (considering all channels)
+   */
+  void Convert(const float* input, float* output, size_t size);
+
+  /**
+   * @brief Check if dither is enabled
+   * @return true if enabled, false otherwise
+   */
+  bool IsDitherEnabled() const { return dither_; }
+
+  /* ******************************************************************************************** */
+  //! Internal operations
+ private:
+  /**
+   * @brief Generate next value for TPDF dither, as the sum of two independent uniform values
+   * @return Random value in a range between -1 and 1 (in LSB units)
+   */
+  float NextDither();
+
+  /* ******************************************************************************************** */
+  //! Default Constants
+
+  static constexpr float kScaleS16 = 32768.f;                 //!< Scale from float to S16
+  static constexpr uint32_t kSeed = 0x9E3779B9;               //!< Seed for random generator
+  static constexpr float kUniformScale = 1.f / 4294967296.f;  //!< Scale from uint32 to [0, 1)
+
+  /* ******************************************************************************************** */
+  //! Variables
+
+  bool dither_;             //!< Add TPDF dither when converting to 16 bits
+  uint32_t state_ = kSeed;  //!< State for random generator (xorshift)
+};
+
+}  // namespace driver
+#endif  // INCLUDE_AUDIO_DRIVER_SAMPLE_CONVERTER_H_
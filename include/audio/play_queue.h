@@ -0,0 +1,182 @@
+/**
+ * \file
+ * \brief  Class for queue of songs to be played by audio player
+ */
+
+#ifndef INCLUDE_AUDIO_PLAY_QUEUE_H_
+#define INCLUDE_AUDIO_PLAY_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace audio {
+
+/**
+ * @brief Ordered list of songs, holding which one is current and deciding which one comes next
+ * (according to repeat and shuffle modes). Audio player reads it to open the upcoming song in
+ * advance and to advance by itself when a song finishes, so it works without user interface. Every
+ * method is thread-safe.
+ */
+class PlayQueue {
+ public:
+  /**
+   * @brief What happens after the last song (or with the current song)
+   */
+  enum class Repeat {
+    Off,  //!< Stop after the last song
+    One,  //!< Play current song again
+    All,  //!< Play from the first song again
+  };
+
+  /**
+   * @brief Construct a new PlayQueue object
+   * @param seed Seed for shuffle order (fixed only for testing purpose)
+   */
+  explicit PlayQueue(uint32_t seed = std::random_device{}()) : random_{seed} {}
+
+  /**
+   * @brief Destroy the PlayQueue object
+   */
+  ~PlayQueue() = default;
+
+  //! Remove these
+  PlayQueue(const PlayQueue& other) = delete;             // copy constructor
+  PlayQueue(PlayQueue&& other) = delete;                  // move constructor
+  PlayQueue& operator=(const PlayQueue& other) = delete;  // copy assignment
+  PlayQueue& operator=(PlayQueue&& other) = delete;       // move assignment
+
+  /* ******************************************************************************************** */
+  //! Public API
+
+  /**
+   * @brief Append song to the end of queue (in shuffle mode, it goes to a random position among
+   * the songs not played yet)
+   * @param filepath Full path to file
+   */
+  void Enqueue(const std::string& filepath);
+
+  /**
+   * @brief Insert song right after the current one, so it is the next to be played
+   * @param filepath Full path to file
+   */
+  void InsertNext(const std::string& filepath);
+
+  /**
+   * @brief Remove song from queue (when it is the current one, next song is kept the same)
+   * @param index Position in queue (in the same order as songs were added)
+   * @return true if song was removed, false if index is out of range
+   */
+  bool Remove(size_t index);
+
+  /**
+   * @brief Remove every song from queue
+   */
+  void Clear();
+
+  /**
+   * @brief Make song the current one (e.g. when user picks it to play)
+   * @param filepath Full path to file
+   * @return true if song is in queue, false otherwise
+   */
+  bool Select(const std::string& filepath);
+
+  /**
+   * @brief Get song that comes after the current one, without advancing
+   * @return Full path to file, or nothing when queue has finished
+   */
+  std::optional<std::string> PeekNext() const;
+
+  /**
+   * @brief Advance to the next song
+   * @return Full path to file, or nothing when queue has finished (current song is kept)
+   */
+  std::optional<std::string> Next();
+
+  /**
+   * @brief Go back to the previous song (or stay in the first one)
+   * @return Full path to file, or nothing when there is no current song
+   */
+  std::optional<std::string> Previous();
+
+  /**
+   * @brief Get current song
+   * @return Full path to file, or nothing when queue has not started yet
+   */
+  std::optional<std::string> GetCurrent() const;
+
+  /**
+   * @brief Get every song from queue
+   * @return List of songs (in the same order as they were added)
+   */
+  std::vector<std::string> GetItems() const;
+
+  /**
+   * @brief Get number of songs in queue
+   * @return Queue size
+   */
+  size_t Size() const;
+
+  /**
+   * @brief Set repeat mode
+   * @param mode Repeat mode
+   */
+  void SetRepeat(Repeat mode);
+
+  /**
+   * @brief Get repeat mode
+   * @return Repeat mode
+   */
+  Repeat GetRepeat() const;
+
+  /**
+   * @brief Enable or disable shuffle mode (current song is kept, and only the order from the other
+   * ones changes)
+   * @param enable Play songs in random order
+   */
+  void SetShuffle(bool enable);
+
+  /**
+   * @brief Check if shuffle mode is enabled
+   * @return true if songs are played in random order
+   */
+  bool IsShuffled() const;
+
+  /**
+   * @brief Get counter incremented on every change (without locking, so audio thread only reads
+   * queue again after it changes)
+   * @return Number of changes made until now
+   */
+  uint64_t GetChanges() const { return changes_.load(std::memory_order_acquire); }
+
+  /* ******************************************************************************************** */
+  //! Internal operations
+ private:
+  /**
+   * @brief Get position in play order from the song after the current one (mutex must be held)
+   * @return Position in play order, or nothing when queue has finished
+   */
+  std::optional<size_t> GetNextPosition() const;
+
+  /* ******************************************************************************************** */
+  //! Variables
+
+  mutable std::mutex mutex_;        //!< Control access to internal data (shared between threads)
+  std::vector<std::string> items_;  //!< Songs in the same order as they were added
+  std::vector<size_t> order_;       //!< Play order, where each element is an index from items
+  std::optional<size_t> cursor_;    //!< Position in play order from current song
+
+  std::atomic<uint64_t> changes_ = 0;  //!< Number of changes made (incremented holding mutex)
+
+  Repeat repeat_ = Repeat::Off;  //!< Repeat mode
+  bool shuffle_ = false;         //!< Play songs in random order
+  std::mt19937 random_;          //!< Generator for shuffle order
+};
+
+}  // namespace audio
+#endif  // INCLUDE_AUDIO_PLAY_QUEUE_H_
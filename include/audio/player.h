@@ -7,10 +7,12 @@
 #define INCLUDE_AUDIO_PLAYER_H_
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
-#include <deque>
+#include <cstdint>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <thread>
 #include <vector>
@@ -18,17 +20,27 @@
 #include "audio/base/decoder.h"
 #include "audio/base/playback.h"
 #include "audio/command.h"
+#include "audio/play_queue.h"
 #include "model/application_error.h"
 #include "model/audio_filter.h"
+#include "model/audio_format.h"
+#include "model/playback_clock.h"
 #include "model/song.h"
 #include "model/volume.h"
 #include "util/logger.h"
+#include "util/mpsc_queue.h"
+#include "util/realtime.h"
+#include "util/ring_buffer.h"
 
 //! Forward declaration
 namespace interface {
 class Notifier;
 }
 
+namespace driver {
+class PcmCache;
+}
+
 #ifdef ENABLE_TESTS
 namespace {
 class PlayerTest;
@@ -53,9 +65,61 @@ class AudioControl {
   virtual void SeekForwardPosition(int value) = 0;
   virtual void SeekBackwardPosition(int value) = 0;
   virtual void ApplyAudioFilters(const model::EqualizerPreset& filters) = 0;
+  virtual void SetNextSong(const std::string& filepath) = 0;
   virtual void Exit() = 0;
 };
 
+/**
+ * @brief Tunable parameters for Audio Player
+ */
+struct PlayerOptions {
+  static constexpr int kDefaultBufferDepth = 250;  //!< Suggested buffer depth (in milliseconds)
+
+  int buffer_depth_ms = 0;  //!< Depth of decoded audio buffer between decoding and playback threads
+                            //!< (in milliseconds), when zero, decoded audio goes directly to playback
+
+  driver::DspBackend dsp_backend =
+      driver::DspBackend::Filtergraph;  //!< Implementation used for volume and equalization
+
+  bool passthrough = true;  //!< Play song using its own sample rate (when supported by playback),
+                            //!< and skip volume and equalizer while they are neutral
+
+  bool dither = true;  //!< Add TPDF dither when converting float samples to 16-bit playback
+
+  driver::PlaybackAccess playback_access =
+      driver::PlaybackAccess::Mmap;  //!< Method used to write samples into playback stream
+
+  driver::LatencyProfile latency_profile =
+      driver::LatencyProfile::Balanced;  //!< Buffer and period sizes requested to playback stream
+
+  int decoder_threads = 0;  //!< Threads used by codec to decode frames: 0 means automatic (based
+                            //!< on codec policy and CPU count), 1 disables threading, otherwise it
+                            //!< is a fixed number of threads
+
+  std::string cache_directory;  //!< Directory to keep decoded songs, so they are played again
+                                //!< without decoding (when empty, cache is disabled)
+
+  int cache_size_mb = 1024;  //!< Maximum size of decoded songs kept in cache (in megabytes)
+
+  util::RealtimePolicy realtime_policy =
+      util::RealtimePolicy::None;  //!< Scheduling for thread writing samples into playback stream,
+                                   //!< when enabled, memory is also locked (falls back to normal
+                                   //!< scheduling and unlocked memory without permission)
+
+  int realtime_priority = 70;  //!< Priority for real-time scheduling (from 1 to 99)
+
+  driver::PlaybackOutput output =
+      driver::PlaybackOutput::Alsa;  //!< Destination for samples played (sound device by default)
+
+  std::string output_path;  //!< File written when output is WAV or raw
+
+  std::string output_device;  //!< ALSA device requested by user (when empty, device is picked
+                              //!< automatically, trying the last one that worked first)
+
+  bool output_paced = false;  //!< Null output consumes samples at real-time pace, instead of as
+                              //!< fast as they arrive
+};
+
 /**
  * @brief Responsible to control media and play it on hardware
  */
@@ -65,9 +129,10 @@ class Player : public AudioControl {
    * @brief Construct a new Player object
    * @param playback Pointer to playback interface
    * @param decoder Pointer to decoder interface
+   * @param options Tunable parameters
    */
   explicit Player(std::unique_ptr<driver::Playback>&& playback,
-                  std::unique_ptr<driver::Decoder>&& decoder);
+                  std::unique_ptr<driver::Decoder>&& decoder, const PlayerOptions& options);
 
  public:
   /**
@@ -75,11 +140,13 @@ class Player : public AudioControl {
    * @param playback Pass playback to be used within Audio thread (optional)
    * @param decoder Pass decoder to be used within Audio thread (optional)
    * @param asynchronous Run Audio Player as a thread (default is true)
+   * @param options Tunable parameters (optional)
    * @return std::shared_ptr<Player> Player instance
    */
   static std::shared_ptr<Player> Create(driver::Playback* playback = nullptr,
                                         driver::Decoder* decoder = nullptr,
-                                        bool asynchronous = true);
+                                        bool asynchronous = true,
+                                        const PlayerOptions& options = PlayerOptions{});
 
   /**
    * @brief Destroy the Player object
@@ -101,6 +168,12 @@ class Player : public AudioControl {
    */
   void Init(bool asynchronous);
 
+  /**
+   * @brief Open and configure playback stream (called by audio thread, when running as a thread)
+   * @return error::Code Application error code
+   */
+  error::Code InitPlayback();
+
   /**
    * @brief Reset all media controls to default value
    * @param result Application error code from internal operation
@@ -112,17 +185,128 @@ class Player : public AudioControl {
    * @brief Handle an audio command from internal queue
    * @param buffer Audio buffer
    * @param size Buffer size
-   * @param new_position Latest position in the song (in seconds)
-   * @param last_position Last position to control when current position has changed
+   * @param new_position Latest position in the song (in samples)
+   * @param last_position Last position notified to UI (in seconds), to control when it has changed
+   * @param media_notifier Interface notifier (kept by caller while decoding song, may be null)
    * @return True if player should keep playing audio, False if not
    */
-  bool HandleCommand(void* buffer, int size, int64_t& new_position, int& last_position);
+  bool HandleCommand(void* buffer, int size, int64_t& new_position, int& last_position,
+                     interface::Notifier* media_notifier);
+
+  /**
+   * @brief Convert time offset to number of samples (using the same sample rate from Decoder)
+   * @param milliseconds Time offset (in milliseconds)
+   * @return Number of samples
+   */
+  int64_t ToSamples(int64_t milliseconds) const {
+    return milliseconds * format_.sample_rate / 1000;
+  }
+
+  /**
+   * @brief Choose format to play song, preferring its own sample rate (or an integer fraction of
+   * it) and a bit depth above 16 bits for high-resolution songs, when passthrough is enabled and
+   * playback supports it, otherwise fallback to default format (resampled by decoder)
+   * @param song Song opened by decoder
+   * @return Audio format for both decoder output and playback stream
+   */
+  model::AudioFormat NegotiateFormat(const model::Song& song);
+
+  /**
+   * @brief Reconfigure playback stream in case that format has changed
+   * @param format Audio format negotiated for the song
+   * @return error::Code Application error code
+   */
+  error::Code ApplyFormat(const model::AudioFormat& format);
+
+  /**
+   * @brief Reconfigure playback stream with another latency profile
+   * @param profile Latency profile
+   * @return error::Code Application error code
+   */
+  error::Code ApplyLatencyProfile(driver::LatencyProfile profile);
+
+  /**
+   * @brief Read period size granted by playback stream and inform interface about it (so audio
+   * analysis follows the same pace as playback)
+   */
+  void UpdatePeriodSize();
 
   /**
-   * @brief Main-loop function to decode input stream and write to playback stream
+   * @brief Update how many samples are kept in audio buffer, so it holds the depth asked by
+   * options at the sample rate from current playback stream
+   */
+  void UpdateBufferDepth();
+
+  /**
+   * @brief Main-loop function to decode input stream and write to playback stream (or to audio
+   * buffer, when it is enabled)
    */
   void AudioHandler();
 
+  /**
+   * @brief Main-loop function to consume decoded samples from audio buffer and write to playback
+   * stream (only used when audio buffer is enabled)
+   */
+  void PlaybackHandler();
+
+  /**
+   * @brief Prepare calling thread to write samples into playback stream with real-time scheduling
+   * (when enabled by options)
+   */
+  void SetupRealtimeThread() const;
+
+  /**
+   * @brief Write decoded samples into audio buffer, waiting for free space if necessary
+   * @param buffer Audio buffer
+   * @param size Buffer size (in frames)
+   */
+  void WriteToBuffer(const void* buffer, int size);
+
+  /**
+   * @brief Publish audible position to playback clock, discounting samples that are still waiting
+   * in audio buffer or in playback stream
+   * @param position Position right after the last sample written (in samples)
+   * @param running Position keeps moving after this (i.e. song is not paused)
+   */
+  void PublishPosition(int64_t position, bool running);
+
+  /**
+   * @brief Block thread until playback handler consumes all samples from audio buffer
+   */
+  void WaitForBufferDrain();
+
+  /**
+   * @brief Create default decoder (used to open next song in advance)
+   * @return Decoder instance
+   */
+  std::unique_ptr<driver::Decoder> CreateDecoder() const;
+
+  /**
+   * @brief Create playback for the output selected in options (sound device, null or file)
+   * @param options Tunable parameters
+   * @return Playback instance
+   */
+  static std::unique_ptr<driver::Playback> CreatePlayback(const PlayerOptions& options);
+
+  /**
+   * @brief Open next song in a second decoder when current song is about to finish, so it can be
+   * played right after the last sample from current song (gapless playback)
+   * @param position Current position in the song (in seconds)
+   */
+  void PreloadNextSong(int64_t position);
+
+  /**
+   * @brief Replace current song by the next one opened in advance (if any), keeping playback
+   * stream running
+   * @return True if next song has replaced current one, False if there is no song opened
+   */
+  bool SwitchToNextSong();
+
+  /**
+   * @brief Close next song opened in advance (if any)
+   */
+  void DiscardNextSong();
+
   /* ******************************************************************************************** */
   //! Binds and registrations
  public:
@@ -164,13 +348,13 @@ class Player : public AudioControl {
 
   /**
    * @brief Inform audio loop to seek forward position on current playing song
-   * @param value Offset position
+   * @param value Offset position (in milliseconds)
    */
   void SeekForwardPosition(int value) override;
 
   /**
    * @brief Inform audio loop to seek backward position on current playing song
-   * @param value Offset position
+   * @param value Offset position (in milliseconds)
    */
   void SeekBackwardPosition(int value) override;
 
@@ -180,11 +364,77 @@ class Player : public AudioControl {
    */
   void ApplyAudioFilters(const model::EqualizerPreset& filters) override;
 
+  /**
+   * @brief Inform audio loop about the song expected to be played right after the current one
+   * (P.S.: this is just a hint, in case of a request to play another song, it is ignored)
+   * @param filepath Full path to file
+   */
+  void SetNextSong(const std::string& filepath) override;
+
+  /**
+   * @brief Change latency profile from playback stream (while song is playing, audio loop applies
+   * it after the samples already written to playback stream are played)
+   * @param profile Latency profile
+   */
+  void SetLatencyProfile(driver::LatencyProfile profile);
+
   /**
    * @brief Exit from Audio loop
    */
   void Exit() final;
 
+  /* ******************************************************************************************** */
+  //! Statistics
+
+  /**
+   * @brief Detailed information about the audio buffer between decoding and playback threads
+   */
+  struct BufferStatus {
+    int capacity_ms;     //!< Maximum depth (in milliseconds)
+    int fill_ms;         //!< Current fill level (in milliseconds)
+    uint64_t underruns;  //!< Number of times that playback thread starved while song was playing
+  };
+
+  /**
+   * @brief Get current status from audio buffer
+   * @return Audio buffer status (zeroed when audio buffer is disabled)
+   */
+  BufferStatus GetBufferStatus() const;
+
+  /**
+   * @brief Detailed information about the queue with commands sent to audio thread
+   */
+  struct CommandStatus {
+    size_t queue_depth;  //!< Number of commands waiting to be handled
+    uint64_t coalesced;  //!< Number of commands merged into another one (instead of handled alone)
+  };
+
+  /**
+   * @brief Get current status from command queue
+   * @return Command queue status
+   */
+  CommandStatus GetCommandStatus() const;
+
+  /**
+   * @brief Get queue with songs to play, so songs can be added to it by anyone (player opens the
+   * upcoming song in advance and advances by itself when current song finishes)
+   * @return Play queue
+   */
+  std::shared_ptr<PlayQueue> GetPlayQueue() const { return queue_; }
+
+  /**
+   * @brief Get clock with audible position from current song, so user interface can read it at
+   * any time (e.g. when rendering), without waiting for a notification
+   * @return Playback clock (updated only by audio thread)
+   */
+  std::shared_ptr<const model::PlaybackClock> GetPlaybackClock() const { return clock_; }
+
+  /**
+   * @brief Get counters from playback stream (underruns, recoveries, write latency and jitter)
+   * @return Playback statistics
+   */
+  driver::Playback::Statistics GetPlaybackStatistics() const;
+
   /* ******************************************************************************************** */
   //! Custom class for blocking actions
  private:
@@ -231,30 +481,36 @@ class Player : public AudioControl {
   /**
    * @brief An structure for data synchronization considering external events (currently used in
    * some situations like: to block thread while waiting to start playing and also for resuming
-   * audio when it is paused)
+   * audio when it is paused). Commands are exchanged through a lock-free queue, as audio thread
+   * checks it for every decoded buffer, and mutex/condition variable are only used to park audio
+   * thread while waiting for a command.
    */
   struct MediaControlSynced {
-    std::mutex mutex;                  //!< Control access for internal resources
+    std::mutex mutex;                  //!< Control access for idle waiting
     std::condition_variable notifier;  //!< Conditional variable to block thread
 
-    std::deque<Command> queue;               //!< Queue with media control commands
-    std::atomic<State> state = State::Idle;  //!< Current state
+    util::MpscQueue<Command> queue{kCommandQueueSize};  //!< Queue with media control commands
+    std::atomic<State> state = State::Idle;             //!< Current state
+
+    std::atomic<uint64_t> coalesced = 0;  //!< Counter for commands merged into another one
 
     /**
-     * @brief Reset media controls
+     * @brief Reset media controls (must be called only by audio thread)
      */
     void Reset() {
-      // Copy queue and clear it
-      std::deque<Command> dummy;
-      dummy.swap(queue);
+      // Only commands already in queue are handled, anything pushed meanwhile stays there
+      size_t count = queue.Size();
+      bool exit = state == State::Exit;
+
+      // Set state to idle
+      if (!exit) state = State::Idle;
 
-      if (state != State::Exit) {
-        // Set state to idle
-        state = State::Idle;
+      for (size_t i = 0; i < count; i++) {
+        Command cmd = Command::None();
+        if (!queue.Pop(cmd)) break;
 
         // Re-add to queue only new requests to play song
-        std::copy_if(dummy.begin(), dummy.end(), std::back_inserter(queue),
-                     [](const Command& c) { return c == Command::Identifier::Play; });
+        if (!exit && cmd == Command::Identifier::Play) queue.Push(std::move(cmd));
       }
     }
 
@@ -263,32 +519,75 @@ class Player : public AudioControl {
      * @param cmd Media command
      */
     void Push(const Command& cmd) {
-      std::unique_lock lock(mutex);
+      // In case of exit request, any command still in queue is ignored from now on
+      if (cmd == Command::Identifier::Exit) state = State::Exit;
 
-      // Clear queue in case of exit request
-      if (cmd == Command::Identifier::Exit) {
-        std::deque<Command>().swap(queue);
-        state = State::Exit;
-      }
+      if (!queue.Push(cmd)) ERROR("Media control queue is full, discard command=", cmd);
 
-      queue.push_back(cmd);
+      // Audio thread checks queue while holding mutex, so taking it here (even without touching
+      // anything) guarantees that this notification is not lost
+      std::unique_lock lock(mutex);
       notifier.notify_one();
     }
 
     /**
-     * @brief Pop command from media control queue
+     * @brief Pop command from media control queue (must be called only by audio thread). When
+     * there is nothing in queue, this is just an atomic load (no lock or allocation at all)
      * @return Media command
      */
     Command Pop() {
-      std::unique_lock lock(mutex);
-      if (queue.empty()) return Command::None();
+      Command cmd = Command::None();
+      if (queue.Empty() || !queue.Pop(cmd)) return cmd;
 
-      auto cmd = queue.front();
-      queue.pop_front();
+      // Merge burst of commands sent by UI (e.g. while holding arrow key), so audio thread handles
+      // all of them at once, instead of one per decoded buffer
+      while (Command* next = queue.Front()) {
+        if (!Coalesce(cmd, *next)) break;
+
+        Command discarded = Command::None();
+        queue.Pop(discarded);
+        coalesced++;
+      }
 
       return cmd;
     }
 
+    /**
+     * @brief Merge command into the previous one, when handling only the result is equivalent to
+     * handling both in sequence: consecutive seeks are summed into a single offset (clamped to
+     * song boundaries when handled), and for volume, audio filters and latency profile only the
+     * latest value matters
+     * @param cmd Command popped from queue (updated with merged result)
+     * @param next Command right after it in queue
+     * @return true if next command was merged (so it must be discarded), false otherwise
+     */
+    static bool Coalesce(Command& cmd, const Command& next) {
+      using Id = Command::Identifier;
+      auto is_seek = [](const Command& c) {
+        return c == Id::SeekForward || c == Id::SeekBackward;
+      };
+
+      if (is_seek(cmd) && is_seek(next)) {
+        // Offset is signed from here, where positive means forward
+        auto offset = [](const Command& c) {
+          int value = c.GetContent<int>();
+          return c == Id::SeekForward ? value : -value;
+        };
+
+        int total = offset(cmd) + offset(next);
+        cmd = total >= 0 ? Command::SeekForward(total) : Command::SeekBackward(-total);
+        return true;
+      }
+
+      if (cmd == next && (next == Id::SetVolume || next == Id::UpdateAudioFilters ||
+                          next == Id::SetLatencyProfile)) {
+        cmd = next;
+        return true;
+      }
+
+      return false;
+    }
+
     /**
      * @brief Block thread until user interface sends events matching the expected command(s). As
      * this is a blocking operation, when one of the expected commands matches with the one from
@@ -308,24 +607,24 @@ class Player : public AudioControl {
 
         // Pop commands from queue
         std::vector<Command> expected = {cmds...};
-        while (!queue.empty()) {
-          Command current = queue.front();
-          LOG("Received command:", current);
+        while (Command* current = queue.Front()) {
+          LOG("Received command:", *current);
 
-          if (current == Command::Exit()) {
+          if (*current == Command::Exit()) {
             // In case of exit, update state
-            state = TranslateCommand(current);
+            state = TranslateCommand(*current);
             return true;
           }
 
           // Check if it matches with some command from list
-          if (std::find(expected.begin(), expected.end(), current) != expected.end()) {
+          if (std::find(expected.begin(), expected.end(), *current) != expected.end()) {
             // Found expected command, now unblock thread
             return true;
           }
 
           // Pop command from queue
-          queue.pop_front();
+          Command discarded = Command::None();
+          queue.Pop(discarded);
         }
 
         // No command in queue or didn't match expect command in list
@@ -336,20 +635,110 @@ class Player : public AudioControl {
     }
   };
 
+  /**
+   * @brief An structure to share decoded samples between decoding thread (producer) and playback
+   * thread (consumer). Samples are exchanged through a lock-free ring buffer, and mutex/condition
+   * variable are only used to park playback thread while there is nothing to play.
+   */
+  struct AudioBufferSynced {
+    util::RingBuffer<float> samples;  //!< Interleaved samples waiting to be played
+
+    std::mutex mutex;                  //!< Control access for idle waiting
+    std::condition_variable notifier;  //!< Conditional variable to block playback thread
+
+    std::atomic<uint64_t> underruns = 0;  //!< Counter for playback thread starving
+
+    std::atomic<size_t> depth = 0;  //!< Maximum samples kept (less than capacity, as buffer is
+                                    //!< allocated once for the highest sample rate)
+    std::atomic<uint32_t> sample_rate = kSampleRate;  //!< Sample rate from samples in buffer
+
+    /**
+     * @brief Wake up playback thread
+     */
+    void Notify() { notifier.notify_one(); }
+
+    /**
+     * @brief Block playback thread until it is notified or reaches timeout
+     * @param timeout Maximum time to wait
+     */
+    template <typename Duration>
+    void WaitFor(const Duration& timeout) {
+      std::unique_lock lock(mutex);
+      notifier.wait_for(lock, timeout);
+    }
+  };
+
+  /* ******************************************************************************************** */
+  //! Default Constants
+
+  static constexpr int kChannels = 2;            //!< Number of channels decoded by Decoder
+  static constexpr int kSampleRate = 44100;      //!< Default sample rate decoded by Decoder
+  static constexpr int kMaxSampleRate = 192000;  //!< Highest sample rate negotiated with playback
+  static constexpr int kBitDepth = 16;           //!< Number of bits per sample decoded by Decoder
+
+  static constexpr model::AudioFormat kDefaultFormat{kSampleRate, kChannels, kBitDepth};
+
+  static constexpr size_t kCommandQueueSize = 1024;  //!< Maximum commands waiting to be handled
+
+  static constexpr auto kBufferBackoff = std::chrono::milliseconds(5);  //!< Wait for free space
+  static constexpr auto kIdleTimeout = std::chrono::milliseconds(20);   //!< Wait for new samples
+
+  static constexpr int kPreloadThreshold = 5;  //!< Remaining time (in seconds) from current song
+                                               //!< to open next one in advance
+
   /* ******************************************************************************************** */
   //! Variables
   std::unique_ptr<driver::Playback> playback_;  //!< Handle playback stream
   std::unique_ptr<driver::Decoder> decoder_;    //!< Open file as input stream and parse samples
 
-  std::thread audio_loop_;  //!< Execute audio-loop function as a thread
+  PlayerOptions options_;  //!< Tunable parameters
+
+  std::shared_ptr<driver::PcmCache> cache_;  //!< Decoded songs (shared by current and next decoder)
+
+  std::thread audio_loop_;     //!< Execute audio-loop function as a thread
+  std::thread playback_loop_;  //!< Execute playback-loop function as a thread (optional)
 
   MediaControlSynced media_control_;  // Controls the media (play, pause/resume and stop)
 
+  std::mutex playback_mutex_;  //!< Control access to playback stream (shared by both threads)
+  AudioBufferSynced buffer_;   //!< Decoded audio waiting to be played
+
   std::unique_ptr<model::Song> curr_song_;  //!< Current song playing
 
+  std::unique_ptr<driver::Decoder> next_decoder_;  //!< Open next song in advance (gapless playback)
+  std::unique_ptr<model::Song> next_song_;         //!< Next song already opened by next decoder
+
+  std::mutex next_filepath_mutex_;  //!< Control access to next filepath (shared with UI thread)
+  std::string next_filepath_;       //!< Song expected to be played right after the current one
+  std::atomic<uint64_t> next_filepath_changes_ = 0;  //!< Number of times that UI set next filepath
+
+  std::shared_ptr<PlayQueue> queue_ = std::make_shared<PlayQueue>();  //!< Songs to play
+  std::string failed_preload_;  //!< Next song that could not be opened in advance (not retried)
+
+  //! Changes from UI and play queue already seen when opening next song in advance, so next song
+  //! is only read again (which takes a lock) after any of them changes it
+  std::optional<uint64_t> preload_changes_;
+
+  model::EqualizerPreset filters_;  //!< Last audio filters applied to decoder
+
+  //! Last volume requested, so UI thread never reads it from decoder while audio thread may be
+  //! swapping it with next decoder (it is applied again to decoder when song is opened or resumed,
+  //! as commands received meanwhile are discarded)
+  std::atomic<model::Volume> volume_{model::Volume{}};
+
   std::weak_ptr<interface::Notifier> notifier_;  //!< Send notifications to interface
 
-  int period_size_;  //!< Period size from Playback driver
+  std::mutex notifier_mutex_;  //!< Control access to notifier while playback stream initializes
+  bool initialized_ = false;   //!< Playback stream is ready and period size is known
+
+  std::atomic<int> period_size_ = 0;           //!< Period size from Playback driver
+  error::Code init_result_ = error::kSuccess;  //!< Result from playback stream initialization
+
+  //! Audible position from current song (shared with UI)
+  std::shared_ptr<model::PlaybackClock> clock_ = std::make_shared<model::PlaybackClock>();
+
+  model::AudioFormat format_ = kDefaultFormat;       //!< Format from current playback stream
+  model::AudioFormat next_format_ = kDefaultFormat;  //!< Format negotiated for next song
 
   /* ******************************************************************************************** */
   //! Friend class for testing purpose
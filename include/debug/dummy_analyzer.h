@@ -55,6 +55,20 @@ class DummyAnalyzer : public Analyzer {
    */
   int GetBufferSize() override { return kBufferSize; }
 
+  /**
+   * @brief Set period size from playback stream
+   *
+   * @param size Period size (in frames)
+   */
+  void SetPeriodSize(int size) override {}
+
+  /**
+   * @brief Set sample rate from audio data
+   *
+   * @param sample_rate Number of frames per second
+   */
+  void SetSampleRate(int sample_rate) override {}
+
   /**
    * @brief Get output buffer size
    *
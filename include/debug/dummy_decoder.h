@@ -6,7 +6,6 @@
 #ifndef INCLUDE_DEBUG_DUMMY_DECODER_H_
 #define INCLUDE_DEBUG_DUMMY_DECODER_H_
 
-#include <functional>
 #include <map>
 #include <vector>
 
@@ -40,7 +39,7 @@ class DummyDecoder : public Decoder {
    * @brief Function invoked after resample is available.
    * (for better understanding: take a look at Audio Loop from Player, and also Playback class)
    */
-  using AudioCallback = std::function<bool(void*, int, int64_t&)>;
+  using AudioCallback = util::FunctionRef<bool(void*, int, int64_t&)>;
 
   /**
    * @brief Open file as input stream and check for codec compatibility for decoding
@@ -59,6 +58,16 @@ class DummyDecoder : public Decoder {
     return error::kSuccess;
   }
 
+  /**
+   * @brief Set format for decoded samples, agreed with playback
+   * @param format Audio format for decoded samples
+   * @param passthrough Allow to skip volume and equalizer while they would not change any sample
+   * @return error::Code Application error code
+   */
+  error::Code SetOutputFormat(const model::AudioFormat& format, bool passthrough) override {
+    return error::kSuccess;
+  }
+
   /**
    * @brief Decode and resample input stream to desired sample format/rate
    * @param samples Maximum value of samples
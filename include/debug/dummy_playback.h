@@ -42,6 +42,27 @@ class DummyPlayback : public Playback {
    */
   error::Code ConfigureParameters() override { return error::kSuccess; }
 
+  /**
+   * @brief Check if playback device accepts the given format (without changing current one)
+   * @param format Audio format
+   * @return true if format is supported, false otherwise
+   */
+  bool IsFormatSupported(const model::AudioFormat& format) override { return true; }
+
+  /**
+   * @brief Reconfigure playback stream to use another format
+   * @param format Audio format
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code SetFormat(const model::AudioFormat& format) override { return error::kSuccess; }
+
+  /**
+   * @brief Reconfigure playback stream to use another latency profile
+   * @param profile Latency profile
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code SetLatencyProfile(LatencyProfile profile) override { return error::kSuccess; }
+
   /**
    * @brief Make playback stream ready to play
    * @return error::Code Playback error converted to application error code
@@ -54,6 +75,12 @@ class DummyPlayback : public Playback {
    */
   error::Code Pause() override { return error::kSuccess; }
 
+  /**
+   * @brief Resume current song on playback stream
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code Resume() override { return error::kSuccess; }
+
   /**
    * @brief Stop playing song on playback stream
    * @return error::Code Playback error converted to application error code
@@ -83,12 +110,24 @@ class DummyPlayback : public Playback {
    */
   model::Volume GetVolume() override { return model::Volume(); }
 
+  /**
+   * @brief Set listener for volume changes on playback stream
+   * @param listener Callback invoked only when volume value actually changes
+   */
+  void SetVolumeListener(VolumeListener listener) override {}
+
   /**
    * @brief Get period size
    * @return uint32_t Period size
    */
   uint32_t GetPeriodSize() const override { return kPeriodSize; }
 
+  /**
+   * @brief Get counters from samples written into playback stream
+   * @return Statistics Counters
+   */
+  Statistics GetStatistics() const override { return Statistics{}; }
+
   /* ******************************************************************************************** */
   //! Constants
  private:
@@ -0,0 +1,160 @@
+/**
+ * \file
+ * \brief  Class for controlling player without terminal user interface
+ */
+
+#ifndef INCLUDE_MIDDLEWARE_HEADLESS_CONTROLLER_H_
+#define INCLUDE_MIDDLEWARE_HEADLESS_CONTROLLER_H_
+
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "audio/play_queue.h"
+#include "audio/player.h"
+#include "model/application_error.h"
+#include "model/song.h"
+#include "view/base/notifier.h"
+
+namespace middleware {
+
+/**
+ * @brief Receives notifications from player when there is no terminal user interface (e.g. while
+ * rendering songs into a file sink), playing every song from play queue once and then, unblocking
+ * whoever is waiting for completion. Player advances to the next song by itself, so this is only
+ * needed to skip songs that cannot be played and to detect the end of play queue. Audio samples
+ * are still forwarded to audio analysis, when given one.
+ */
+class HeadlessController : public interface::Notifier {
+  /**
+   * @brief Construct a new HeadlessController object
+   * @param player_ctl Interface to Audio player
+   * @param queue Songs to play
+   * @param analysis Receiver for audio samples to analyze (optional)
+   */
+  HeadlessController(const std::shared_ptr<audio::AudioControl>& player_ctl,
+                     const std::shared_ptr<audio::PlayQueue>& queue,
+                     const std::shared_ptr<interface::Notifier>& analysis);
+
+ public:
+  /**
+   * @brief Factory method: Create and return HeadlessController object
+   * @param player_ctl Interface to Audio player
+   * @param queue Songs to play
+   * @param analysis Receiver for audio samples to analyze (optional, e.g. MediaController without
+   * terminal, so audio analysis runs the same as with UI)
+   * @return std::shared_ptr<HeadlessController> HeadlessController instance
+   */
+  static std::shared_ptr<HeadlessController> Create(
+      const std::shared_ptr<audio::AudioControl>& player_ctl,
+      const std::shared_ptr<audio::PlayQueue>& queue,
+      const std::shared_ptr<interface::Notifier>& analysis = nullptr);
+
+  /**
+   * @brief Destroy the HeadlessController object
+   */
+  ~HeadlessController() override = default;
+
+  /* ******************************************************************************************** */
+  //! Public API
+
+  /**
+   * @brief List files to play from the given path, in alphabetical order (a single file is
+   * played as it is, and files that are not songs are skipped later, as they fail to open)
+   * @param path Path to file or directory
+   * @return Files found
+   */
+  static std::vector<std::filesystem::path> ListFiles(const std::filesystem::path& path);
+
+  /**
+   * @brief Ask player to play the first song from play queue
+   * @return true if there is some song to play, false otherwise
+   */
+  bool Start();
+
+  /**
+   * @brief Block caller until every song from play queue was played (or failed to play)
+   */
+  void WaitForCompletion();
+
+  /* ******************************************************************************************** */
+  //! Actions received from Player
+
+  /**
+   * @brief Nothing to clear, as there is no UI
+   * @param playing Last media state
+   */
+  void ClearSongInformation(bool playing) override {}
+
+  /**
+   * @brief Log song that started to play
+   * @param info Detailed audio information from the current song
+   */
+  void NotifySongInformation(const model::Song& info) override;
+
+  /**
+   * @brief Finish when player informs that play queue has finished
+   * @param state Updated state information
+   */
+  void NotifySongState(const model::Song::CurrentInformation& state) override;
+
+  /**
+   * @brief Forward audio samples to analysis (if any)
+   * @param buffer Audio samples (interleaved float)
+   * @param size Sample count (considering all channels)
+   */
+  void SendAudioRaw(float* buffer, int size) override;
+
+  /**
+   * @brief Forward period size to analysis (if any)
+   * @param size Period size (in frames)
+   */
+  void NotifyPeriodSize(int size) override;
+
+  /**
+   * @brief Forward sample rate to analysis (if any)
+   * @param sample_rate Number of frames per second
+   */
+  void NotifySampleRate(int sample_rate) override;
+
+  /**
+   * @brief Nothing to show, as there is no UI
+   * @param value New volume
+   */
+  void NotifyVolume(model::Volume value) override {}
+
+  /**
+   * @brief Skip song that could not be played, and play the next one from play queue
+   * @param code Application error code
+   */
+  void NotifyError(error::Code code) override;
+
+  /* ******************************************************************************************** */
+  //! Internal operations
+ private:
+  /**
+   * @brief Play next song from play queue, or finish if there is none left
+   */
+  void PlayNext();
+
+  /**
+   * @brief Mark play queue as finished and unblock whoever is waiting for it
+   */
+  void Finish();
+
+  /* ******************************************************************************************** */
+  //! Variables
+
+  std::weak_ptr<audio::AudioControl> player_ctl_;  //!< Send commands to Audio Player
+  std::shared_ptr<audio::PlayQueue> queue_;        //!< Songs to play
+  std::shared_ptr<interface::Notifier> analysis_;  //!< Run audio analysis on samples (optional)
+
+  std::mutex mutex_;                     //!< Control access to finished flag
+  std::condition_variable finished_cv_;  //!< Wake up caller waiting for completion
+  bool finished_ = false;                //!< Every song from play queue was played
+};
+
+}  // namespace middleware
+#endif  // INCLUDE_MIDDLEWARE_HEADLESS_CONTROLLER_H_
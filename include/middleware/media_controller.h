@@ -59,7 +59,7 @@ class MediaController : public audio::Notifier, public interface::Notifier {
  public:
   /**
    * @brief Factory method: Create, initialize internal components and return MediaController object
-   * @param terminal Event dispatcher for Interface
+   * @param terminal Event dispatcher for Interface (null to run only audio analysis, without UI)
    * @param player Interface to Audio player
    * @param bars Maximum number of bars that will be returned as output from the Audio Analysis
    * @param analyzer Pass analyzer to be used within Analysis thread (optional)
@@ -135,13 +135,13 @@ class MediaController : public audio::Notifier, public interface::Notifier {
 
   /**
    * @brief Notify Audio Player to seek forward position in current playing song
-   * @param value Offset value
+   * @param value Offset value (in milliseconds)
    */
   void SeekForwardPosition(int value) override;
 
   /**
    * @brief Notify Audio Player to seek backward position in current playing song
-   * @param value Offset value
+   * @param value Offset value (in milliseconds)
    */
   void SeekBackwardPosition(int value) override;
 
@@ -151,6 +151,13 @@ class MediaController : public audio::Notifier, public interface::Notifier {
    */
   void ApplyAudioFilters(const model::EqualizerPreset& frequencies) override;
 
+  /**
+   * @brief Receive a notification from view about the file expected to be played next. Notify
+   * Audio Player about this, so it can be opened in advance (gapless playback).
+   * @param file Complete filepath to file entry
+   */
+  void NotifyNextFileSelection(const std::filesystem::path& file) override;
+
   /* ******************************************************************************************** */
   //! Actions received from Player and sent to UI
 
@@ -174,10 +181,29 @@ class MediaController : public audio::Notifier, public interface::Notifier {
 
   /**
    * @brief Send raw audio samples to UI
-   * @param buffer Audio samples
-   * @param size Sample count
+   * @param buffer Audio samples (interleaved float)
+   * @param size Sample count (considering all channels)
    */
-  void SendAudioRaw(int* buffer, int size) override;
+  void SendAudioRaw(float* buffer, int size) override;
+
+  /**
+   * @brief Notify UI about period size from playback stream, so audio analysis follows its pace
+   * @param size Period size (in frames)
+   */
+  void NotifyPeriodSize(int size) override;
+
+  /**
+   * @brief Notify UI about sample rate from playback stream, so audio analysis maps each bar to
+   * the right frequencies
+   * @param sample_rate Number of frames per second
+   */
+  void NotifySampleRate(int sample_rate) override;
+
+  /**
+   * @brief Notify UI with volume changed outside of this application
+   * @param value New volume
+   */
+  void NotifyVolume(model::Volume value) override;
 
   /**
    * @brief Notify UI with error code from some background operation
@@ -228,6 +254,10 @@ class MediaController : public audio::Notifier, public interface::Notifier {
       std::vector<double> output(first, last);
       buffer.erase(first, last);
 
+      // Player may append more than a single chunk at once (e.g. a whole period from playback
+      // thread), so keep analyzing while there is enough data left for another chunk
+      if (size > 0 && buffer.size() >= size) queue.push(Command::Analyze);
+
       return output;
     }
 
@@ -237,7 +267,7 @@ class MediaController : public audio::Notifier, public interface::Notifier {
      * @param input Array with raw data
      * @param size Array size
      */
-    void Append(int* input, int size) {
+    void Append(float* input, int size) {
       std::unique_lock lock(mutex);
       std::vector<double>::const_iterator end = buffer.end();
 
@@ -337,6 +367,7 @@ class MediaController : public audio::Notifier, public interface::Notifier {
   /* ******************************************************************************************** */
   //! Variables
   std::weak_ptr<interface::EventDispatcher> dispatcher_;  //!< Send events to UI blocks
+  bool headless_;                                         //!< No UI to send events to
   std::weak_ptr<audio::AudioControl> player_ctl_;         //!< Send events to control Audio Player
 
   std::unique_ptr<driver::Analyzer> analyzer_;  //!< Run FFTs on audio raw data to get spectrum
@@ -0,0 +1,44 @@
+/**
+ * \file
+ * \brief  Base class for audio stream format
+ */
+
+#ifndef INCLUDE_MODEL_AUDIO_FORMAT_H_
+#define INCLUDE_MODEL_AUDIO_FORMAT_H_
+
+#include <cstdint>
+#include <ostream>
+#include <tuple>
+
+namespace model {
+
+/**
+ * @brief Format from an audio stream containing interleaved PCM samples, used by decoder and
+ * playback to agree on the samples exchanged between them (decoder always outputs float samples,
+ * so bit depth refers to the samples written by playback to device, which are signed integers
+ * unless floating point is set)
+ */
+struct AudioFormat {
+  uint32_t sample_rate;         //!< Number of frames per second
+  uint16_t channels;            //!< Number of interleaved channels
+  uint16_t bit_depth;           //!< Number of bits per sample (24 bits are stored in 32 bits)
+  bool floating_point = false;  //!< Samples are written as float (only with 32 bits)
+
+  // For comparisons
+  bool operator==(const AudioFormat& other) const {
+    return std::tie(sample_rate, channels, bit_depth, floating_point) ==
+           std::tie(other.sample_rate, other.channels, other.bit_depth, other.floating_point);
+  }
+
+  bool operator!=(const AudioFormat& other) const { return !operator==(other); }
+
+  // Output to ostream
+  friend std::ostream& operator<<(std::ostream& out, const AudioFormat& f) {
+    out << "{sample_rate:" << f.sample_rate << " channels:" << f.channels
+        << " bit_depth:" << f.bit_depth << (f.floating_point ? " float" : "") << "}";
+    return out;
+  }
+};
+
+}  // namespace model
+#endif  // INCLUDE_MODEL_AUDIO_FORMAT_H_
@@ -0,0 +1,121 @@
+/**
+ * \file
+ * \brief  Class for sharing the audible position from current song between threads
+ */
+
+#ifndef INCLUDE_MODEL_PLAYBACK_CLOCK_H_
+#define INCLUDE_MODEL_PLAYBACK_CLOCK_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace model {
+
+/**
+ * @brief Position from current song, timestamped with a monotonic clock at the moment it was
+ * measured. Audio thread publishes it after writing samples, and user interface reads it whenever
+ * it renders, interpolating with the time elapsed since then. Both sides are lock-free: writer
+ * bumps a sequence number around each update (sequence lock), and reader simply tries again if it
+ * was caught in the middle of one.
+ */
+class PlaybackClock {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief Values published at once
+   */
+  struct Snapshot {
+    int64_t position = 0;      //!< Audible position (in samples)
+    uint32_t sample_rate = 0;  //!< Sample rate used to count position (zero if nothing playing)
+    bool running = false;      //!< Position keeps moving (i.e. song is not paused)
+    Clock::time_point timestamp;  //!< When position was measured
+  };
+
+  /**
+   * @brief Publish a new position (must be called only by a single thread)
+   * @param position Audible position (in samples)
+   * @param sample_rate Sample rate used to count position
+   * @param running Position keeps moving after this
+   * @param now Current time
+   */
+  void Publish(int64_t position, uint32_t sample_rate, bool running,
+               Clock::time_point now = Clock::now()) {
+    uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    position_.store(position, std::memory_order_relaxed);
+    sample_rate_.store(sample_rate, std::memory_order_relaxed);
+    running_.store(running, std::memory_order_relaxed);
+    timestamp_.store(now.time_since_epoch().count(), std::memory_order_relaxed);
+
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  /**
+   * @brief Clear position, as there is no song playing (must be called only by the same thread
+   * that publishes it)
+   */
+  void Reset() { Publish(0, 0, false, Clock::time_point{}); }
+
+  /**
+   * @brief Read values published, all of them from the same update (may be called by any thread)
+   * @return Snapshot Position and its timestamp
+   */
+  Snapshot Load() const {
+    Snapshot snapshot;
+
+    for (;;) {
+      uint32_t before = sequence_.load(std::memory_order_acquire);
+
+      snapshot.position = position_.load(std::memory_order_relaxed);
+      snapshot.sample_rate = sample_rate_.load(std::memory_order_relaxed);
+      snapshot.running = running_.load(std::memory_order_relaxed);
+      snapshot.timestamp =
+          Clock::time_point{Clock::duration{timestamp_.load(std::memory_order_relaxed)}};
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+
+      // Odd sequence means that writer was in the middle of an update
+      if (before % 2 == 0 && sequence_.load(std::memory_order_relaxed) == before) break;
+    }
+
+    return snapshot;
+  }
+
+  /**
+   * @brief Get position at the given time, extrapolating it from the last one published while
+   * song is running (limited to a short interval, in case audio thread stops publishing)
+   * @param now Current time
+   * @return int64_t Position (in milliseconds), or -1 if there is no position published
+   */
+  int64_t GetMilliseconds(Clock::time_point now = Clock::now()) const {
+    Snapshot snapshot = Load();
+    if (snapshot.sample_rate == 0) return -1;
+
+    int64_t milliseconds = snapshot.position * 1000 / snapshot.sample_rate;
+    if (!snapshot.running) return milliseconds;
+
+    auto elapsed =
+        std::chrono::duration_cast<std::chrono::milliseconds>(now - snapshot.timestamp).count();
+
+    return milliseconds + std::clamp<int64_t>(elapsed, 0, kMaxExtrapolation);
+  }
+
+  /* ******************************************************************************************** */
+  //! Variables
+ private:
+  static constexpr int64_t kMaxExtrapolation = 1000;  //!< Maximum interpolation (in milliseconds)
+
+  std::atomic<uint32_t> sequence_ = 0;     //!< Odd while writer is updating values
+  std::atomic<int64_t> position_ = 0;      //!< Audible position (in samples)
+  std::atomic<uint32_t> sample_rate_ = 0;  //!< Sample rate used to count position
+  std::atomic<bool> running_ = false;      //!< Position keeps moving
+  std::atomic<Clock::rep> timestamp_ = 0;  //!< When position was measured (clock ticks)
+};
+
+}  // namespace model
+#endif  // INCLUDE_MODEL_PLAYBACK_CLOCK_H_
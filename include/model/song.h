@@ -38,9 +38,26 @@ struct Song {
     Finished = 2005,
   };
 
+  /**
+   * @brief Current state of song, where position is kept as a rational timestamp (number of samples
+   * counted with the given sample rate), so it is precise down to a single sample
+   */
   struct CurrentInformation {
-    MediaState state;   //!< Current song state
-    uint32_t position;  //!< Current position (in seconds) of the audio
+    MediaState state;      //!< Current song state
+    int64_t position;      //!< Current position (in samples) of the audio
+    uint32_t sample_rate;  //!< Sample rate used to count position (time base is 1/sample_rate)
+
+    /**
+     * @brief Get current position in milliseconds
+     * @return Position truncated to milliseconds (or zero, if sample rate is unknown)
+     */
+    int64_t GetMilliseconds() const;
+
+    /**
+     * @brief Get current position in seconds
+     * @return Position truncated to seconds (or zero, if sample rate is unknown)
+     */
+    uint32_t GetSeconds() const;
 
     //! Overloaded operators
     bool operator==(const CurrentInformation& other) const;
@@ -0,0 +1,79 @@
+/**
+ * \file
+ * \brief  Single-header for a non-owning reference to any callable object
+ */
+
+#ifndef INCLUDE_UTIL_FUNCTION_REF_H_
+#define INCLUDE_UTIL_FUNCTION_REF_H_
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace util {
+
+template <typename Signature>
+class FunctionRef;
+
+/**
+ * @brief Lightweight alternative to std::function for callbacks that are only invoked while the
+ * function receiving them is running. It holds a pointer to the callable object and a pointer to a
+ * function generated for its concrete type, so it never allocates memory, copying it costs two
+ * pointers and invoking it is a single indirect call (through that function pointer) into code
+ * where the callable was inlined. Unlike a template parameter, it still cannot be inlined into the
+ * caller, which costs a few nanoseconds per call (see benchmark/decode_callback.cc).
+ *
+ * P.S. the callable object is not copied, so it must outlive this reference (e.g. a lambda passed
+ * as argument lives until the called function returns).
+ *
+ * @tparam R Return type
+ * @tparam Args Argument types
+ */
+template <typename R, typename... Args>
+class FunctionRef<R(Args...)> {
+ public:
+  /**
+   * @brief Construct a new FunctionRef object
+   * @tparam Callable Type of callable object (lambda or functor)
+   * @param callable Callable object to reference
+   */
+  template <typename Callable,
+            typename = std::enable_if_t<
+                !std::is_same_v<std::decay_t<Callable>, FunctionRef> &&
+                std::is_invocable_r_v<R, std::remove_reference_t<Callable>&, Args...>>>
+  FunctionRef(Callable&& callable)  // NOLINT(google-explicit-constructor)
+      : object_{const_cast<void*>(static_cast<const void*>(std::addressof(callable)))},
+        invoke_{&Invoke<std::remove_reference_t<Callable>>} {}
+
+  /**
+   * @brief Invoke callable object
+   * @param args Arguments forwarded to callable object
+   * @return R Result from callable object
+   */
+  R operator()(Args... args) const { return invoke_(object_, std::forward<Args>(args)...); }
+
+  /* ******************************************************************************************** */
+  //! Internal operations
+ private:
+  /**
+   * @brief Restore concrete type from callable object and invoke it
+   * @tparam Callable Type of callable object
+   * @param object Pointer to callable object
+   * @param args Arguments forwarded to callable object
+   * @return R Result from callable object
+   */
+  template <typename Callable>
+  static R Invoke(void* object, Args... args) {
+    return (*static_cast<Callable*>(object))(std::forward<Args>(args)...);
+  }
+
+  /* ******************************************************************************************** */
+  //! Variables
+
+  void* object_;                 //!< Callable object referenced (not owned)
+  R (*invoke_)(void*, Args...);  //!< Function generated for the type of callable object
+};
+
+}  // namespace util
+
+#endif  // INCLUDE_UTIL_FUNCTION_REF_H_
@@ -0,0 +1,107 @@
+/**
+ * \file
+ * \brief  Class for reading a local file mapped into memory
+ */
+
+#ifndef INCLUDE_UTIL_MAPPED_FILE_H_
+#define INCLUDE_UTIL_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace util {
+
+/**
+ * @brief Read-only memory mapping of a whole local file, giving stream-like access to it (read and
+ * seek operations). Reading only copies data from the mapped region and seeking only changes the
+ * internal position, so no syscall is made besides the kernel hints to prefetch the pages ahead of
+ * the current position (P.S.: file must not be truncated while mapped, otherwise reading it results
+ * in SIGBUS)
+ */
+class MappedFile {
+ protected:
+  /**
+   * @brief Construct a new MappedFile object
+   * @param data Pointer to mapped region
+   * @param size Mapped region size (same as file size)
+   */
+  MappedFile(const uint8_t* data, size_t size);
+
+ public:
+  /**
+   * @brief Map file into memory
+   * @param filepath Path to local file
+   * @return MappedFile instance, or nullptr in case that file cannot be mapped (e.g. it is not a
+   * regular file, it is empty, or mmap is not supported by its filesystem)
+   */
+  static std::unique_ptr<MappedFile> Create(const std::string& filepath);
+
+  /**
+   * @brief Destroy the MappedFile object (unmapping file from memory)
+   */
+  ~MappedFile();
+
+  //! Remove these
+  MappedFile(const MappedFile& other) = delete;             // copy constructor
+  MappedFile(MappedFile&& other) = delete;                  // move constructor
+  MappedFile& operator=(const MappedFile& other) = delete;  // copy assignment
+  MappedFile& operator=(MappedFile&& other) = delete;       // move assignment
+
+  /* ******************************************************************************************** */
+  //! Public API
+
+  /**
+   * @brief Copy content from current position and move position forward
+   * @param buffer Output buffer
+   * @param size Maximum number of bytes to read
+   * @return Number of bytes effectively read (zero when position is at the end of file)
+   */
+  size_t Read(uint8_t* buffer, size_t size);
+
+  /**
+   * @brief Change current position
+   * @param offset Offset in bytes
+   * @param whence Reference for offset: SEEK_SET, SEEK_CUR or SEEK_END
+   * @return New position, or -1 in case of invalid arguments
+   */
+  int64_t Seek(int64_t offset, int whence);
+
+  /**
+   * @brief Get file size
+   * @return Size in bytes
+   */
+  int64_t GetSize() const { return static_cast<int64_t>(size_); }
+
+  /**
+   * @brief Get current position
+   * @return Offset in bytes from the beginning of file
+   */
+  int64_t GetPosition() const { return static_cast<int64_t>(position_); }
+
+  /* ******************************************************************************************** */
+  //! Internal operations
+ private:
+  /**
+   * @brief Advise kernel to read in advance the pages right after current position
+   */
+  void Prefetch();
+
+  /* ******************************************************************************************** */
+  //! Default Constants
+
+  static constexpr size_t kPrefetchWindow = 1 << 20;  //!< Size of region to prefetch (in bytes)
+
+  /* ******************************************************************************************** */
+  //! Variables
+
+  const uint8_t* data_;  //!< Mapped region
+  size_t size_;          //!< Mapped region size
+
+  size_t position_ = 0;    //!< Current position to read
+  size_t prefetched_ = 0;  //!< End of the last region advised to be prefetched
+};
+
+}  // namespace util
+#endif  // INCLUDE_UTIL_MAPPED_FILE_H_
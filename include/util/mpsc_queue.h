@@ -0,0 +1,177 @@
+/**
+ * \file
+ * \brief  Single-header for a bounded lock-free multiple-producer/single-consumer queue
+ */
+
+#ifndef INCLUDE_UTIL_MPSC_QUEUE_H_
+#define INCLUDE_UTIL_MPSC_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace util {
+
+/**
+ * @brief Pre-allocated queue where any number of threads push elements and exactly one thread
+ * consumes them. Each slot holds a sequence number telling whether it is free or ready to read, so
+ * producers only compete on a single atomic position (with compare-and-swap) and consumer never
+ * waits for them. No locks or allocations are performed on Push/Pop (besides any allocation done
+ * by T itself when moved).
+ *
+ * @tparam T Element type (must be default constructible and movable)
+ */
+template <typename T>
+class MpscQueue {
+ public:
+  /**
+   * @brief Construct a new MpscQueue object
+   * @param capacity Maximum number of elements stored at the same time (rounded up to a power of 2)
+   */
+  explicit MpscQueue(size_t capacity) : cells_(RoundUp(capacity)), mask_(cells_.size() - 1) {
+    for (size_t i = 0; i < cells_.size(); i++) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @brief Destroy the MpscQueue object
+   */
+  ~MpscQueue() = default;
+
+  //! Remove these
+  MpscQueue(const MpscQueue& other) = delete;             // copy constructor
+  MpscQueue(MpscQueue&& other) = delete;                  // move constructor
+  MpscQueue& operator=(const MpscQueue& other) = delete;  // copy assignment
+  MpscQueue& operator=(MpscQueue&& other) = delete;       // move assignment
+
+  /* ******************************************************************************************** */
+  //! Public API
+
+  /**
+   * @brief Append element to queue (may be called by any thread)
+   * @param value Element to append
+   * @return true if element was added, false if queue is full
+   */
+  bool Push(T value) {
+    size_t position = push_pos_.load(std::memory_order_relaxed);
+    Cell* cell = nullptr;
+
+    for (;;) {
+      cell = &cells_[position & mask_];
+      size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+      if (diff == 0) {
+        // Slot is free, so try to claim it (position is reloaded on failure)
+        if (push_pos_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        // Slot still holds an element from the previous lap, which was not consumed yet
+        return false;
+      } else {
+        // Another producer claimed this slot meanwhile
+        position = push_pos_.load(std::memory_order_relaxed);
+      }
+    }
+
+    // Counter is updated before publishing element, so consumer never finds an element while
+    // queue still looks empty
+    cell->value = std::move(value);
+    size_.fetch_add(1, std::memory_order_release);
+    cell->sequence.store(position + 1, std::memory_order_release);
+
+    return true;
+  }
+
+  /**
+   * @brief Get element at the front of queue without consuming it (must be called only by
+   * consumer thread)
+   * @return Pointer to element, or nullptr if there is nothing to read
+   */
+  T* Front() {
+    Cell& cell = cells_[pop_pos_ & mask_];
+    if (cell.sequence.load(std::memory_order_acquire) != pop_pos_ + 1) return nullptr;
+
+    return &cell.value;
+  }
+
+  /**
+   * @brief Consume element at the front of queue (must be called only by consumer thread)
+   * @param value Output element
+   * @return true if an element was consumed, false if there is nothing to read
+   */
+  bool Pop(T& value) {
+    T* front = Front();
+    if (front == nullptr) return false;
+
+    value = std::move(*front);
+
+    // Slot is released for the producer that reaches it on the next lap
+    cells_[pop_pos_ & mask_].sequence.store(pop_pos_ + cells_.size(), std::memory_order_release);
+    pop_pos_++;
+    size_.fetch_sub(1, std::memory_order_release);
+
+    return true;
+  }
+
+  /**
+   * @brief Check if there is nothing to read, using a single atomic load (an element being pushed
+   * right now may already be counted, so Pop can still fail when this returns false)
+   * @return true if queue is empty, false otherwise
+   */
+  bool Empty() const { return size_.load(std::memory_order_acquire) == 0; }
+
+  /**
+   * @brief Get number of elements in queue (accurate only when no producer is pushing)
+   * @return Queue fill level
+   */
+  size_t Size() const { return size_.load(std::memory_order_acquire); }
+
+  /**
+   * @brief Get maximum number of elements that fit in queue
+   * @return Queue capacity
+   */
+  size_t Capacity() const { return cells_.size(); }
+
+  /* ******************************************************************************************** */
+  //! Internal operations
+ private:
+  /**
+   * @brief Round capacity up to a power of 2, so slot index is obtained with a mask
+   * @param capacity Requested capacity
+   * @return Capacity effectively allocated
+   */
+  static size_t RoundUp(size_t capacity) {
+    size_t result = 2;
+    while (result < capacity) result <<= 1;
+    return result;
+  }
+
+  /* ******************************************************************************************** */
+  //! Variables
+
+  static constexpr size_t kCacheLineSize = 64;  //!< Avoid false sharing between positions
+
+  /**
+   * @brief Slot from queue, where sequence equal to position means free to write, and position + 1
+   * means ready to read
+   */
+  struct Cell {
+    std::atomic<size_t> sequence = 0;  //!< Lap in which this slot is expected to be used
+    T value{};                         //!< Element stored
+  };
+
+  std::vector<Cell> cells_;  //!< Pre-allocated slots
+  const size_t mask_;        //!< Mask to get slot index from position
+
+  alignas(kCacheLineSize) std::atomic<size_t> push_pos_ = 0;  //!< Shared by all producers
+  alignas(kCacheLineSize) size_t pop_pos_ = 0;                //!< Owned by consumer
+  alignas(kCacheLineSize) std::atomic<size_t> size_ = 0;      //!< Number of elements in queue
+};
+
+}  // namespace util
+
+#endif  // INCLUDE_UTIL_MPSC_QUEUE_H_
@@ -0,0 +1,46 @@
+/**
+ * \file
+ * \brief  Helpers to run threads from audio path with real-time scheduling
+ */
+
+#ifndef INCLUDE_UTIL_REALTIME_H_
+#define INCLUDE_UTIL_REALTIME_H_
+
+#include <cstddef>
+
+namespace util {
+
+/**
+ * @brief Scheduling policy for thread writing samples into playback stream
+ */
+enum class RealtimePolicy {
+  None = 0,        //!< Normal scheduling (real-time mode disabled)
+  Fifo = 1,        //!< SCHED_FIFO: thread runs until it blocks, preempting any non real-time thread
+  RoundRobin = 2,  //!< SCHED_RR: same as FIFO, but sharing CPU with threads of same priority
+};
+
+/**
+ * @brief Change scheduling from calling thread to real-time (this usually requires CAP_SYS_NICE or
+ * a RLIMIT_RTPRIO from PAM limits, so it is expected to fail for most users)
+ * @param policy Real-time policy
+ * @param priority Real-time priority (clamped to the range supported by policy)
+ * @return true if thread is running with real-time scheduling, false if it keeps normal scheduling
+ */
+bool SetRealtimeScheduling(RealtimePolicy policy, int priority);
+
+/**
+ * @brief Lock all pages from process into memory, including the ones mapped in the future, so
+ * audio path never waits for a page to be brought back from swap
+ * @return true if memory is locked, false otherwise (e.g. missing permission or RLIMIT_MEMLOCK)
+ */
+bool LockMemory();
+
+/**
+ * @brief Touch pages from stack of calling thread in advance, so they are already mapped (and
+ * locked, after LockMemory) before thread starts handling audio
+ * @param size Stack size to touch (in bytes)
+ */
+void PrefaultStack(size_t size = 256 * 1024);
+
+}  // namespace util
+#endif  // INCLUDE_UTIL_REALTIME_H_
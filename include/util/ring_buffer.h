@@ -0,0 +1,161 @@
+/**
+ * \file
+ * \brief  Single-header for a lock-free single-producer/single-consumer ring buffer
+ */
+
+#ifndef INCLUDE_UTIL_RING_BUFFER_H_
+#define INCLUDE_UTIL_RING_BUFFER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace util {
+
+/**
+ * @brief Pre-allocated circular buffer shared between exactly one producer thread and exactly one
+ * consumer thread. No locks or allocations are performed on Write/Read, only atomic loads/stores on
+ * monotonic positions (index in the internal storage is obtained by position modulo capacity).
+ *
+ * @tparam T Element type (must be trivially copyable)
+ */
+template <typename T>
+class RingBuffer {
+ public:
+  /**
+   * @brief Construct a new RingBuffer object
+   * @param capacity Maximum number of elements stored at the same time
+   */
+  explicit RingBuffer(size_t capacity = 0) { Resize(capacity); }
+
+  /**
+   * @brief Destroy the RingBuffer object
+   */
+  ~RingBuffer() = default;
+
+  //! Remove these
+  RingBuffer(const RingBuffer& other) = delete;             // copy constructor
+  RingBuffer(RingBuffer&& other) = delete;                  // move constructor
+  RingBuffer& operator=(const RingBuffer& other) = delete;  // copy assignment
+  RingBuffer& operator=(RingBuffer&& other) = delete;       // move assignment
+
+  /* ******************************************************************************************** */
+  //! Public API
+
+  /**
+   * @brief Reallocate internal storage and discard any content (P.S.: this is NOT thread-safe, so
+   * it must be called before producer and consumer start to use it)
+   * @param capacity Maximum number of elements stored at the same time
+   */
+  void Resize(size_t capacity) {
+    storage_.assign(capacity, T{});
+    write_pos_ = 0;
+    read_pos_ = 0;
+    flush_pos_ = kNoFlush;
+  }
+
+  /**
+   * @brief Append elements to buffer (must be called only by producer thread)
+   * @param data Elements to append
+   * @param count Number of elements
+   * @return Number of elements effectively written (may be less than count if buffer is full)
+   */
+  size_t Write(const T* data, size_t count) {
+    const size_t write = write_pos_.load(std::memory_order_relaxed);
+    const size_t read = read_pos_.load(std::memory_order_acquire);
+
+    const size_t available = storage_.size() - (write - read);
+    const size_t length = std::min(count, available);
+    if (length == 0) return 0;
+
+    // Copy data considering that it may wrap around the end of storage
+    const size_t index = write % storage_.size();
+    const size_t first_part = std::min(length, storage_.size() - index);
+
+    std::copy(data, data + first_part, storage_.begin() + index);
+    std::copy(data + first_part, data + length, storage_.begin());
+
+    write_pos_.store(write + length, std::memory_order_release);
+    return length;
+  }
+
+  /**
+   * @brief Consume elements from buffer (must be called only by consumer thread)
+   * @param data Output array
+   * @param count Maximum number of elements to read
+   * @return Number of elements effectively read (may be less than count if buffer is almost empty)
+   */
+  size_t Read(T* data, size_t count) {
+    size_t read = read_pos_.load(std::memory_order_relaxed);
+
+    // Discard everything written before the flush request
+    if (size_t flush = flush_pos_.exchange(kNoFlush, std::memory_order_acq_rel);
+        flush != kNoFlush && flush > read) {
+      read = flush;
+    }
+
+    const size_t write = write_pos_.load(std::memory_order_acquire);
+    const size_t length = std::min(count, write - read);
+
+    if (length > 0) {
+      // Copy data considering that it may wrap around the end of storage
+      const size_t index = read % storage_.size();
+      const size_t first_part = std::min(length, storage_.size() - index);
+
+      std::copy(storage_.begin() + index, storage_.begin() + index + first_part, data);
+      std::copy(storage_.begin(), storage_.begin() + (length - first_part), data + first_part);
+    }
+
+    read_pos_.store(read + length, std::memory_order_release);
+    return length;
+  }
+
+  /**
+   * @brief Ask consumer to discard all elements written until now (must be called only by producer
+   * thread). It is effectively applied on the next Read, so producer can keep writing new content.
+   */
+  void RequestFlush() {
+    flush_pos_.store(write_pos_.load(std::memory_order_relaxed), std::memory_order_release);
+  }
+
+  /**
+   * @brief Get number of elements available to read (as it is shared by two threads, it is only
+   * accurate when called by one of them)
+   * @return Buffer fill level
+   */
+  size_t Size() const {
+    const size_t read = read_pos_.load(std::memory_order_acquire);
+    const size_t write = write_pos_.load(std::memory_order_acquire);
+    return write - read;
+  }
+
+  /**
+   * @brief Get maximum number of elements that fit in buffer
+   * @return Buffer capacity
+   */
+  size_t Capacity() const { return storage_.size(); }
+
+  /**
+   * @brief Check if buffer is allocated
+   * @return true if buffer has some capacity, false otherwise
+   */
+  bool IsEnabled() const { return !storage_.empty(); }
+
+  /* ******************************************************************************************** */
+  //! Variables
+ private:
+  static constexpr size_t kNoFlush = std::numeric_limits<size_t>::max();  //!< No flush requested
+  static constexpr size_t kCacheLineSize = 64;  //!< Avoid false sharing between positions
+
+  std::vector<T> storage_;  //!< Pre-allocated storage
+
+  alignas(kCacheLineSize) std::atomic<size_t> write_pos_ = 0;  //!< Written by producer only
+  alignas(kCacheLineSize) std::atomic<size_t> read_pos_ = 0;   //!< Written by consumer only
+  alignas(kCacheLineSize) std::atomic<size_t> flush_pos_ = kNoFlush;  //!< Position to discard
+};
+
+}  // namespace util
+
+#endif  // INCLUDE_UTIL_RING_BUFFER_H_
@@ -0,0 +1,213 @@
+/**
+ * \file
+ * \brief  Class for tracing how long each stage from audio pipeline takes
+ */
+
+#ifndef INCLUDE_UTIL_TRACER_H_
+#define INCLUDE_UTIL_TRACER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace util {
+
+/**
+ * @brief Responsible for recording trace events (thread-safe) and writing them in Chrome Trace
+ * Event format, so they can be loaded in Perfetto (or chrome://tracing). Trace points are always
+ * compiled, but while tracing is disabled they cost a single atomic load. Once enabled, each thread
+ * writes its events into its own ring buffer (allocated on its first event), so recording an event
+ * never takes a lock, and only the most recent events from each thread are kept.
+ */
+class Tracer {
+ protected:
+  /**
+   * @brief Construct a new Tracer object
+   */
+  Tracer() = default;
+
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief Destroy the Tracer object
+   */
+  ~Tracer() = default;
+
+  //! Remove these
+  Tracer(const Tracer& other) = delete;             // copy constructor
+  Tracer(Tracer&& other) = delete;                  // move constructor
+  Tracer& operator=(const Tracer& other) = delete;  // copy assignment
+  Tracer& operator=(Tracer&& other) = delete;       // move assignment
+
+  /* ******************************************************************************************** */
+  //! Public API
+  /**
+   * @brief Get unique instance of Tracer
+   * @return Tracer instance
+   */
+  static Tracer& GetInstance() {
+    // Same as done by Logger, to keep the default constructor hidden
+    struct MakeUniqueEnabler : public Tracer {
+      using Tracer::Tracer;
+    };
+    static std::unique_ptr<Tracer> singleton = std::make_unique<MakeUniqueEnabler>();
+    return *singleton;
+  }
+
+  /**
+   * @brief Enable tracing, so events are written to the given path when Dump is called
+   * @param path Trace filepath
+   */
+  void Configure(const std::string& path);
+
+  /**
+   * @brief Stop recording events (the ones already recorded are kept)
+   */
+  void Disable() { enabled_.store(false, std::memory_order_relaxed); }
+
+  /**
+   * @brief Check if events are being recorded
+   * @return true if tracing is enabled, false otherwise
+   */
+  bool IsEnabled() const { return enabled_.load(std::memory_order_acquire); }
+
+  /**
+   * @brief Record event with the time spent on some stage (must be called only while enabled)
+   * @param name Stage name (must be a string literal, as only its pointer is kept)
+   * @param begin When stage started
+   * @param end When stage finished
+   */
+  void Record(const char* name, Clock::time_point begin, Clock::time_point end);
+
+  /**
+   * @brief Write every event recorded so far in Chrome Trace Event format (JSON)
+   * @param out Output stream
+   */
+  void Write(std::ostream& out) const;
+
+  /**
+   * @brief Write every event recorded so far into trace file (if tracing was configured). Only
+   * valid once every thread recording events has stopped (e.g. after destroying Player, which
+   * joins its threads), as a running thread would overwrite events while they are written
+   * @return true if file was written, false otherwise
+   */
+  bool Dump() const;
+
+  /**
+   * @brief Invoke function while measuring how long it takes (e.g. a call to an external library,
+   * inside a loop condition)
+   * @tparam Function Callable type
+   * @param name Stage name (must be a string literal)
+   * @param function Callable to invoke
+   * @return Result from function
+   */
+  template <typename Function>
+  static auto Call(const char* name, Function&& function) {
+    Tracer& tracer = GetInstance();
+    if (!tracer.IsEnabled()) return std::forward<Function>(function)();
+
+    Clock::time_point begin = Clock::now();
+    auto result = std::forward<Function>(function)();
+    tracer.Record(name, begin, Clock::now());
+
+    return result;
+  }
+
+  /* ******************************************************************************************** */
+  //! Utility
+ private:
+  static constexpr size_t kEventsPerThread = 16384;  //!< Ring buffer size (must be power of 2)
+
+  /**
+   * @brief Time spent on some stage (timestamps relative to when tracing was configured)
+   */
+  struct Event {
+    const char* name = nullptr;  //!< Stage name
+    int64_t begin = 0;           //!< When stage started (in nanoseconds)
+    int64_t duration = 0;        //!< Time spent on stage (in nanoseconds)
+  };
+
+  /**
+   * @brief Events recorded by a single thread (written only by that thread)
+   */
+  struct ThreadBuffer {
+    explicit ThreadBuffer(int tid) : id{tid}, events(kEventsPerThread) {}
+
+    int id;                         //!< Sequential identifier for thread
+    std::vector<Event> events;      //!< Ring buffer with the most recent events
+    std::atomic<size_t> count = 0;  //!< Total number of events recorded
+  };
+
+  /**
+   * @brief Create ring buffer for the calling thread
+   * @return Ring buffer (owned by tracer, so it outlives the thread)
+   */
+  ThreadBuffer* Register();
+
+  /* ******************************************************************************************** */
+  //! Variables
+  std::atomic<bool> enabled_ = false;  //!< Record events
+  Clock::time_point epoch_;            //!< When tracing was configured
+  std::string path_;                   //!< Trace filepath
+
+  mutable std::mutex mutex_;                            //!< Control access to ring buffers list
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_;  //!< Ring buffers from every thread
+};
+
+/* ********************************************************************************************** */
+
+/**
+ * @brief Record time spent from its construction until its destruction
+ */
+class TraceScope {
+ public:
+  /**
+   * @brief Construct a new TraceScope object
+   * @param name Stage name (must be a string literal)
+   */
+  explicit TraceScope(const char* name)
+      : name_{Tracer::GetInstance().IsEnabled() ? name : nullptr},
+        begin_{name_ ? Tracer::Clock::now() : Tracer::Clock::time_point{}} {}
+
+  /**
+   * @brief Destroy the TraceScope object
+   */
+  ~TraceScope() {
+    if (name_) Tracer::GetInstance().Record(name_, begin_, Tracer::Clock::now());
+  }
+
+  //! Remove these
+  TraceScope(const TraceScope& other) = delete;             // copy constructor
+  TraceScope(TraceScope&& other) = delete;                  // move constructor
+  TraceScope& operator=(const TraceScope& other) = delete;  // copy assignment
+  TraceScope& operator=(TraceScope&& other) = delete;       // move assignment
+
+ private:
+  const char* name_;                 //!< Stage name (null while tracing is disabled)
+  Tracer::Clock::time_point begin_;  //!< When stage started
+};
+
+}  // namespace util
+
+/* ---------------------------------------------------------------------------------------------- */
+/*                                           PUBLIC API                                           */
+/* ---------------------------------------------------------------------------------------------- */
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+//! Macro to trace time spent until the end of the current scope
+#define TRACE_SCOPE(name) util::TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+
+//! Macro to trace time spent on a single call, keeping its result
+#define TRACE_CALL(name, ...) util::Tracer::Call(name, [&] { return __VA_ARGS__; })
+
+#endif  // INCLUDE_UTIL_TRACER_H_
@@ -48,6 +48,7 @@ struct CustomEvent {
     SeekForwardPosition = 60006,
     SeekBackwardPosition = 60007,
     ApplyAudioFilters = 60008,
+    NotifyNextFileSelection = 60009,
     // Events from interface to interface
     Refresh = 70000,
     ChangeBarAnimation = 70001,
@@ -85,6 +86,7 @@ struct CustomEvent {
   static CustomEvent SeekForwardPosition(int offset);
   static CustomEvent SeekBackwardPosition(int offset);
   static CustomEvent ApplyAudioFilters(const model::EqualizerPreset& filters);
+  static CustomEvent NotifyNextFileSelection(const std::filesystem::path& file_path);
 
   //! Possible events (from interface to interface)
   static CustomEvent Refresh();
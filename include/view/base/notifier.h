@@ -8,6 +8,7 @@
 
 #include "model/application_error.h"
 #include "model/song.h"
+#include "model/volume.h"
 
 namespace interface {
 
@@ -49,10 +50,30 @@ class Notifier {
 
   /**
    * @brief Send raw audio samples to UI
-   * @param buffer Audio samples
-   * @param size Sample count
+   * @param buffer Audio samples (interleaved float)
+   * @param size Sample count (considering all channels)
    */
-  virtual void SendAudioRaw(int* buffer, int size) = 0;
+  virtual void SendAudioRaw(float* buffer, int size) = 0;
+
+  /**
+   * @brief Notify UI about period size from playback stream (i.e. number of frames in each chunk
+   * of raw audio samples sent to UI)
+   * @param size Period size (in frames)
+   */
+  virtual void NotifyPeriodSize(int size) = 0;
+
+  /**
+   * @brief Notify UI about sample rate from playback stream (i.e. rate from raw audio samples sent
+   * to UI, which changes when a song is played using its own sample rate)
+   * @param sample_rate Number of frames per second
+   */
+  virtual void NotifySampleRate(int sample_rate) = 0;
+
+  /**
+   * @brief Notify UI with volume changed outside of this application
+   * @param value New volume
+   */
+  virtual void NotifyVolume(model::Volume value) = 0;
 
   /**
    * @brief Notify UI with error code from some background operation
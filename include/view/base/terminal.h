@@ -16,6 +16,7 @@
 #include "middleware/media_controller.h"
 #include "model/application_error.h"
 #include "model/block_identifier.h"
+#include "model/playback_clock.h"
 #include "view/base/block.h"
 #include "view/base/custom_event.h"
 #include "view/base/event_dispatcher.h"
@@ -86,6 +87,13 @@ class Terminal : public EventDispatcher, public ftxui::ComponentBase {
    */
   void RegisterPlayerNotifier(const std::shared_ptr<audio::Notifier>& notifier);
 
+  /**
+   * @brief Register clock with audible position from player, read by media player block on every
+   * render (so song progress moves smoothly between notifications)
+   * @param clock Playback clock
+   */
+  void RegisterPlaybackClock(const std::shared_ptr<const model::PlaybackClock>& clock);
+
   /**
    * @brief Bind an external send event function to an internal function
    * @param cb Callback function to send custom events to terminal user interface
@@ -10,6 +10,7 @@
 
 #include "ftxui/component/captured_mouse.hpp"  // for ftxui
 #include "ftxui/dom/elements.hpp"              // for Element
+#include "model/playback_clock.h"              // for PlaybackClock
 #include "model/song.h"                        // for Song
 #include "model/volume.h"
 #include "view/base/block.h"  // for Block, BlockEvent (ptr...
@@ -21,7 +22,8 @@ namespace interface {
  * @brief Component with detailed information about the chosen file (in this case, some music file)
  */
 class MediaPlayer : public Block {
-  static constexpr int kMaxRows = 10;  //!< Maximum rows for the Component
+  static constexpr int kMaxRows = 10;        //!< Maximum rows for the Component
+  static constexpr int kSeekOffset = 1000;  //!< Offset (in milliseconds) to seek using keyboard
 
  public:
   /**
@@ -57,6 +59,15 @@ class MediaPlayer : public Block {
    */
   bool OnCustomEvent(const CustomEvent& event) override;
 
+  /**
+   * @brief Set clock with audible position from player, so song progress is interpolated on every
+   * render, instead of moving only when a new song state is received
+   * @param clock Playback clock
+   */
+  void SetPlaybackClock(const std::shared_ptr<const model::PlaybackClock>& clock) {
+    clock_ = clock;
+  }
+
   /* ******************************************************************************************** */
  private:
   //! Handle mouse event
@@ -68,6 +79,9 @@ class MediaPlayer : public Block {
            song_.curr_info.state == model::Song::MediaState::Pause;
   }
 
+  //! Get current position (in milliseconds), preferring the one from playback clock
+  int64_t GetPosition() const;
+
   /* ******************************************************************************************** */
   //! Variables
   MediaButton btn_play_;              //!< Media player button for Play/Pause
@@ -75,6 +89,8 @@ class MediaPlayer : public Block {
   model::Song song_ = model::Song{};  //!< Audio information from current song
   model::Volume volume_;              //!< General sound volume
 
+  std::shared_ptr<const model::PlaybackClock> clock_;  //!< Audible position from player (optional)
+
   ftxui::Box duration_box_;  //!< Box for duration component (gauge)
 };
 
@@ -32,6 +32,9 @@ std::ostream& operator<<(std::ostream& out, const Command::Identifier& i) {
     case Command::Identifier::Exit:
       out << " Exit ";
       break;
+    case Command::Identifier::SetLatencyProfile:
+      out << " SetLatencyProfile ";
+      break;
   }
 
   return out;
@@ -122,6 +125,16 @@ Command Command::UpdateAudioFilters(const model::EqualizerPreset& filters) {
 
 /* ********************************************************************************************** */
 
+// Static
+Command Command::SetLatencyProfile(driver::LatencyProfile profile) {
+  return Command{
+      .id = Identifier::SetLatencyProfile,
+      .content = profile,
+  };
+}
+
+/* ********************************************************************************************** */
+
 // Static
 Command Command::Exit() {
   return Command{
@@ -2,12 +2,22 @@
 
 #include <alsa/mixer.h>
 #include <math.h>
+#include <poll.h>
+#include <unistd.h>
 
+#include <algorithm>
 #include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <thread>
 #include <vector>
 
 #include "model/application_error.h"
 #include "util/logger.h"
+#include "util/tracer.h"
 
 namespace driver {
 
@@ -63,34 +73,124 @@ std::vector<std::string> GetPreferedDevicesName() {
   return devices_names;
 }
 
+// Get file remembering the last device where playback stream was created (empty when there is no
+// cache directory for this user).
+std::filesystem::path GetDeviceCachePath() {
+  if (const char *cache = std::getenv("XDG_CACHE_HOME"); cache && *cache)
+    return std::filesystem::path(cache) / "spectrum" / "alsa_device";
+
+  if (const char *home = std::getenv("HOME"); home && *home)
+    return std::filesystem::path(home) / ".cache" / "spectrum" / "alsa_device";
+
+  return std::filesystem::path{};
+}
+
+// Read device name from cache file (empty when not cached yet).
+std::string ReadCachedDevice(const std::filesystem::path &path) {
+  std::string device;
+  if (path.empty()) return device;
+
+  std::ifstream file(path);
+  std::getline(file, device);
+  return device;
+}
+
+// Write device name into cache file, so it is opened first on next startup.
+void WriteCachedDevice(const std::filesystem::path &path, const std::string &device) {
+  if (path.empty()) return;
+
+  std::error_code error;
+  std::filesystem::create_directories(path.parent_path(), error);
+
+  if (std::ofstream file(path, std::ios::trunc); !(file << device << '\n')) {
+    LOG("Cannot write audio device into cache file=", path);
+  }
+}
+
+// Get time elapsed since the given moment (in milliseconds).
+int64_t GetElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+                                                               start)
+      .count();
+}
+
 }  // namespace
 
+Alsa::~Alsa() {
+  if (mixer_watcher_.joinable()) {
+    char stop = 0;
+    if (write(wakeup_[1], &stop, sizeof(stop)) < 0) ERROR("Cannot wake up mixer watcher");
+    mixer_watcher_.join();
+  }
+
+  for (int fd : wakeup_) {
+    if (fd >= 0) close(fd);
+  }
+}
+
+/* ********************************************************************************************** */
+
 error::Code Alsa::CreatePlaybackStream() {
   LOG("Create new playback stream");
-
-  std::vector<std::string> devices_name = GetPreferedDevicesName();
+  auto start = std::chrono::steady_clock::now();
 
   // Create playback stream on ALSA
   snd_pcm_t *pcm_handle = nullptr;
-
   std::string device_name;
-  for (auto &device : devices_name) {
-    LOG("Creating playback stream on device: ", device);
-    if (snd_pcm_open(&pcm_handle, device.c_str(), SND_PCM_STREAM_PLAYBACK, 0) < 0) {
-      LOG("Cannot open playback stream on device: ", device);
-      continue;
+
+  // Device requested by user is the only one tried, so it is never replaced by another one
+  if (!device_.empty()) {
+    LOG("Creating playback stream on requested device: ", device_);
+
+    if (snd_pcm_open(&pcm_handle, device_.c_str(), SND_PCM_STREAM_PLAYBACK, 0) < 0) {
+      ERROR("Cannot open playback stream on requested device: ", device_);
+      return error::kUnknownError;
     }
-    LOG("Created playback stream on device: ", device);
 
-    device_name = device;
-    break;
+    device_name = device_;
+  }
+
+  // Otherwise, device that worked last time is tried first, as listing every device may take a
+  // while (e.g. on machines with many cards or a slow bridge to a sound server)
+  std::filesystem::path cache_path = GetDeviceCachePath();
+
+  if (std::string cached = device_name.empty() ? ReadCachedDevice(cache_path) : std::string{};
+      !cached.empty()) {
+    LOG("Creating playback stream on cached device: ", cached);
+
+    if (snd_pcm_open(&pcm_handle, cached.c_str(), SND_PCM_STREAM_PLAYBACK, 0) == 0) {
+      device_name = cached;
+    } else {
+      LOG("Cannot open playback stream on cached device, listing all devices");
+    }
   }
 
   if (device_name.empty()) {
-    ERROR("Cannot open playback stream on any device!");
-    return error::kUnknownError;
+    std::vector<std::string> devices_name = GetPreferedDevicesName();
+    LOG("Listed audio devices in ", GetElapsedMs(start), "ms, found ", devices_name.size());
+
+    for (auto &device : devices_name) {
+      LOG("Creating playback stream on device: ", device);
+      if (snd_pcm_open(&pcm_handle, device.c_str(), SND_PCM_STREAM_PLAYBACK, 0) < 0) {
+        LOG("Cannot open playback stream on device: ", device);
+        continue;
+      }
+      LOG("Created playback stream on device: ", device);
+
+      device_name = device;
+      break;
+    }
+
+    if (device_name.empty()) {
+      ERROR("Cannot open playback stream on any device!");
+      return error::kUnknownError;
+    }
+
+    WriteCachedDevice(cache_path, device_name);
   }
 
+  LOG("Opened playback stream on device=", device_name, " in ", GetElapsedMs(start), "ms");
+
   playback_handle_.reset(std::move(pcm_handle));
 
   // Create mixer to control volume on ALSA
@@ -107,27 +207,189 @@ error::Code Alsa::CreatePlaybackStream() {
 
   mixer_.reset(std::move(mixer_handle));
 
+  // Master playback lives as long as mixer, so there is no need to look for it on every access
+  master_ = GetMasterPlayback();
+  if (master_ == nullptr) {
+    ERROR("Cannot get master playback, volume changes from other mixers are not tracked");
+    return error::kSuccess;
+  }
+
+  volume_ = ReadVolume();
+
+  if (pipe(wakeup_) < 0) {
+    ERROR("Cannot create pipe to wake up mixer watcher");
+    return error::kSuccess;
+  }
+
+  mixer_watcher_ = std::thread(&Alsa::WatchMixer, this);
+
   return error::kSuccess;
 }
 
 /* ********************************************************************************************** */
 
 error::Code Alsa::ConfigureParameters() {
-  LOG("Configure parameters on playback stream");
+  LOG("Configure parameters on playback stream with format=", format_,
+      " access=", static_cast<int>(access_), " profile=", static_cast<int>(profile_));
+
+  // Not every device (or plugin) is able to map its buffer into memory
+  if (access_ == PlaybackAccess::Mmap &&
+      SetHardwareParameters(SND_PCM_ACCESS_MMAP_INTERLEAVED) < 0) {
+    LOG("Playback stream does not support mmap access, using read/write access instead");
+    access_ = PlaybackAccess::ReadWrite;
+  }
 
-  // with latency as 92900us, we get a period size equal to 1024
-  if (snd_pcm_set_params(playback_handle_.get(), kSampleFormat, SND_PCM_ACCESS_RW_INTERLEAVED,
-                         kChannels, kSampleRate, 0, 92900) < 0) {
-    ERROR("Cannot set parameters on playback stream");
+  if (access_ == PlaybackAccess::ReadWrite &&
+      SetHardwareParameters(SND_PCM_ACCESS_RW_INTERLEAVED) < 0) {
+    ERROR("Cannot set hardware parameters on playback stream");
     return error::kUnknownError;
   }
 
-  snd_pcm_uframes_t buffer_size = 0;
-  if (snd_pcm_get_params(playback_handle_.get(), &buffer_size, &period_size_) < 0) {
-    ERROR("Cannot get parameters from playback stream");
+  if (SetSoftwareParameters() < 0) {
+    ERROR("Cannot set software parameters on playback stream");
     return error::kUnknownError;
   }
 
+  // Latest samples written are kept, so neither pause nor stop lose track of what is queued
+  history_.assign(buffer_size_ * format_.channels, 0.f);
+  history_end_ = history_size_ = 0;
+  pause_ = PauseMethod::None;
+
+  LOG("Playback stream granted buffer_size=", buffer_size_, " period_size=", period_size_,
+      " can_pause=", can_pause_);
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+int Alsa::SetHardwareParameters(snd_pcm_access_t access) {
+  snd_pcm_t *pcm = playback_handle_.get();
+
+  snd_pcm_hw_params_t *params = nullptr;
+  snd_pcm_hw_params_alloca(&params);
+
+  LatencyTarget target = GetLatencyTarget(profile_);
+  unsigned int buffer_time = target.buffer_time;
+  unsigned int period_time = target.buffer_time / target.periods;
+
+  // Resampling is never done by ALSA, as decoder already outputs samples in the negotiated rate.
+  // Buffer time must be set before period time, otherwise device may refuse the number of periods
+  int result = 0;
+  if ((result = snd_pcm_hw_params_any(pcm, params)) < 0 ||
+      (result = snd_pcm_hw_params_set_rate_resample(pcm, params, 0)) < 0 ||
+      (result = snd_pcm_hw_params_set_access(pcm, params, access)) < 0 ||
+      (result = snd_pcm_hw_params_set_format(pcm, params, ToPcmFormat(format_))) < 0 ||
+      (result = snd_pcm_hw_params_set_channels(pcm, params, format_.channels)) < 0 ||
+      (result = snd_pcm_hw_params_set_rate(pcm, params, format_.sample_rate, 0)) < 0 ||
+      (result = snd_pcm_hw_params_set_buffer_time_near(pcm, params, &buffer_time, nullptr)) < 0 ||
+      (result = snd_pcm_hw_params_set_period_time_near(pcm, params, &period_time, nullptr)) < 0 ||
+      (result = snd_pcm_hw_params(pcm, params)) < 0) {
+    return result;
+  }
+
+  // Device may grant sizes quite different from the requested ones (e.g. due to hardware limits)
+  if ((result = snd_pcm_hw_params_get_buffer_size(params, &buffer_size_)) < 0 ||
+      (result = snd_pcm_hw_params_get_period_size(params, &period_size_, nullptr)) < 0) {
+    return result;
+  }
+
+  can_pause_ = snd_pcm_hw_params_can_pause(params) == 1;
+  return 0;
+}
+
+/* ********************************************************************************************** */
+
+int Alsa::SetSoftwareParameters() {
+  snd_pcm_t *pcm = playback_handle_.get();
+
+  snd_pcm_sw_params_t *params = nullptr;
+  snd_pcm_sw_params_alloca(&params);
+
+  // Stream starts once device buffer is filled with whole periods, and writer is only woken up when
+  // a whole period is free (so in power-save profile, CPU sleeps for most of the time)
+  start_threshold_ = buffer_size_ / period_size_ * period_size_;
+
+  int result = 0;
+  if ((result = snd_pcm_sw_params_current(pcm, params)) < 0 ||
+      (result = snd_pcm_sw_params_set_start_threshold(pcm, params, start_threshold_)) < 0 ||
+      (result = snd_pcm_sw_params_set_avail_min(pcm, params, period_size_)) < 0 ||
+      (result = snd_pcm_sw_params(pcm, params)) < 0) {
+    return result;
+  }
+
+  return 0;
+}
+
+/* ********************************************************************************************** */
+
+bool Alsa::IsFormatSupported(const model::AudioFormat &format) {
+  snd_pcm_t *pcm = playback_handle_.get();
+  snd_pcm_format_t pcm_format = ToPcmFormat(format);
+
+  if (pcm_format == SND_PCM_FORMAT_UNKNOWN) return false;
+
+  // Start from the whole configuration space supported by device, and test each parameter
+  snd_pcm_hw_params_t *params = nullptr;
+  snd_pcm_hw_params_alloca(&params);
+
+  if (snd_pcm_hw_params_any(pcm, params) < 0) {
+    ERROR("Cannot get hardware parameters from playback stream");
+    return false;
+  }
+
+  bool supported = snd_pcm_hw_params_test_format(pcm, params, pcm_format) == 0 &&
+                   snd_pcm_hw_params_test_channels(pcm, params, format.channels) == 0 &&
+                   snd_pcm_hw_params_test_rate(pcm, params, format.sample_rate, 0) == 0;
+
+  LOG("Check if playback stream supports format=", format, " result=", supported);
+  return supported;
+}
+
+/* ********************************************************************************************** */
+
+error::Code Alsa::SetFormat(const model::AudioFormat &format) {
+  if (format == format_) return error::kSuccess;
+
+  LOG("Change format on playback stream from ", format_, " to ", format);
+
+  // Play remaining samples with the old format, as parameters cannot change while running
+  PlayRemaining();
+
+  model::AudioFormat previous = format_;
+  format_ = format;
+
+  if (error::Code result = ConfigureParameters(); result != error::kSuccess) {
+    format_ = previous;
+    return result;
+  }
+
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+error::Code Alsa::SetLatencyProfile(LatencyProfile profile) {
+  if (profile == profile_) return error::kSuccess;
+
+  LOG("Change latency profile on playback stream from ", static_cast<int>(profile_), " to ",
+      static_cast<int>(profile));
+
+  // Parameters cannot change while running, but waiting for remaining samples would block caller
+  // (which may be UI thread) for up to the whole device buffer, so they are faded out instead
+  snd_pcm_t *pcm = playback_handle_.get();
+  if (pause_ == PauseMethod::None && snd_pcm_state(pcm) == SND_PCM_STATE_RUNNING) FadeOut();
+  snd_pcm_drop(pcm);
+  last_write_size_ = 0;
+  output_delay_ = 0;
+
+  LatencyProfile previous = profile_;
+  profile_ = profile;
+
+  if (error::Code result = ConfigureParameters(); result != error::kSuccess) {
+    profile_ = previous;
+    return result;
+  }
+
   return error::kSuccess;
 }
 
@@ -135,6 +397,8 @@ error::Code Alsa::ConfigureParameters() {
 
 error::Code Alsa::Prepare() {
   LOG("Prepare playback stream to play audio");
+  last_write_size_ = 0;
+  output_delay_ = 0;
 
   if (snd_pcm_prepare(playback_handle_.get()) < 0) {
     ERROR("Cannot prepare playback stream");
@@ -148,22 +412,93 @@ error::Code Alsa::Prepare() {
 
 error::Code Alsa::Pause() {
   LOG("Pause playback stream");
+  snd_pcm_t *pcm = playback_handle_.get();
+  snd_pcm_state_t state = snd_pcm_state(pcm);
+  last_write_size_ = 0;
+
+  // Stream did not start yet, so samples written just wait in device buffer until resume
+  if (state == SND_PCM_STATE_PREPARED) {
+    pause_ = PauseMethod::NotStarted;
+    return error::kSuccess;
+  }
 
-  if (snd_pcm_drop(playback_handle_.get()) < 0) {
+  // Device keeps its buffer untouched while paused, so resume is instant
+  if (can_pause_ && state == SND_PCM_STATE_RUNNING && snd_pcm_pause(pcm, 1) == 0) {
+    pause_ = PauseMethod::Hardware;
+    return error::kSuccess;
+  }
+
+  // Otherwise, stream must be stopped, so keep samples not played yet to write them again later
+  SaveUnplayed();
+
+  if (snd_pcm_drop(pcm) < 0) {
     ERROR("Cannot pause playback stream and clear remaining frames on buffer");
+    requeue_.clear();
     return error::kUnknownError;
   }
 
+  pause_ = PauseMethod::Requeue;
   return error::kSuccess;
 }
 
 /* ********************************************************************************************** */
 
+error::Code Alsa::Resume() {
+  LOG("Resume playback stream with pause method=", static_cast<int>(pause_));
+  snd_pcm_t *pcm = playback_handle_.get();
+
+  PauseMethod method = pause_;
+  pause_ = PauseMethod::None;
+
+  switch (method) {
+    case PauseMethod::NotStarted:
+      return error::kSuccess;
+
+    case PauseMethod::Hardware:
+      if (snd_pcm_pause(pcm, 0) == 0) return error::kSuccess;
+
+      // Samples kept by device are lost, but at least playback goes on
+      ERROR("Cannot release hardware pause on playback stream");
+      return Prepare();
+
+    case PauseMethod::Requeue: {
+      error::Code result = Prepare();
+
+      if (result == error::kSuccess && !requeue_.empty()) {
+        AudioCallback(requeue_.data(), static_cast<int>(requeue_.size() / format_.channels));
+
+        // Samples kept are usually less than start threshold, and they must be heard right away
+        StartIfReady(1);
+      }
+
+      requeue_.clear();
+      return result;
+    }
+
+    case PauseMethod::None:
+    default:
+      return Prepare();
+  }
+}
+
+/* ********************************************************************************************** */
+
 error::Code Alsa::Stop() {
   LOG("Stop playback stream");
+  snd_pcm_t *pcm = playback_handle_.get();
+  last_write_size_ = 0;
+
+  // Draining would block until the whole device buffer is played (or resume a paused stream to
+  // play what is left), so stream is dropped right after a short fade out
+  if (pause_ == PauseMethod::None && snd_pcm_state(pcm) == SND_PCM_STATE_RUNNING) FadeOut();
 
-  if (snd_pcm_drain(playback_handle_.get()) < 0) {
-    ERROR("Cannot stop playback stream and preserve remaining frames on buffer");
+  pause_ = PauseMethod::None;
+  requeue_.clear();
+  history_end_ = history_size_ = 0;
+  output_delay_ = 0;
+
+  if (snd_pcm_drop(pcm) < 0) {
+    ERROR("Cannot stop playback stream and clear remaining frames on buffer");
     return error::kUnknownError;
   }
 
@@ -172,18 +507,344 @@ error::Code Alsa::Stop() {
 
 /* ********************************************************************************************** */
 
+error::Code Alsa::Finish() {
+  StartIfReady(1);
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
 error::Code Alsa::AudioCallback(void *buffer, int size) {
   // As this is called multiple times, LOG will not be called here in the beginning
-  if (auto result = static_cast<int>(snd_pcm_writei(playback_handle_.get(), buffer, size));
+  const auto *input = static_cast<const float *>(buffer);
+  auto start = std::chrono::steady_clock::now();
+  uint64_t recoveries = statistics_.recoveries;
+
+  UpdateJitter(start);
+
+  if (access_ == PlaybackAccess::Mmap) {
+    WriteMmap(input, size);
+  } else {
+    WriteInterleaved(input, size);
+  }
+
+  // Only thread writing samples updates maximum, so there is no need for compare-and-swap
+  auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+
+  if (latency > statistics_.max_write_latency) statistics_.max_write_latency = latency;
+
+  statistics_.frames += size;
+  if (!history_.empty()) KeepHistory(input, size);
+
+  // Measured here, so other threads know how far behind the device is without touching stream
+  output_delay_ = std::max<int64_t>(GetDelay(), 0);
+
+  // After recovering from error, next write comes after a gap, so it must not count as jitter
+  last_write_ = start;
+  last_write_size_ = statistics_.recoveries == recoveries ? size : 0;
+
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+void Alsa::FadeOut() {
+  snd_pcm_t *pcm = playback_handle_.get();
+
+  // Only samples that device is not about to play can be taken back (usually, up to one period
+  // remains), otherwise dropping stream right away would end in a click
+  snd_pcm_sframes_t rewindable = snd_pcm_rewindable(pcm);
+  snd_pcm_sframes_t rewound = rewindable > 0 ? snd_pcm_rewind(pcm, rewindable) : 0;
+  if (rewound <= 0) return;
+
+  const size_t channels = format_.channels;
+  const auto fade_frames = static_cast<size_t>(format_.sample_rate * kFadeTime / 1000);
+  const size_t frames = std::min(static_cast<size_t>(rewound), fade_frames);
+
+  const size_t taken = static_cast<size_t>(rewound) * channels;
+
+  fade_.assign(frames * channels, 0.f);
+
+  // Samples taken back are the newest ones in history, so fade starts right after the ones left
+  if (taken <= history_size_) {
+    const size_t capacity = history_.size();
+    size_t position = (history_end_ + capacity - taken) % capacity;
+
+    for (size_t frame = 0; frame < frames; frame++) {
+      float gain = 1.f - static_cast<float>(frame + 1) / static_cast<float>(frames);
+
+      for (size_t channel = 0; channel < channels; channel++) {
+        fade_[frame * channels + channel] = history_[position] * gain;
+        position = (position + 1) % capacity;
+      }
+    }
+  }
+
+  if (access_ == PlaybackAccess::Mmap) {
+    WriteMmap(fade_.data(), static_cast<int>(frames));
+  } else {
+    WriteInterleaved(fade_.data(), static_cast<int>(frames));
+  }
+
+  // Stream is dropped only after the fade is played
+  int64_t delay = GetDelay();
+  if (delay > 0) {
+    std::this_thread::sleep_for(std::chrono::microseconds(delay * 1000000 / format_.sample_rate));
+  }
+
+  LOG("Fade out playback stream, rewound=", rewound, " remaining=", delay);
+}
+
+/* ********************************************************************************************** */
+
+void Alsa::UpdateJitter(std::chrono::steady_clock::time_point now) {
+  if (last_write_size_ == 0 || snd_pcm_state(playback_handle_.get()) != SND_PCM_STATE_RUNNING) {
+    return;
+  }
+
+  // Previous write should be followed by the next one right after device consumes its samples
+  int64_t expected = static_cast<int64_t>(last_write_size_) * 1000000 / format_.sample_rate;
+  int64_t interval =
+      std::chrono::duration_cast<std::chrono::microseconds>(now - last_write_).count();
+  int64_t jitter = std::abs(interval - expected);
+
+  const auto &bounds = Statistics::kJitterBounds;
+  auto bucket = std::upper_bound(bounds.begin(), bounds.end(), jitter) - bounds.begin();
+
+  statistics_.jitter[static_cast<size_t>(bucket)]++;
+}
+
+/* ********************************************************************************************** */
+
+void Alsa::KeepHistory(const float *input, int size) {
+  const size_t capacity = history_.size();
+  const size_t samples = static_cast<size_t>(size) * format_.channels;
+
+  // Only the newest samples fit in history when writing more than device buffer can hold
+  size_t count = std::min(samples, capacity);
+  input += samples - count;
+
+  size_t first = std::min(count, capacity - history_end_);
+  std::copy(input, input + first, history_.begin() + static_cast<std::ptrdiff_t>(history_end_));
+  std::copy(input + first, input + count, history_.begin());
+
+  history_end_ = (history_end_ + count) % capacity;
+  history_size_ = std::min(history_size_ + count, capacity);
+}
+
+/* ********************************************************************************************** */
+
+void Alsa::SaveUnplayed() {
+  requeue_.clear();
+
+  // Samples queued in device and not played yet are the newest ones written
+  int64_t delay = std::max<int64_t>(GetDelay(), 0);
+  size_t count = std::min(static_cast<size_t>(delay) * format_.channels, history_size_);
+  if (count == 0) return;
+
+  const size_t capacity = history_.size();
+  size_t begin = (history_end_ + capacity - count) % capacity;
+  size_t first = std::min(count, capacity - begin);
+
+  requeue_.reserve(count);
+  requeue_.insert(requeue_.end(), history_.begin() + static_cast<std::ptrdiff_t>(begin),
+                  history_.begin() + static_cast<std::ptrdiff_t>(begin + first));
+  requeue_.insert(requeue_.end(), history_.begin(),
+                  history_.begin() + static_cast<std::ptrdiff_t>(count - first));
+
+  // Samples are added to history once again when written on resume
+  history_end_ = history_size_ = 0;
+
+  LOG("Keep samples not played yet from playback stream, frames=", count / format_.channels);
+}
+
+/* ********************************************************************************************** */
+
+int64_t Alsa::GetDelay() {
+  snd_pcm_sframes_t delay = 0;
+  if (snd_pcm_delay(playback_handle_.get(), &delay) < 0) return 0;
+
+  return static_cast<int64_t>(delay);
+}
+
+/* ********************************************************************************************** */
+
+void Alsa::Convert(const float *input, void *output, snd_pcm_uframes_t frames) {
+  const size_t samples = frames * format_.channels;
+
+  if (format_.floating_point) {
+    converter_.Convert(input, static_cast<float *>(output), samples);
+  } else if (format_.bit_depth > 16) {
+    converter_.Convert(input, static_cast<int32_t *>(output), samples, format_.bit_depth);
+  } else {
+    converter_.Convert(input, static_cast<int16_t *>(output), samples);
+  }
+
+  statistics_.copied_frames += static_cast<int64_t>(frames);
+}
+
+/* ********************************************************************************************** */
+
+void Alsa::WriteInterleaved(const float *input, int size) {
+  const size_t samples = static_cast<size_t>(size) * format_.channels;
+  void *output = nullptr;
+
+  // Conversion buffers only grow, so after the first periods there is no more allocation
+  if (format_.floating_point) {
+    if (output_f32_.size() < samples) output_f32_.resize(samples);
+    output = output_f32_.data();
+  } else if (format_.bit_depth > 16) {
+    if (output_s32_.size() < samples) output_s32_.resize(samples);
+    output = output_s32_.data();
+  } else {
+    if (output_s16_.size() < samples) output_s16_.resize(samples);
+    output = output_s16_.data();
+  }
+
+  Convert(input, output, static_cast<snd_pcm_uframes_t>(size));
+
+  // ALSA copies the whole buffer once again, into device buffer
+  if (auto result = static_cast<int>(
+          TRACE_CALL("snd_pcm_writei", snd_pcm_writei(playback_handle_.get(), output, size)));
       result < 0) {
     ERROR("Cannot write buffer to playback stream, error=", result);
-    if ((result = snd_pcm_recover(playback_handle_.get(), result, 1)) == 0) {
-      // TODO: do something?
-      LOG("Recovered playback stream from error (overrun/underrun), error=", result);
+    Recover(result);
+    return;
+  }
+
+  statistics_.copied_frames += size;
+}
+
+/* ********************************************************************************************** */
+
+void Alsa::WriteMmap(const float *input, int size) {
+  snd_pcm_t *pcm = playback_handle_.get();
+  auto remaining = static_cast<snd_pcm_uframes_t>(size);
+
+  while (remaining > 0) {
+    snd_pcm_sframes_t available = snd_pcm_avail_update(pcm);
+
+    if (available < 0) {
+      if (!Recover(static_cast<int>(available))) return;
+      continue;
     }
+
+    // Device buffer is full, so stream must be running in order to release some room in it (it is
+    // usually started already, right after the commit that reached start threshold)
+    if (available == 0) {
+      int result = snd_pcm_state(pcm) == SND_PCM_STATE_PREPARED ? snd_pcm_start(pcm)
+                                                                : snd_pcm_wait(pcm, kWaitTimeout);
+
+      if (result < 0 && !Recover(result)) return;
+      continue;
+    }
+
+    // Region given by ALSA may be smaller than requested, as it ends at the buffer boundary
+    const snd_pcm_channel_area_t *areas = nullptr;
+    snd_pcm_uframes_t offset = 0;
+    snd_pcm_uframes_t frames = remaining;
+
+    if (int result = snd_pcm_mmap_begin(pcm, &areas, &offset, &frames); result < 0) {
+      if (!Recover(result)) return;
+      continue;
+    }
+
+    // For interleaved access, all channels share the same area (first and step are in bits)
+    auto output = static_cast<uint8_t *>(areas[0].addr) + areas[0].first / 8 +
+                  offset * (areas[0].step / 8);
+
+    Convert(input, output, frames);
+
+    snd_pcm_sframes_t committed =
+        TRACE_CALL("snd_pcm_mmap_commit", snd_pcm_mmap_commit(pcm, offset, frames));
+    if (committed < 0 || static_cast<snd_pcm_uframes_t>(committed) != frames) {
+      if (!Recover(committed < 0 ? static_cast<int>(committed) : -EPIPE)) return;
+      continue;
+    }
+
+    input += frames * format_.channels;
+    remaining -= frames;
+
+    // Unlike snd_pcm_writei, commit never starts the stream by itself
+    StartIfReady(start_threshold_);
   }
+}
 
-  return error::kSuccess;
+/* ********************************************************************************************** */
+
+void Alsa::StartIfReady(snd_pcm_uframes_t threshold) {
+  snd_pcm_t *pcm = playback_handle_.get();
+  if (snd_pcm_state(pcm) != SND_PCM_STATE_PREPARED) return;
+
+  // While prepared, device did not consume anything, so every frame not available was written
+  snd_pcm_sframes_t available = snd_pcm_avail_update(pcm);
+  if (available < 0) return;
+
+  snd_pcm_uframes_t written = buffer_size_ - std::min<snd_pcm_uframes_t>(available, buffer_size_);
+  if (written == 0 || written < threshold) return;
+
+  if (int result = snd_pcm_start(pcm); result < 0) {
+    ERROR("Cannot start playback stream, error=", result);
+    Recover(result);
+  }
+}
+
+/* ********************************************************************************************** */
+
+void Alsa::PlayRemaining() {
+  snd_pcm_t *pcm = playback_handle_.get();
+
+  // Remaining samples may not be enough to have started playback stream by itself
+  StartIfReady(1);
+
+  if (snd_pcm_state(pcm) == SND_PCM_STATE_RUNNING) {
+    int64_t limit = static_cast<int64_t>(format_.sample_rate) * kDrainTimeout / 1000;
+    int64_t delay = std::min(GetDelay(), limit);
+
+    if (delay > 0) {
+      std::this_thread::sleep_for(std::chrono::microseconds(delay * 1000000 / format_.sample_rate));
+    }
+  }
+
+  snd_pcm_drop(pcm);
+  last_write_size_ = 0;
+  output_delay_ = 0;
+}
+
+/* ********************************************************************************************** */
+
+bool Alsa::Recover(int error) {
+  if (error == -EPIPE) statistics_.underruns++;
+
+  if (int result = snd_pcm_recover(playback_handle_.get(), error, 1); result < 0) {
+    ERROR("Cannot recover playback stream from error=", error, ", result=", result);
+    return false;
+  }
+
+  statistics_.recoveries++;
+
+  LOG("Recovered playback stream from error (overrun/underrun), error=", error);
+  return true;
+}
+
+/* ********************************************************************************************** */
+
+Playback::Statistics Alsa::GetStatistics() const {
+  Statistics statistics{
+      .frames = statistics_.frames,
+      .copied_frames = statistics_.copied_frames,
+      .underruns = statistics_.underruns,
+      .recoveries = statistics_.recoveries,
+      .max_write_latency = statistics_.max_write_latency,
+  };
+
+  for (size_t i = 0; i < statistics.jitter.size(); i++) {
+    statistics.jitter[i] = statistics_.jitter[i];
+  }
+
+  return statistics;
 }
 
 /* ********************************************************************************************** */
@@ -205,8 +866,9 @@ snd_mixer_elem_t *Alsa::GetMasterPlayback() {
 
 error::Code Alsa::SetVolume(model::Volume value) {
   LOG("Set volume on master playback with value=", value);
+  std::scoped_lock lock(mixer_mutex_);
 
-  auto master = GetMasterPlayback();
+  auto master = master_;
   if (master == nullptr) {
     ERROR("Cannot get master playback");
     return error::kUnknownError;
@@ -220,22 +882,54 @@ error::Code Alsa::SetVolume(model::Volume value) {
   // Calculate new volume based on values read
   long new_value = (max * (float)value) - min;
 
-  // Set new value
+  // Set new value (and keep it, so the event caused by this change is not informed back)
   snd_mixer_selem_set_playback_volume_all(master, new_value);
+  volume_ = ReadVolume();
+
   return error::kSuccess;
 }
 
 /* ********************************************************************************************** */
 
+snd_pcm_format_t Alsa::ToPcmFormat(const model::AudioFormat &format) {
+  if (format.floating_point) {
+    return format.bit_depth == 32 ? SND_PCM_FORMAT_FLOAT_LE : SND_PCM_FORMAT_UNKNOWN;
+  }
+
+  switch (format.bit_depth) {
+    case 16:
+      return SND_PCM_FORMAT_S16_LE;
+
+    case 24:
+      return SND_PCM_FORMAT_S24_LE;
+
+    case 32:
+      return SND_PCM_FORMAT_S32_LE;
+
+    default:
+      return SND_PCM_FORMAT_UNKNOWN;
+  }
+}
+
+/* ********************************************************************************************** */
+
 model::Volume Alsa::GetVolume() {
   LOG("Get volume from master playback");
+  std::scoped_lock lock(mixer_mutex_);
 
-  auto master = GetMasterPlayback();
-  if (master == nullptr) {
+  if (master_ == nullptr) {
     ERROR("Cannot get master playback");
     return model::Volume();
   }
 
+  return ReadVolume();
+}
+
+/* ********************************************************************************************** */
+
+model::Volume Alsa::ReadVolume() {
+  auto master = master_;
+
   // Get value range for volume
   long min, max;
   snd_mixer_selem_get_playback_volume_range(master, &min, &max);
@@ -251,4 +945,68 @@ model::Volume Alsa::GetVolume() {
   return model::Volume(rounded);
 }
 
+/* ********************************************************************************************** */
+
+void Alsa::SetVolumeListener(VolumeListener listener) {
+  std::scoped_lock lock(mixer_mutex_);
+  volume_listener_ = std::move(listener);
+}
+
+/* ********************************************************************************************** */
+
+void Alsa::WatchMixer() {
+  LOG("Start mixer watcher thread");
+  std::vector<pollfd> descriptors;
+
+  {
+    // First descriptor is only used to wake up this thread on destruction
+    std::scoped_lock lock(mixer_mutex_);
+    int count = snd_mixer_poll_descriptors_count(mixer_.get());
+    descriptors.resize(static_cast<size_t>(std::max(count, 0)) + 1);
+    descriptors[0] = pollfd{.fd = wakeup_[0], .events = POLLIN, .revents = 0};
+
+    snd_mixer_poll_descriptors(mixer_.get(), descriptors.data() + 1,
+                               static_cast<unsigned int>(descriptors.size() - 1));
+  }
+
+  while (true) {
+    if (poll(descriptors.data(), descriptors.size(), -1) < 0) {
+      if (errno == EINTR) continue;
+
+      ERROR("Cannot wait for events from mixer, error=", errno);
+      break;
+    }
+
+    if (descriptors[0].revents != 0) break;
+
+    VolumeListener listener;
+    model::Volume value;
+    bool changed = false;
+
+    {
+      std::scoped_lock lock(mixer_mutex_);
+      unsigned short revents = 0;
+
+      snd_mixer_poll_descriptors_revents(mixer_.get(), descriptors.data() + 1,
+                                         static_cast<unsigned int>(descriptors.size() - 1),
+                                         &revents);
+      snd_mixer_handle_events(mixer_.get());
+
+      // Mixer also sends events for other changes (e.g. mute), which are not informed
+      value = ReadVolume();
+      changed = value != volume_;
+      volume_ = value;
+      listener = volume_listener_;
+    }
+
+    // Listener is called without lock, so it may even get volume again
+    if (changed && listener) {
+      LOG("Volume changed on master playback by another mixer, value=", value);
+      listener(value);
+    }
+  }
+
+  LOG("Finish mixer watcher thread");
+}
+
 }  // namespace driver
@@ -0,0 +1,367 @@
+#include "audio/driver/dsp_chain.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DSP_CHAIN_X86
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define DSP_CHAIN_NEON
+#endif
+
+namespace driver {
+
+DspChain::DspChain(int channels, int sample_rate)
+    : DspChain(channels, sample_rate, DetectKernel()) {}
+
+/* ********************************************************************************************** */
+
+DspChain::DspChain(int channels, int sample_rate, Kernel kernel)
+    : channels_{std::max(channels, 1)}, sample_rate_{sample_rate}, kernel_{kernel} {
+  if (!IsSupported(kernel_) || channels_ != kSimdChannels) kernel_ = Kernel::Scalar;
+}
+
+/* ********************************************************************************************** */
+
+DspChain::Kernel DspChain::DetectKernel() {
+#if defined(DSP_CHAIN_X86)
+  if (IsSupported(Kernel::Avx2)) return Kernel::Avx2;
+  if (IsSupported(Kernel::Sse)) return Kernel::Sse;
+#elif defined(DSP_CHAIN_NEON)
+  return Kernel::Neon;
+#endif
+  return Kernel::Scalar;
+}
+
+/* ********************************************************************************************** */
+
+bool DspChain::IsSupported(Kernel kernel) {
+  switch (kernel) {
+    case Kernel::Scalar:
+      return true;
+
+#if defined(DSP_CHAIN_X86)
+    case Kernel::Sse:
+      return __builtin_cpu_supports("sse2");
+
+    case Kernel::Avx2:
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(DSP_CHAIN_NEON)
+    case Kernel::Neon:
+      return true;
+#endif
+
+    default:
+      return false;
+  }
+}
+
+/* ********************************************************************************************** */
+
+void DspChain::SetVolume(model::Volume value) { volume_ = static_cast<float>(value); }
+
+/* ********************************************************************************************** */
+
+void DspChain::UpdateFilters(const model::EqualizerPreset& filters) {
+  // Padding stages are identity filters, so they do not change the signal at all
+  int stages = static_cast<int>(filters.size());
+  stages += (kStageAlignment - stages % kStageAlignment) % kStageAlignment;
+
+  // Keep current state when only coefficients are changing, to avoid audible clicks
+  if (cascade_.stages != stages) {
+    const size_t size = static_cast<size_t>(stages) * channels_;
+
+    cascade_ = Cascade{
+        .stages = stages,
+        .b0 = std::vector<double>(size, 1.),
+        .b1 = std::vector<double>(size, 0.),
+        .b2 = std::vector<double>(size, 0.),
+        .a1 = std::vector<double>(size, 0.),
+        .a2 = std::vector<double>(size, 0.),
+        .z1 = std::vector<double>(size, 0.),
+        .z2 = std::vector<double>(size, 0.),
+        .y = std::vector<double>(size, 0.),
+    };
+  }
+
+  const double kPi = std::acos(-1);
+  const double nyquist = sample_rate_ / 2.;
+
+  for (size_t stage = 0; stage < filters.size(); stage++) {
+    const auto& filter = filters[stage];
+
+    // Peaking equalizer from "Cookbook formulae for audio EQ biquad filter coefficients"
+    double b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+
+    if (filter.gain != 0 && filter.frequency > 0 && filter.frequency < nyquist) {
+      const double A = std::pow(10, filter.gain / 40);
+      const double w0 = 2 * kPi * filter.frequency / sample_rate_;
+      const double alpha = std::sin(w0) / (2 * filter.Q);
+      const double a0 = 1 + alpha / A;
+
+      b0 = (1 + alpha * A) / a0;
+      b1 = (-2 * std::cos(w0)) / a0;
+      b2 = (1 - alpha * A) / a0;
+      a1 = b1;
+      a2 = (1 - alpha / A) / a0;
+    }
+
+    const size_t index = stage * channels_;
+    std::fill_n(cascade_.b0.begin() + index, channels_, b0);
+    std::fill_n(cascade_.b1.begin() + index, channels_, b1);
+    std::fill_n(cascade_.b2.begin() + index, channels_, b2);
+    std::fill_n(cascade_.a1.begin() + index, channels_, a1);
+    std::fill_n(cascade_.a2.begin() + index, channels_, a2);
+  }
+}
+
+/* ********************************************************************************************** */
+
+void DspChain::Process(const float* input, float* output, int frames) {
+  // Without filters, there is no pipeline to run, so just apply volume
+  Kernel kernel = cascade_.stages > 0 ? kernel_ : Kernel::Scalar;
+
+  switch (kernel) {
+    case Kernel::Sse:
+      ProcessSse(input, output, frames);
+      break;
+
+    case Kernel::Avx2:
+      ProcessAvx2(input, output, frames);
+      break;
+
+    case Kernel::Neon:
+      ProcessNeon(input, output, frames);
+      break;
+
+    default:
+      ProcessScalar(input, output, frames);
+      break;
+  }
+}
+
+/* ********************************************************************************************** */
+
+void DspChain::Reset() {
+  std::fill(cascade_.z1.begin(), cascade_.z1.end(), 0.);
+  std::fill(cascade_.z2.begin(), cascade_.z2.end(), 0.);
+}
+
+/* ********************************************************************************************** */
+
+void DspChain::ProcessScalar(const float* input, float* output, int frames) {
+  for (int i = 0; i < frames * channels_; i++) {
+    const int channel = i % channels_;
+    double x = input[i] * volume_;
+
+    for (int stage = 0; stage < cascade_.stages; stage++) {
+      const size_t index = static_cast<size_t>(stage) * channels_ + channel;
+      double& z1 = cascade_.z1[index];
+      double& z2 = cascade_.z2[index];
+
+      const double y = cascade_.b0[index] * x + z1;
+      z1 = cascade_.b1[index] * x - cascade_.a1[index] * y + z2;
+      z2 = cascade_.b2[index] * x - cascade_.a2[index] * y;
+      x = y;
+    }
+
+    output[i] = static_cast<float>(x);
+  }
+}
+
+/* ********************************************************************************************** */
+
+#if defined(DSP_CHAIN_X86)
+
+void DspChain::ProcessSse(const float* input, float* output, int frames) {
+  const __m128d volume = _mm_set1_pd(volume_);
+
+  const int stages = cascade_.stages;
+  double* y = cascade_.y.data();
+
+  // Pipeline runs until last stage has processed the last frame
+  for (int i = 0; i < frames + stages - 1; i++) {
+    // Stage N processes frame "i - N", so skip stages without a frame to process
+    const int first = std::max(0, i - frames + 1);
+    const int last = std::min(stages - 1, i);
+
+    // From last to first stage, so that output from previous stage is still the old one
+    for (int stage = last; stage >= first; stage--) {
+      const int index = stage * kSimdChannels;
+
+      const __m128d x =
+          stage > 0 ? _mm_loadu_pd(y + index - kSimdChannels)
+                    : _mm_mul_pd(_mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(
+                                     reinterpret_cast<const __m128i*>(input + i * kSimdChannels)))),
+                                 volume);
+
+      const __m128d z1 = _mm_loadu_pd(cascade_.z1.data() + index);
+      const __m128d z2 = _mm_loadu_pd(cascade_.z2.data() + index);
+
+      const __m128d out = _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(cascade_.b0.data() + index), x), z1);
+
+      const __m128d feedforward_1 = _mm_mul_pd(_mm_loadu_pd(cascade_.b1.data() + index), x);
+      const __m128d feedback_1 = _mm_mul_pd(_mm_loadu_pd(cascade_.a1.data() + index), out);
+      const __m128d feedforward_2 = _mm_mul_pd(_mm_loadu_pd(cascade_.b2.data() + index), x);
+      const __m128d feedback_2 = _mm_mul_pd(_mm_loadu_pd(cascade_.a2.data() + index), out);
+
+      _mm_storeu_pd(cascade_.z1.data() + index,
+                    _mm_add_pd(_mm_sub_pd(feedforward_1, feedback_1), z2));
+      _mm_storeu_pd(cascade_.z2.data() + index, _mm_sub_pd(feedforward_2, feedback_2));
+      _mm_storeu_pd(y + index, out);
+    }
+
+    if (last < stages - 1) continue;
+
+    // Last stage has just finished a frame, so store it back as a pair of floats
+    const __m128 converted = _mm_cvtpd_ps(_mm_loadu_pd(y + last * kSimdChannels));
+    _mm_storel_pi(reinterpret_cast<__m64*>(output + (i - last) * kSimdChannels), converted);
+  }
+}
+
+/* ********************************************************************************************** */
+
+__attribute__((target("avx2,fma"))) void DspChain::ProcessAvx2(const float* input,
+                                                                float* output, int frames) {
+  const __m128d volume = _mm_set1_pd(volume_);
+
+  // Each register holds a pair of stages, both with a pair of channels
+  constexpr int kStride = kSimdChannels * 2;
+  const int stages = cascade_.stages;
+  double* y = cascade_.y.data();
+
+  // Pipeline runs until last stage has processed the last frame
+  for (int i = 0; i < frames + stages - 1; i++) {
+    // From last to first pair, so that output from previous stage is still the old one
+    for (int pair = stages / 2 - 1; pair >= 0; pair--) {
+      // Stage N processes frame "i - N", so check if each stage has a frame to process
+      const int frame = i - pair * 2;
+      const bool low = frame >= 0 && frame < frames;
+      const bool high = frame >= 1 && frame <= frames;
+
+      if (!low && !high) continue;
+
+      const int index = pair * kStride;
+
+      // First stage from pair receives output from the last stage of previous pair (or input
+      // samples), while second stage receives output from the first stage
+      __m128d input_low = _mm_setzero_pd();
+
+      if (pair > 0) {
+        input_low = _mm_loadu_pd(y + index - kSimdChannels);
+      } else if (low) {
+        const __m128i samples =
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + i * kSimdChannels));
+        input_low = _mm_mul_pd(_mm_cvtps_pd(_mm_castsi128_ps(samples)), volume);
+      }
+
+      const __m256d x = _mm256_set_m128d(_mm_loadu_pd(y + index), input_low);
+
+      const __m256d z1 = _mm256_loadu_pd(cascade_.z1.data() + index);
+      const __m256d z2 = _mm256_loadu_pd(cascade_.z2.data() + index);
+
+      // Fused multiply-add shortens the dependency chain from every biquad filter
+      const __m256d out = _mm256_fmadd_pd(_mm256_loadu_pd(cascade_.b0.data() + index), x, z1);
+
+      const __m256d feedforward_1 =
+          _mm256_fmadd_pd(_mm256_loadu_pd(cascade_.b1.data() + index), x, z2);
+      const __m256d feedforward_2 = _mm256_mul_pd(_mm256_loadu_pd(cascade_.b2.data() + index), x);
+
+      __m256d next_z1 =
+          _mm256_fnmadd_pd(_mm256_loadu_pd(cascade_.a1.data() + index), out, feedforward_1);
+      __m256d next_z2 =
+          _mm256_fnmadd_pd(_mm256_loadu_pd(cascade_.a2.data() + index), out, feedforward_2);
+
+      // While pipeline is filling up or draining, a single stage from pair may be active
+      if (!high) {
+        next_z1 = _mm256_blend_pd(z1, next_z1, 0x3);
+        next_z2 = _mm256_blend_pd(z2, next_z2, 0x3);
+      } else if (!low) {
+        next_z1 = _mm256_blend_pd(z1, next_z1, 0xC);
+        next_z2 = _mm256_blend_pd(z2, next_z2, 0xC);
+      }
+
+      _mm256_storeu_pd(cascade_.z1.data() + index, next_z1);
+      _mm256_storeu_pd(cascade_.z2.data() + index, next_z2);
+      _mm256_storeu_pd(y + index, out);
+    }
+
+    const int frame = i - stages + 1;
+    if (frame < 0) continue;
+
+    // Last stage has just finished a frame, so store it back as a pair of floats
+    const __m128 converted = _mm_cvtpd_ps(_mm_loadu_pd(y + (stages - 1) * kSimdChannels));
+    _mm_storel_pi(reinterpret_cast<__m64*>(output + frame * kSimdChannels), converted);
+  }
+}
+
+#else
+
+void DspChain::ProcessSse(const float* input, float* output, int frames) {
+  ProcessScalar(input, output, frames);
+}
+
+void DspChain::ProcessAvx2(const float* input, float* output, int frames) {
+  ProcessScalar(input, output, frames);
+}
+
+#endif
+
+/* ********************************************************************************************** */
+
+#if defined(DSP_CHAIN_NEON)
+
+void DspChain::ProcessNeon(const float* input, float* output, int frames) {
+  const float64x2_t volume = vdupq_n_f64(volume_);
+
+  const int stages = cascade_.stages;
+  double* y = cascade_.y.data();
+
+  // Pipeline runs until last stage has processed the last frame
+  for (int i = 0; i < frames + stages - 1; i++) {
+    // Stage N processes frame "i - N", so skip stages without a frame to process
+    const int first = std::max(0, i - frames + 1);
+    const int last = std::min(stages - 1, i);
+
+    // From last to first stage, so that output from previous stage is still the old one
+    for (int stage = last; stage >= first; stage--) {
+      const int index = stage * kSimdChannels;
+
+      const float64x2_t x =
+          stage > 0 ? vld1q_f64(y + index - kSimdChannels)
+                    : vmulq_f64(vcvt_f64_f32(vld1_f32(input + i * kSimdChannels)), volume);
+
+      const float64x2_t z1 = vld1q_f64(cascade_.z1.data() + index);
+      const float64x2_t z2 = vld1q_f64(cascade_.z2.data() + index);
+
+      const float64x2_t out = vfmaq_f64(z1, vld1q_f64(cascade_.b0.data() + index), x);
+
+      const float64x2_t feedforward_1 = vfmaq_f64(z2, vld1q_f64(cascade_.b1.data() + index), x);
+      const float64x2_t feedforward_2 = vmulq_f64(vld1q_f64(cascade_.b2.data() + index), x);
+
+      vst1q_f64(cascade_.z1.data() + index,
+                vfmsq_f64(feedforward_1, vld1q_f64(cascade_.a1.data() + index), out));
+      vst1q_f64(cascade_.z2.data() + index,
+                vfmsq_f64(feedforward_2, vld1q_f64(cascade_.a2.data() + index), out));
+      vst1q_f64(y + index, out);
+    }
+
+    if (last < stages - 1) continue;
+
+    // Last stage has just finished a frame, so store it back as a pair of floats
+    const float32x2_t converted = vcvt_f32_f64(vld1q_f64(y + last * kSimdChannels));
+    vst1_f32(output + (i - last) * kSimdChannels, converted);
+  }
+}
+
+#else
+
+void DspChain::ProcessNeon(const float* input, float* output, int frames) {
+  ProcessScalar(input, output, frames);
+}
+
+#endif
+
+}  // namespace driver
@@ -2,10 +2,14 @@
 
 #include <libavutil/error.h>
 
+#include <algorithm>
+#include <cmath>
 #include <iomanip>
 #include <iterator>
+#include <thread>
 
 #include "util/logger.h"
+#include "util/tracer.h"
 
 namespace driver {
 
@@ -23,7 +27,35 @@ static void log_callback(void *, int level, const char *fmt, va_list vargs) {
   LOG("[LOG_CALLBACK] LEVEL:", level, " MESSAGE:", message);
 }
 
-FFmpeg::FFmpeg() {
+/* ********************************************************************************************** */
+
+//! Callback for custom I/O context to read from local file mapped into memory
+static int read_mapped_file(void *opaque, uint8_t *buffer, int size) {
+  auto file = static_cast<util::MappedFile *>(opaque);
+
+  size_t length = file->Read(buffer, static_cast<size_t>(size));
+  return length > 0 ? static_cast<int>(length) : AVERROR_EOF;
+}
+
+//! Callback for custom I/O context to seek position in local file mapped into memory
+static int64_t seek_mapped_file(void *opaque, int64_t offset, int whence) {
+  auto file = static_cast<util::MappedFile *>(opaque);
+
+  // FFmpeg may ask only for file size, without changing position
+  if (whence & AVSEEK_SIZE) return file->GetSize();
+
+  return file->Seek(offset, whence & ~AVSEEK_FORCE);
+}
+
+/* ********************************************************************************************** */
+
+FFmpeg::FFmpeg(DspBackend backend, bool map_files, int threads, std::shared_ptr<PcmCache> cache)
+    : map_files_{map_files}, threads_{threads}, cache_{std::move(cache)} {
+  if (backend == DspBackend::Native) {
+    dsp_ = std::make_unique<DspChain>(kChannels, kSampleRate);
+    LOG("Using native DSP backend with kernel=", static_cast<int>(dsp_->GetKernel()));
+  }
+
 #if LIBAVUTIL_VERSION_MAJOR > 56
   ch_layout_.reset(new AVChannelLayout{});
   // Set output channel layout to stereo (2-channel)
@@ -43,6 +75,20 @@ error::Code FFmpeg::OpenInputStream(const std::string &filepath) {
   LOG("Open input stream from filepath=", std::quoted(filepath));
   AVFormatContext *ptr = nullptr;
 
+  // Prefer to read from file mapped into memory, otherwise let FFmpeg open file by itself
+  if (AVIOContext *io_context = map_files_ ? CreateMappedIoContext(filepath) : nullptr;
+      io_context) {
+    ptr = avformat_alloc_context();
+    if (!ptr) {
+      ERROR("Cannot allocate input stream");
+      return error::kUnknownError;
+    }
+
+    ptr->pb = io_context;
+    ptr->flags |= AVFMT_FLAG_CUSTOM_IO;
+  }
+
+  // In case of failure, input stream is freed by FFmpeg (but custom I/O context is not)
   int result = avformat_open_input(&ptr, filepath.c_str(), nullptr, nullptr);
   if (result < 0) {
     ERROR("Cannot open input stream, error=", result);
@@ -62,6 +108,36 @@ error::Code FFmpeg::OpenInputStream(const std::string &filepath) {
 
 /* ********************************************************************************************** */
 
+AVIOContext *FFmpeg::CreateMappedIoContext(const std::string &filepath) {
+  mapped_file_ = util::MappedFile::Create(filepath);
+  if (!mapped_file_) {
+    LOG("Unable to map file into memory, using default I/O instead");
+    return nullptr;
+  }
+
+  // Buffer is owned by I/O context from now on (and it may be reallocated by FFmpeg internally)
+  auto buffer = static_cast<unsigned char *>(av_malloc(kIoBufferSize));
+  if (!buffer) {
+    mapped_file_.reset();
+    return nullptr;
+  }
+
+  io_context_.reset(avio_alloc_context(buffer, kIoBufferSize, 0, mapped_file_.get(),
+                                       read_mapped_file, nullptr, seek_mapped_file));
+
+  if (!io_context_) {
+    ERROR("Cannot allocate custom I/O context");
+    av_free(buffer);
+    mapped_file_.reset();
+    return nullptr;
+  }
+
+  LOG("Mapped file into memory, size=", mapped_file_->GetSize());
+  return io_context_.get();
+}
+
+/* ********************************************************************************************** */
+
 error::Code FFmpeg::ConfigureDecoder() {
   LOG("Configure audio decoder for opened input stream");
 
@@ -109,6 +185,14 @@ error::Code FFmpeg::ConfigureDecoder() {
   }
 #endif
 
+  // Codecs with large frames may be decoded using multiple threads (must be set before opening it)
+  Threading threading = ChooseThreading(codec, threads_);
+  decoder_->thread_count = threading.count;
+  decoder_->thread_type = threading.type;
+
+  LOG("Decode using codec=", codec->name, " threads=", threading.count,
+      " thread_type=", threading.type);
+
   result = avcodec_open2(decoder_.get(), codec, nullptr);
   if (result < 0) {
     ERROR("Cannot initialize audio decoder, error=", result);
@@ -120,6 +204,33 @@ error::Code FFmpeg::ConfigureDecoder() {
 
 /* ********************************************************************************************** */
 
+FFmpeg::Threading FFmpeg::ChooseThreading(const AVCodec *codec, int requested) {
+  constexpr Threading kSingleThread{.count = 1, .type = 0};
+
+  auto policy = std::find_if(kThreadingPolicies.begin(), kThreadingPolicies.end(),
+                             [codec](const auto &entry) { return entry.codec_id == codec->id; });
+
+  if (requested == kNoThreads || policy == kThreadingPolicies.end()) return kSingleThread;
+
+  // Frame threading is preferred, as audio codecs rarely split a frame into slices
+  int type = 0;
+  if (codec->capabilities & AV_CODEC_CAP_FRAME_THREADS) type |= FF_THREAD_FRAME;
+  if (codec->capabilities & AV_CODEC_CAP_SLICE_THREADS) type |= FF_THREAD_SLICE;
+
+  if (type == 0) return kSingleThread;
+
+  int count = requested;
+
+  if (requested == kAutoThreads) {
+    auto cores = static_cast<int>(std::thread::hardware_concurrency());
+    count = std::clamp(cores, 1, policy->max_threads);
+  }
+
+  return count > 1 ? Threading{.count = count, .type = type} : kSingleThread;
+}
+
+/* ********************************************************************************************** */
+
 error::Code FFmpeg::ConfigureFilters() {
   LOG("Configure filter chain");
 
@@ -134,17 +245,31 @@ error::Code FFmpeg::ConfigureFilters() {
   error::Code result = CreateFilterAbufferSrc();
   if (result != error::kSuccess) return result;
 
-  // Create and configure volume filter
-  result = CreateFilterVolume();
-  if (result != error::kSuccess) return result;
-
-  // Create and configure all equalizer filters
-  LOG("Create new equalizer filters, size=", audio_filters_.size());
-  for (const auto &[name, filter] : audio_filters_) {
-    result = CreateFilterEqualizer(name, filter);
+  // While volume and equalizer are neutral, samples may go straight to aformat
+  bypass_filters_ = CanBypassFilters();
+
+  if (bypass_filters_) {
+    LOG("Bypass volume and equalizer filters");
+  } else if (dsp_) {
+    // Volume and equalization are applied by DspChain over filtergraph output
+    dsp_->Reset();
+    dsp_->SetVolume(volume_);
+  } else {
+    // Create and configure volume filter
+    result = CreateFilterVolume();
     if (result != error::kSuccess) return result;
+
+    // Create and configure all equalizer filters
+    LOG("Create new equalizer filters, size=", audio_filters_.size());
+    for (const auto &[name, filter] : audio_filters_) {
+      result = CreateFilterEqualizer(name, filter);
+      if (result != error::kSuccess) return result;
+    }
   }
 
+  // Equalizer filters are created already with the latest parameters
+  applied_filters_ = audio_filters_;
+
   // Create and configure aformat filter
   result = CreateFilterAformat();
   if (result != error::kSuccess) return result;
@@ -277,9 +402,9 @@ error::Code FFmpeg::CreateFilterAformat() {
 
   // Set filter options through the AVOptions API
   av_opt_set(aformat_ctx, "channel_layout", ch_layout.data(), AV_OPT_SEARCH_CHILDREN);
-  av_opt_set(aformat_ctx, "sample_fmts", av_get_sample_fmt_name(AV_SAMPLE_FMT_S16),
+  av_opt_set(aformat_ctx, "sample_fmts", av_get_sample_fmt_name(kSampleFormat),
              AV_OPT_SEARCH_CHILDREN);
-  av_opt_set_int(aformat_ctx, "sample_rate", kSampleRate, AV_OPT_SEARCH_CHILDREN);
+  av_opt_set_int(aformat_ctx, "sample_rate", sample_rate_, AV_OPT_SEARCH_CHILDREN);
 
   // Initialize filter
   if (int result = avfilter_init_str(aformat_ctx, nullptr); result < 0) {
@@ -372,12 +497,16 @@ error::Code FFmpeg::ConnectFilters() {
   std::vector<AVFilterContext *> filters_to_link;
   filters_to_link.reserve(kDefaultFilterCount + audio_filters_.size());
 
-  // Add both abuffer and volume filters
-  filters_to_link.insert(filters_to_link.end(), {buffersrc_ctx_.get(), volume_ctx});
+  // Add abuffer filter
+  filters_to_link.push_back(buffersrc_ctx_.get());
+
+  // Add volume and equalizer filters (only when they are not replaced by DspChain or bypassed)
+  if (!dsp_ && !bypass_filters_) {
+    filters_to_link.push_back(volume_ctx);
 
-  // Add equalizer filters
-  for (const auto &[name, filter] : audio_filters_) {
-    filters_to_link.push_back(avfilter_graph_get_filter(filter_graph_.get(), name.c_str()));
+    for (const auto &[name, filter] : audio_filters_) {
+      filters_to_link.push_back(avfilter_graph_get_filter(filter_graph_.get(), name.c_str()));
+    }
   }
 
   // Add aformat and abuffersink filters
@@ -450,6 +579,9 @@ error::Code FFmpeg::OpenFile(model::Song &audio_info) {
     return error_code;
   };
 
+  // Song decoded before may be served straight from cache, without any codec work
+  if (OpenCachedSong(audio_info)) return error::kSuccess;
+
   error::Code result = OpenInputStream(audio_info.filepath);
   if (result != error::kSuccess) return clean_up_and_return(result);
 
@@ -462,18 +594,107 @@ error::Code FFmpeg::OpenFile(model::Song &audio_info) {
   // At this point, we can get detailed information about the song
   FillAudioInformation(audio_info);
 
+  // Decoded samples are written into cache while song is played
+  if (cache_) cache_writer_ = cache_->CreateWriter(audio_info, sample_rate_);
+
   return result;
 }
 
 /* ********************************************************************************************** */
 
+bool FFmpeg::OpenCachedSong(model::Song &audio_info) {
+  if (!cache_) return false;
+
+  cached_song_ = cache_->Find(audio_info.filepath, sample_rate_);
+  if (!cached_song_) return false;
+
+  const model::Song &cached = cached_song_->GetSong();
+  audio_info.artist = cached.artist;
+  audio_info.title = cached.title;
+  audio_info.num_channels = cached.num_channels;
+  audio_info.sample_rate = cached.sample_rate;
+  audio_info.bit_rate = cached.bit_rate;
+  audio_info.bit_depth = cached.bit_depth;
+  audio_info.duration = cached.duration;
+
+  // There is no filtergraph for cached song, so volume and equalizer are applied by DspChain
+  if (dsp_) {
+    dsp_->Reset();
+    dsp_->SetVolume(volume_);
+  } else {
+    cache_dsp_ = CreateDspChain(DspChain::DetectKernel());
+  }
+
+  return true;
+}
+
+/* ********************************************************************************************** */
+
+error::Code FFmpeg::SetOutputFormat(const model::AudioFormat &format, bool passthrough) {
+  LOG("Set output format=", format, " passthrough=", passthrough);
+
+  if (format.channels != kChannels || format.sample_rate == 0) {
+    ERROR("Output format not supported by decoder");
+    return error::kUnknownError;
+  }
+
+  auto sample_rate = static_cast<int>(format.sample_rate);
+  if (sample_rate == sample_rate_ && passthrough == passthrough_) return error::kSuccess;
+
+  bool rate_changed = sample_rate != sample_rate_;
+
+  sample_rate_ = sample_rate;
+  passthrough_ = passthrough;
+
+  // Biquad coefficients depend on sample rate, so native DSP chain must be recreated
+  if (dsp_ && rate_changed) dsp_ = CreateDspChain(dsp_->GetKernel());
+
+  // Cached song was stored using another sample rate, so it must be opened again
+  if (cached_song_ && rate_changed) {
+    model::Song song = cached_song_->GetSong();
+    cached_song_.reset();
+    cache_dsp_.reset();
+
+    return OpenFile(song);
+  }
+
+  // Song was looked up in cache before its format was negotiated (so using the previous sample
+  // rate), thus it may be there already for the new one. Otherwise, nothing was decoded yet, so
+  // entry in cache is simply restarted using the new sample rate
+  if (cache_writer_ && rate_changed) {
+    model::Song song = cache_writer_->GetSong();
+
+    if (OpenCachedSong(song)) {
+      LOG("Found song in cache after changing sample rate=", sample_rate_);
+      cache_writer_.reset();
+      return error::kSuccess;
+    }
+
+    cache_writer_ = cache_->CreateWriter(song, sample_rate_);
+  }
+
+  // In case that file is already opened, aformat filter must use the new format
+  if (filter_graph_) return ConfigureFilters();
+
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
 error::Code FFmpeg::Decode(int samples, AudioCallback callback) {
+  if (cached_song_) return DecodeCachedSong(samples, callback);
+
   LOG("Decode song using maximum sample=", samples);
 
+  AVStream *stream = input_stream_->streams[stream_index_];
+
   // Allocate internal decoding structure
   shared_context_ = DecodingData{
-      .time_base = input_stream_->streams[stream_index_]->time_base,
+      .time_base = stream->time_base,
+      .start_time = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0,
       .position = 0,
+      .seek_target = 0,
+      .seeking = false,
       .packet{Packet(av_packet_alloc())},
       .frame_decoded{Frame(av_frame_alloc())},
       .frame_filtered{Frame(av_frame_alloc())},
@@ -491,55 +712,150 @@ error::Code FFmpeg::Decode(int samples, AudioCallback callback) {
   AVFrame *frame = shared_context_.frame_decoded.get();
   int64_t song_duration = (input_stream_->duration / AV_TIME_BASE);
 
-  // Read audio raw data from input stream
-  while (av_read_frame(input_stream_.get(), packet) >= 0 && shared_context_.KeepDecoding()) {
-    // If not the same stream index, we should not try to decode it
-    if (packet->stream_index != stream_index_) {
-      av_packet_unref(packet);
-      continue;
-    }
+  auto receive_frame = [this, frame] {
+    return TRACE_CALL("avcodec_receive_frame", avcodec_receive_frame(decoder_.get(), frame));
+  };
+
+  // Decode until the end of input stream, starting over whenever a seek is requested while the
+  // last samples are drained
+  bool rewind;
 
-    // Send packet to decoder
-    if (auto result = avcodec_send_packet(decoder_.get(), packet); result < 0) {
-      // It is not actually an error, this kind of situation may happen when seek frame is used
-      if (result == AVERROR_INVALIDDATA && shared_context_.position == song_duration) {
-        break;
+  do {
+    rewind = false;
+
+    // Read audio raw data from input stream
+    while (TRACE_CALL("av_read_frame", av_read_frame(input_stream_.get(), packet)) >= 0 &&
+           shared_context_.KeepDecoding()) {
+      // If not the same stream index, we should not try to decode it
+      if (packet->stream_index != stream_index_) {
+        av_packet_unref(packet);
+        continue;
+      }
+
+      // Send packet to decoder
+      if (auto result = avcodec_send_packet(decoder_.get(), packet); result < 0) {
+        // It is not actually an error, this kind of situation may happen when seek frame is used
+        if (result == AVERROR_INVALIDDATA &&
+            shared_context_.position / sample_rate_ >= song_duration) {
+          break;
+        }
+
+        ERROR("Cannot decode song");
+        return error::kDecodeFileFailed;
       }
 
-      ERROR("Cannot decode song");
-      return error::kDecodeFileFailed;
+      // Receive frames from decoder
+      while (receive_frame() >= 0 && shared_context_.KeepDecoding()) {
+        // After seeking, frames before the requested position are dropped without being filtered
+        if (shared_context_.seeking && DiscardDecodedFrame()) {
+          shared_context_.ClearFrames();
+          continue;
+        }
+
+        // UI sent event to update audio filters with a different set of bands, so it is necessary
+        // to reset it. Otherwise, just move parameters from existing filters towards new values
+        if (shared_context_.reset_filters) {
+          shared_context_.err_code = ConfigureFilters();
+          shared_context_.reset_filters = false;
+          graph_rebuilds_++;
+        } else if (!dsp_ && !bypass_filters_) {
+          shared_context_.err_code = SmoothFilters();
+        }
+
+        // Pass decoded frame to be processed by filtergraph. And in case of error while processing
+        // frame, shared_context_.KeepDecoding() will return false, so do not worry about it
+        ProcessFrame(samples, callback);
+
+        shared_context_.ClearFrames();
+      }
+
+      shared_context_.ClearPacket();
     }
 
-    // Receive frames from decoder
-    while (avcodec_receive_frame(decoder_.get(), frame) >= 0 && shared_context_.KeepDecoding()) {
-      // Note that AVPacket.pts is in AVStream.time_base units, not AVCodecContext.time_base units
-      shared_context_.position = packet->pts / shared_context_.time_base.den;
+    // Reached the end of input stream, so drain frames still buffered by decoder and filtergraph
+    // (otherwise, last samples from song would be lost and next song would not be contiguous)
+    if (shared_context_.KeepDecoding()) {
+      avcodec_send_packet(decoder_.get(), nullptr);
 
-      // UI sent event to update audio filters with new parameters, so it is necessary to reset it
-      if (shared_context_.reset_filters) {
-        shared_context_.err_code = ConfigureFilters();
-        shared_context_.reset_filters = false;
+      while (avcodec_receive_frame(decoder_.get(), frame) >= 0 &&
+             shared_context_.KeepDecoding()) {
+        bool decode = !shared_context_.seeking || !DiscardDecodedFrame();
+        if (decode && ProcessFrame(samples, callback)) rewind = true;
+        shared_context_.ClearFrames();
       }
+    }
 
-      // Pass decoded frame to be processed by filtergraph. And in case of error while processing
-      // frame, shared_context_.KeepDecoding() will return false, so do not worry about it
-      ProcessFrame(samples, callback);
+    // User may still seek while the last samples are played, so read input stream again from there
+    if (!rewind && shared_context_.KeepDecoding() && FlushFilters(samples, callback)) {
+      SeekPosition();
 
-      shared_context_.ClearFrames();
+      // Filtergraph has already reached its end of stream, so it must be created again
+      shared_context_.reset_filters = true;
+      rewind = true;
     }
+  } while (rewind && shared_context_.KeepDecoding());
 
-    shared_context_.ClearPacket();
-  }
+  // Song was decoded from beginning to end, so it can be played from cache next time
+  if (cache_writer_ && shared_context_.KeepDecoding()) cache_->Store(std::move(cache_writer_));
+  cache_writer_.reset();
 
   return shared_context_.err_code;
 }
 
 /* ********************************************************************************************** */
 
+error::Code FFmpeg::DecodeCachedSong(int samples, AudioCallback &callback) {
+  LOG("Decode song from cache using maximum sample=", samples);
+
+  // Buffers only grow, so after the first song there is no more allocation
+  size_t size = static_cast<size_t>(samples) * kChannels;
+  if (cache_output_.size() < size) cache_output_.resize(size);
+  if (dsp_output_.size() < size) dsp_output_.resize(size);
+
+  DspChain *dsp = dsp_ ? dsp_.get() : cache_dsp_.get();
+  int64_t position = 0;
+  bool keep_playing = true;
+
+  cached_song_->Seek(0);
+
+  while (keep_playing) {
+    int frames = cached_song_->Read(cache_output_.data(), samples);
+    if (frames == 0) break;
+
+    float *buffer = cache_output_.data();
+
+    // Samples were stored without volume and equalizer, so these are applied only when needed
+    if (!CanBypassFilters()) {
+      dsp->Process(buffer, dsp_output_.data(), frames);
+      buffer = dsp_output_.data();
+    }
+
+    int64_t requested = position;
+    keep_playing = callback(buffer, frames, requested);
+
+    if (requested == position) {
+      position += frames;
+      continue;
+    }
+
+    // As samples are stored without compression, seeking is exact and does not decode anything
+    LOG("Seek cached song to position=", requested);
+    position = std::clamp<int64_t>(requested, 0, cached_song_->GetFrames());
+    cached_song_->Seek(position);
+    dsp->Reset();
+  }
+
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
 void FFmpeg::ClearCache() {
   LOG("Clear internal cache");
-  // Decoding
+  // Decoding (input stream must be released before the custom I/O reading from it)
   input_stream_.reset();
+  io_context_.reset();
+  mapped_file_.reset();
   decoder_.reset();
   stream_index_ = 0;
 
@@ -547,8 +863,15 @@ void FFmpeg::ClearCache() {
   buffersrc_ctx_.reset();
   buffersink_ctx_.reset();
 
+  // Cache (writer is dropped, as song was not decoded until the end)
+  cached_song_.reset();
+  cache_writer_.reset();
+  cache_dsp_.reset();
+
   // Custom data for audio filters
   audio_filters_.clear();
+  applied_filters_.clear();
+  if (dsp_) dsp_->ClearFilters();
 
   // Clear internal structure used for sharing context
   shared_context_ = DecodingData{};
@@ -563,6 +886,21 @@ error::Code FFmpeg::SetVolume(model::Volume value) {
   LOG("Set volume to new value=", value);
   volume_ = value;
 
+  if (cache_dsp_) cache_dsp_->SetVolume(volume_);
+
+  // Filters were bypassed but volume is not neutral anymore, so filtergraph must be recreated
+  if (filter_graph_ && bypass_filters_) {
+    if (!CanBypassFilters()) shared_context_.reset_filters = true;
+    if (dsp_) dsp_->SetVolume(volume_);
+    return error::kSuccess;
+  }
+
+  // Native DSP backend applies volume by itself
+  if (dsp_) {
+    dsp_->SetVolume(volume_);
+    return error::kSuccess;
+  }
+
   // Filtergraph is not created yet and there is no need to do anything further
   if (!filter_graph_) return error::kSuccess;
 
@@ -589,9 +927,7 @@ model::Volume FFmpeg::GetVolume() const { return volume_; }
 
 error::Code FFmpeg::UpdateFilters(const model::EqualizerPreset &filters) {
   LOG("Update audio filters in the internal structure");
-
-  // Clear internal structure
-  audio_filters_.clear();
+  std::map<FilterName, model::AudioFilter, std::less<>> updated;
 
   for (const auto &filter : filters) {
     if (filter.frequency == 0 || filter.Q == 0) {
@@ -600,18 +936,86 @@ error::Code FFmpeg::UpdateFilters(const model::EqualizerPreset &filters) {
     }
 
     std::string name{filter.GetName()};
-    audio_filters_[name] = filter;
+    updated[name] = filter;
   }
 
-  // In case that music is playing, must reset filter graph
-  if (filter_graph_) shared_context_.reset_filters = true;
+  // As filter name is based on its frequency, compare only names to know if there is some band
+  // added/removed/moved, compared to the filters currently existing in the filtergraph
+  bool same_bands =
+      std::equal(updated.begin(), updated.end(), audio_filters_.begin(), audio_filters_.end(),
+                 [](const auto &lhs, const auto &rhs) { return lhs.first == rhs.first; });
+
+  audio_filters_.swap(updated);
+
+  if (cache_dsp_) cache_dsp_->UpdateFilters(filters);
+
+  // Filters were bypassed but equalizer is not flat anymore, so filtergraph must be recreated
+  if (filter_graph_ && bypass_filters_ && !CanBypassFilters()) shared_context_.reset_filters = true;
+
+  // Native DSP backend only recalculates coefficients, no matter if bands have changed
+  if (dsp_) {
+    dsp_->UpdateFilters(filters);
+    applied_filters_ = audio_filters_;
+    return error::kSuccess;
+  }
+
+  // In case that music is playing with a different set of bands, must reset filter graph.
+  // Otherwise, new parameters are smoothly applied by the decoding loop in the next frames
+  if (filter_graph_ && !same_bands) shared_context_.reset_filters = true;
 
   return error::kSuccess;
 }
 
 /* ********************************************************************************************** */
 
-void FFmpeg::ProcessFrame(int samples, AudioCallback &callback) {
+error::Code FFmpeg::SmoothFilters() {
+  for (auto &[name, applied] : applied_filters_) {
+    auto target = audio_filters_.find(name);
+    if (target == audio_filters_.end() || applied == target->second) continue;
+
+    // Limit gain change per frame, so it sounds like a ramp instead of a step
+    double delta = target->second.gain - applied.gain;
+    applied.gain = std::abs(delta) <= kMaxGainStep
+                       ? target->second.gain
+                       : applied.gain + std::copysign(kMaxGainStep, delta);
+
+    if (error::Code result = SendEqualizerCommand(name, "gain", applied.gain);
+        result != error::kSuccess) {
+      return result;
+    }
+
+    if (applied.Q != target->second.Q) {
+      applied.Q = target->second.Q;
+
+      if (error::Code result = SendEqualizerCommand(name, "width", applied.Q);
+          result != error::kSuccess) {
+        return result;
+      }
+    }
+  }
+
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+error::Code FFmpeg::SendEqualizerCommand(const std::string &name, const char *command,
+                                         double value) {
+  std::string arg = std::to_string(value);
+
+  if (std::string response(kResponseSize, ' ');
+      avfilter_graph_send_command(filter_graph_.get(), name.c_str(), command, arg.c_str(),
+                                  response.data(), kResponseSize, 0) < 0) {
+    ERROR("Cannot set new value for equalizer filter (", name, "), error=", response);
+    return error::kUnknownError;
+  }
+
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+bool FFmpeg::ProcessFrame(int samples, AudioCallback &callback) {
   // Get source and sink
   AVFilterContext *source = buffersrc_ctx_.get();
   AVFilterContext *sink = buffersink_ctx_.get();
@@ -624,28 +1028,24 @@ void FFmpeg::ProcessFrame(int samples, AudioCallback &callback) {
   if (av_buffersrc_add_frame_flags(source, decoded, AV_BUFFERSRC_FLAG_KEEP_REF) < 0) {
     ERROR("Cannot feed audio filtergraph");
     shared_context_.err_code = error::kDecodeFileFailed;
-    return;
+    return false;
   }
 
   int result;
   bool seek_frame = false;
-  int64_t old_position = shared_context_.position;
 
   // Pull filtered audio from the filtergraph
-  while ((result = av_buffersink_get_samples(sink, filtered, samples)) >= 0 &&
+  while ((result = TRACE_CALL("av_buffersink_get_samples",
+                              av_buffersink_get_samples(sink, filtered, samples))) >= 0 &&
          shared_context_.KeepDecoding()) {
     // Send filtered audio data to Player
-    shared_context_.keep_playing = callback(static_cast<void *>(filtered->data[0]),
-                                            filtered->nb_samples, shared_context_.position);
+    seek_frame = SendOutputSamples(filtered, callback);
 
     // Clear frame from filtergraph
     av_frame_unref(filtered);
 
     // Check if EQ has updated or song position has changed
-    if (shared_context_.reset_filters || shared_context_.position != old_position) {
-      seek_frame = shared_context_.position != old_position;
-      break;
-    }
+    if (shared_context_.reset_filters || seek_frame) break;
   }
 
   // Check if got some critical error
@@ -655,21 +1055,182 @@ void FFmpeg::ProcessFrame(int samples, AudioCallback &callback) {
   }
 
   // Seek new position in song
-  if (shared_context_.KeepDecoding() && seek_frame) {
-    // Clear internal buffers
-    shared_context_.ClearFrames();
-    avcodec_flush_buffers(decoder_.get());
-
-    // Recalculate new position
-    int64_t target = av_rescale_q(shared_context_.position * AV_TIME_BASE, AV_TIME_BASE_Q,
-                                  shared_context_.time_base);
-
-    // Seek new frame
-    if (av_seek_frame(input_stream_.get(), stream_index_, target, AVSEEK_FLAG_BACKWARD) < 0) {
-      ERROR("Cannot seek frame in song");
-      shared_context_.err_code = error::kSeekFrameFailed;
-    }
+  if (!shared_context_.KeepDecoding() || !seek_frame) return false;
+
+  SeekPosition();
+  return true;
+}
+
+/* ********************************************************************************************** */
+
+bool FFmpeg::SendOutputSamples(AVFrame *filtered, AudioCallback &callback) {
+  if (cache_writer_) StoreOutputSamples(filtered);
+
+  auto buffer = static_cast<float *>(GetOutputSamples(filtered));
+  int size = filtered->nb_samples;
+
+  // After seeking, skip samples until reaching exactly the requested position
+  if (int64_t skip = shared_context_.seek_target - shared_context_.position; skip > 0) {
+    skip = std::min<int64_t>(skip, size);
+
+    shared_context_.position += skip;
+    buffer += skip * kChannels;
+    size -= static_cast<int>(skip);
+
+    if (size == 0) return false;
+  }
+
+  int64_t position = shared_context_.position;
+  shared_context_.keep_playing = callback(buffer, size, shared_context_.position);
+
+  // Callback has changed position, so it is not related to these samples anymore
+  if (shared_context_.position != position) return true;
+
+  shared_context_.position += size;
+  return false;
+}
+
+/* ********************************************************************************************** */
+
+void FFmpeg::StoreOutputSamples(AVFrame *filtered) {
+  // Samples must be exactly the same as decoded, and contiguous to the ones already written
+  bool unprocessed = dsp_ || bypass_filters_;
+  bool contiguous = cache_writer_->GetFrames() == shared_context_.position &&
+                    shared_context_.seek_target <= shared_context_.position;
+
+  auto samples = reinterpret_cast<const float *>(filtered->data[0]);
+  if (unprocessed && contiguous && cache_writer_->Write(samples, filtered->nb_samples)) return;
+
+  // Writer is dropped right away, so this is logged only once for each song
+  if (!unprocessed) {
+    LOG("Song is not stored into cache, as filtergraph applies volume and equalizer to samples, "
+        "volume=", volume_, " passthrough=", passthrough_);
+  } else {
+    LOG("Stop writing decoded song into cache, contiguous=", contiguous);
   }
+
+  cache_writer_.reset();
+}
+
+/* ********************************************************************************************** */
+
+void FFmpeg::SeekPosition() {
+  LOG("Seek song to position=", shared_context_.position);
+
+  // Clear internal buffers
+  shared_context_.ClearFrames();
+  avcodec_flush_buffers(decoder_.get());
+
+  // Samples still kept by filtergraph belong to the old position, so they must not be played
+  AVFrame *filtered = shared_context_.frame_filtered.get();
+  while (av_buffersink_get_frame(buffersink_ctx_.get(), filtered) >= 0) av_frame_unref(filtered);
+
+  if (dsp_) dsp_->Reset();
+
+  // Convert position from output samples to input stream timestamp
+  int64_t target = shared_context_.start_time +
+                   av_rescale_q(shared_context_.position, AVRational{1, sample_rate_},
+                                shared_context_.time_base);
+
+  // Input stream is moved to the closest frame before target (usually a keyframe)
+  if (av_seek_frame(input_stream_.get(), stream_index_, target, AVSEEK_FLAG_BACKWARD) < 0) {
+    ERROR("Cannot seek frame in song");
+    shared_context_.err_code = error::kSeekFrameFailed;
+    return;
+  }
+
+  // So samples are decoded forward and discarded until reaching the exact position
+  shared_context_.seek_target = shared_context_.position;
+  shared_context_.seeking = true;
+}
+
+/* ********************************************************************************************** */
+
+bool FFmpeg::DiscardDecodedFrame() {
+  AVFrame *frame = shared_context_.frame_decoded.get();
+
+  // Without timestamp, there is no way to tell where frame is, so consider that seek was exact
+  if (frame->best_effort_timestamp == AV_NOPTS_VALUE) {
+    shared_context_.seeking = false;
+    return false;
+  }
+
+  // Convert frame boundaries from input stream timestamp to output samples
+  int64_t begin = av_rescale_q(frame->best_effort_timestamp - shared_context_.start_time,
+                               shared_context_.time_base, AVRational{1, sample_rate_});
+  int64_t end = begin + av_rescale(frame->nb_samples, sample_rate_, frame->sample_rate);
+
+  if (end <= shared_context_.seek_target) return true;
+
+  // Position is counted from here, and samples before target are skipped after being filtered
+  shared_context_.position = begin;
+  shared_context_.seeking = false;
+  return false;
+}
+
+/* ********************************************************************************************** */
+
+void *FFmpeg::GetOutputSamples(AVFrame *filtered) {
+  if (!dsp_ || bypass_filters_) return static_cast<void *>(filtered->data[0]);
+
+  // Output buffer only grows, so after the first frames there is no more allocation
+  size_t size = static_cast<size_t>(filtered->nb_samples) * kChannels;
+  if (dsp_output_.size() < size) dsp_output_.resize(size);
+
+  dsp_->Process(reinterpret_cast<const float *>(filtered->data[0]), dsp_output_.data(),
+                filtered->nb_samples);
+
+  return static_cast<void *>(dsp_output_.data());
+}
+
+/* ********************************************************************************************** */
+
+std::unique_ptr<DspChain> FFmpeg::CreateDspChain(DspChain::Kernel kernel) const {
+  auto dsp = std::make_unique<DspChain>(kChannels, sample_rate_, kernel);
+  dsp->SetVolume(volume_);
+
+  // Filters are kept sorted by name, but only the complete preset is accepted by DspChain
+  if (model::EqualizerPreset filters; audio_filters_.size() == filters.size()) {
+    std::transform(audio_filters_.begin(), audio_filters_.end(), filters.begin(),
+                   [](const auto &entry) { return entry.second; });
+    dsp->UpdateFilters(filters);
+  }
+
+  return dsp;
+}
+
+/* ********************************************************************************************** */
+
+bool FFmpeg::CanBypassFilters() const {
+  if (!passthrough_ || static_cast<float>(volume_) != 1.f) return false;
+
+  return std::all_of(audio_filters_.begin(), audio_filters_.end(),
+                     [](const auto &entry) { return entry.second.gain == 0; });
+}
+
+/* ********************************************************************************************** */
+
+bool FFmpeg::FlushFilters(int samples, AudioCallback &callback) {
+  AVFilterContext *sink = buffersink_ctx_.get();
+  AVFrame *filtered = shared_context_.frame_filtered.get();
+
+  // Mark end of stream in the filtergraph, so it releases all samples kept internally
+  if (av_buffersrc_add_frame_flags(buffersrc_ctx_.get(), nullptr, 0) < 0) {
+    ERROR("Cannot flush audio filtergraph");
+    return false;
+  }
+
+  // Pull remaining filtered audio (the last one may contain less samples than requested)
+  while (shared_context_.KeepDecoding() &&
+         av_buffersink_get_samples(sink, filtered, samples) >= 0) {
+    bool seek_frame = SendOutputSamples(filtered, callback);
+    av_frame_unref(filtered);
+
+    // Song position has changed, so remaining samples are not played anymore
+    if (seek_frame) return true;
+  }
+
+  return false;
 }
 
 }  // namespace driver
@@ -1,9 +1,12 @@
 #include "audio/driver/fftw.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <iostream>
 
+#include "util/tracer.h"
+
 namespace driver {
 
 error::Code FFTW::Init(int output_size) {
@@ -46,6 +49,7 @@ error::Code FFTW::Init(int output_size) {
 /* ********************************************************************************************** */
 
 error::Code FFTW::Execute(double* in, int size, double* out) {
+  TRACE_SCOPE("FFTW::Execute");
   std::scoped_lock lock(mutex_);
   int silence = 1;
 
@@ -68,6 +72,36 @@ error::Code FFTW::Execute(double* in, int size, double* out) {
 
 /* ********************************************************************************************** */
 
+int FFTW::GetBufferSize() {
+  std::scoped_lock lock(mutex_);
+  return std::clamp(period_size_ * kNumberChannels, kBufferSize, kMaxInputSize);
+}
+
+/* ********************************************************************************************** */
+
+void FFTW::SetPeriodSize(int size) {
+  std::scoped_lock lock(mutex_);
+  period_size_ = size;
+}
+
+/* ********************************************************************************************** */
+
+void FFTW::SetSampleRate(int sample_rate) {
+  std::scoped_lock lock(mutex_);
+  if (sample_rate <= 0 || sample_rate == sample_rate_) return;
+
+  sample_rate_ = sample_rate;
+
+  // Same bars represent other FFT bins now (nothing to do if Init was not called yet)
+  if (cut_off_freq_.empty()) return;
+
+  std::fill(lower_cut_off_per_bar_.begin(), lower_cut_off_per_bar_.end(), 0);
+  std::fill(upper_cut_off_per_bar_.begin(), upper_cut_off_per_bar_.end(), 0);
+  CalculateFrequencies();
+}
+
+/* ********************************************************************************************** */
+
 void FFTW::CreateHannWindow(FreqAnalysis& analysis) {
   analysis.multiplier.reset(fftw_alloc_real(analysis.buffer_size));
 
@@ -155,7 +189,7 @@ void FFTW::CalculateFrequencies() {
     }
 
     // Nyquist frequency
-    relative_cut_off[n] = cut_off_freq_[n] / ((float)kSampleRate / 2);
+    relative_cut_off[n] = cut_off_freq_[n] / ((float)sample_rate_ / 2);
 
     // Numbers that come out of the FFT are very high, so the equalizer is used to "normalize" them
     // by dividing with also a very huge number
@@ -249,7 +283,7 @@ void FFTW::CalculateFrequencies() {
                 break;
             }
 
-            cut_off_freq_[n] = relative_cut_off[n] * ((float)kSampleRate / 2);
+            cut_off_freq_[n] = relative_cut_off[n] * ((float)sample_rate_ / 2);
           }
         }
       } else {
@@ -267,7 +301,7 @@ void FFTW::FillInputBuffer(double* in, int& size, int& silence) {
 
   if (size > 0) {
     frame_rate_ -= frame_rate_ / 64;
-    frame_rate_ += (double)((float)(kSampleRate * kNumberChannels * frame_skip_) / size) / 64;
+    frame_rate_ += (double)((float)(sample_rate_ * kNumberChannels * frame_skip_) / size) / 64;
     frame_skip_ = 1;
 
     // Shifting input buffer
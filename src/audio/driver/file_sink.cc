@@ -0,0 +1,176 @@
+#include "audio/driver/file_sink.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "util/logger.h"
+
+namespace driver {
+
+namespace {
+
+//! Write unsigned integer into file (WAV fields are always little-endian)
+template <typename T>
+void PutLittleEndian(std::ofstream& file, T value) {
+  for (size_t i = 0; i < sizeof(T); i++) file.put(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+}  // namespace
+
+/* ********************************************************************************************** */
+
+FileSink::~FileSink() {
+  if (!file_.is_open()) return;
+
+  if (container_ == Container::Wav) WriteHeader();
+  LOG("Close output file with frames=", frames_.load(), " path=", path_);
+}
+
+/* ********************************************************************************************** */
+
+error::Code FileSink::CreatePlaybackStream() {
+  LOG("Create output file with path=", path_, " container=", static_cast<int>(container_));
+
+  file_.open(path_, std::ios::binary | std::ios::trunc);
+  if (!file_) {
+    ERROR("Cannot create output file");
+    return error::kUnknownError;
+  }
+
+  // Header is written again with the right sizes on every stop
+  if (container_ == Container::Wav) WriteHeader();
+
+  return file_ ? error::kSuccess : error::kUnknownError;
+}
+
+/* ********************************************************************************************** */
+
+bool FileSink::IsFormatSupported(const model::AudioFormat& format) {
+  if (format.floating_point || (format.bit_depth != 16 && format.bit_depth != 32)) return false;
+  if (format.sample_rate == 0 || format.channels == 0) return false;
+
+  // Samples with different formats cannot be mixed in the same file
+  return frames_ == 0 || format == format_;
+}
+
+/* ********************************************************************************************** */
+
+error::Code FileSink::SetFormat(const model::AudioFormat& format) {
+  if (format == format_) return error::kSuccess;
+
+  if (!IsFormatSupported(format)) {
+    ERROR("Output file does not support format=", format, " (current format=", format_, ")");
+    return error::kSetupAudioParamsFailed;
+  }
+
+  LOG("Change format on output file from ", format_, " to ", format);
+  format_ = format;
+
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+error::Code FileSink::Stop() {
+  LOG("Stop writing into output file");
+
+  if (container_ == Container::Wav) WriteHeader();
+  file_.flush();
+
+  return file_ ? error::kSuccess : error::kUnknownError;
+}
+
+/* ********************************************************************************************** */
+
+error::Code FileSink::AudioCallback(void* buffer, int size) {
+  // As this is called multiple times, LOG will not be called here in the beginning
+  const auto* input = static_cast<const float*>(buffer);
+  const size_t samples = static_cast<size_t>(size) * format_.channels;
+
+  const char* output = nullptr;
+  size_t length = 0;
+
+  // Conversion buffers only grow, so after the first periods there is no more allocation
+  if (format_.bit_depth == 32) {
+    if (output_s32_.size() < samples) output_s32_.resize(samples);
+    converter_.Convert(input, output_s32_.data(), samples);
+
+    output = reinterpret_cast<const char*>(output_s32_.data());
+    length = samples * sizeof(int32_t);
+  } else {
+    if (output_s16_.size() < samples) output_s16_.resize(samples);
+    converter_.Convert(input, output_s16_.data(), samples);
+
+    output = reinterpret_cast<const char*>(output_s16_.data());
+    length = samples * sizeof(int16_t);
+  }
+
+  if (!file_.write(output, static_cast<std::streamsize>(length))) {
+    ERROR("Cannot write samples into output file");
+    return error::kUnknownError;
+  }
+
+  data_size_ += length;
+  frames_ += size;
+
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+error::Code FileSink::SetVolume(model::Volume value) {
+  std::scoped_lock lock(mutex_);
+  volume_ = value;
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+model::Volume FileSink::GetVolume() {
+  std::scoped_lock lock(mutex_);
+  return volume_;
+}
+
+/* ********************************************************************************************** */
+
+Playback::Statistics FileSink::GetStatistics() const {
+  Statistics statistics;
+  statistics.frames = frames_;
+  statistics.copied_frames = frames_;
+
+  return statistics;
+}
+
+/* ********************************************************************************************** */
+
+void FileSink::WriteHeader() {
+  // Sizes are limited to 32 bits, so a longer file keeps playing but its header saturates
+  constexpr uint64_t kMaxSize = std::numeric_limits<uint32_t>::max() - kHeaderSize;
+  auto data_size = static_cast<uint32_t>(std::min(data_size_, kMaxSize));
+
+  uint16_t block_align = static_cast<uint16_t>(format_.channels * format_.bit_depth / 8);
+  auto position = file_.tellp();
+  file_.seekp(0);
+
+  file_.write("RIFF", 4);
+  PutLittleEndian<uint32_t>(file_, kHeaderSize - 8 + data_size);
+  file_.write("WAVE", 4);
+
+  // Format chunk for integer PCM
+  file_.write("fmt ", 4);
+  PutLittleEndian<uint32_t>(file_, 16);
+  PutLittleEndian<uint16_t>(file_, 1);
+  PutLittleEndian<uint16_t>(file_, format_.channels);
+  PutLittleEndian<uint32_t>(file_, format_.sample_rate);
+  PutLittleEndian<uint32_t>(file_, format_.sample_rate * block_align);
+  PutLittleEndian<uint16_t>(file_, block_align);
+  PutLittleEndian<uint16_t>(file_, format_.bit_depth);
+
+  file_.write("data", 4);
+  PutLittleEndian<uint32_t>(file_, data_size);
+
+  // Header is written before any sample, so position only matters when rewriting it
+  if (position > 0) file_.seekp(position);
+}
+
+}  // namespace driver
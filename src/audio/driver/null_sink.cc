@@ -0,0 +1,112 @@
+#include "audio/driver/null_sink.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "util/logger.h"
+
+namespace driver {
+
+NullSink::~NullSink() {
+  if (frames_ > 0) LOG("Null sink consumed audio at ", GetRealtimeFactor(), "x real-time");
+}
+
+/* ********************************************************************************************** */
+
+error::Code NullSink::CreatePlaybackStream() {
+  LOG("Create null sink with paced=", paced_);
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+bool NullSink::IsFormatSupported(const model::AudioFormat& format) {
+  return format.sample_rate > 0 && format.channels > 0;
+}
+
+/* ********************************************************************************************** */
+
+error::Code NullSink::SetFormat(const model::AudioFormat& format) {
+  if (!IsFormatSupported(format)) return error::kSetupAudioParamsFailed;
+
+  LOG("Change format on null sink from ", format_, " to ", format);
+  format_ = format;
+
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+error::Code NullSink::Prepare() {
+  deadline_ = Clock::now();
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+error::Code NullSink::Resume() {
+  // Time spent paused must not be caught up
+  deadline_ = Clock::now();
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+error::Code NullSink::AudioCallback(void* buffer, int size) {
+  // As this is called multiple times, LOG will not be called here in the beginning
+  auto now = Clock::now();
+  auto duration = std::chrono::duration<double>(static_cast<double>(size) / format_.sample_rate);
+
+  {
+    std::scoped_lock lock(mutex_);
+    if (frames_ == 0) started_ = now;
+    audio_seconds_ += duration.count();
+  }
+
+  frames_ += size;
+
+  if (paced_) {
+    // Writer is blocked until these samples would be played (restarting from now whenever writer
+    // falls behind, as a device would underrun)
+    deadline_ = std::max(deadline_, now) + std::chrono::duration_cast<Clock::duration>(duration);
+    std::this_thread::sleep_until(deadline_);
+  }
+
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+error::Code NullSink::SetVolume(model::Volume value) {
+  std::scoped_lock lock(mutex_);
+  volume_ = value;
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+model::Volume NullSink::GetVolume() {
+  std::scoped_lock lock(mutex_);
+  return volume_;
+}
+
+/* ********************************************************************************************** */
+
+Playback::Statistics NullSink::GetStatistics() const {
+  Statistics statistics;
+  statistics.frames = frames_;
+
+  return statistics;
+}
+
+/* ********************************************************************************************** */
+
+double NullSink::GetRealtimeFactor() const {
+  std::scoped_lock lock(mutex_);
+  if (frames_ == 0) return 0;
+
+  std::chrono::duration<double> elapsed = Clock::now() - started_;
+  return elapsed.count() > 0 ? audio_seconds_ / elapsed.count() : 0;
+}
+
+}  // namespace driver
@@ -0,0 +1,368 @@
+#include "audio/driver/pcm_cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "util/logger.h"
+
+namespace driver {
+
+namespace {
+
+//! Entry file layout, with all fields in native byte order (cache is not shared between machines):
+//! magic | version | sample rate | channels | frames | song metadata | padding | float samples
+struct SongHeader {
+  uint32_t num_channels;
+  uint32_t sample_rate;
+  uint32_t bit_rate;
+  uint32_t bit_depth;
+  uint32_t duration;
+};
+
+//! Write field into entry file
+template <typename T>
+void Put(std::ofstream& file, const T& value) {
+  file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+//! Write string into entry file (prefixed by its size)
+void PutString(std::ofstream& file, const std::string& value) {
+  Put(file, static_cast<uint32_t>(value.size()));
+  file.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+//! Read field from entry file
+template <typename T>
+bool Get(util::MappedFile& file, T& value) {
+  return file.Read(reinterpret_cast<uint8_t*>(&value), sizeof(T)) == sizeof(T);
+}
+
+//! Read string from entry file (prefixed by its size)
+bool GetString(util::MappedFile& file, std::string& value) {
+  uint32_t size = 0;
+  if (!Get(file, size) || size > file.GetSize() - file.GetPosition()) return false;
+
+  value.resize(size);
+  return file.Read(reinterpret_cast<uint8_t*>(value.data()), size) == size;
+}
+
+}  // namespace
+
+/* ********************************************************************************************** */
+
+PcmCache::PcmCache(const std::filesystem::path& directory, uintmax_t max_size)
+    : directory_{directory}, max_size_{max_size} {}
+
+/* ********************************************************************************************** */
+
+std::shared_ptr<PcmCache> PcmCache::Create(const std::filesystem::path& directory,
+                                           uintmax_t max_size) {
+  LOG("Create PCM cache with directory=", directory, " max_size=", max_size);
+
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+
+  if (error || !std::filesystem::is_directory(directory, error)) {
+    ERROR("Cannot use directory for PCM cache, error=", error.message());
+    return nullptr;
+  }
+
+  // Simply extend the PcmCache class, as we do not want to expose the default constructor
+  struct MakeSharedEnabler : public PcmCache {
+    MakeSharedEnabler(const std::filesystem::path& directory, uintmax_t max_size)
+        : PcmCache(directory, max_size) {}
+  };
+
+  return std::make_shared<MakeSharedEnabler>(directory, max_size);
+}
+
+/* ********************************************************************************************** */
+
+std::unique_ptr<PcmCache::Entry> PcmCache::Find(const std::string& filepath, int sample_rate) {
+  std::string filename = GetFilename(filepath, sample_rate);
+  if (filename.empty()) return nullptr;
+
+  std::scoped_lock lock(mutex_);
+  std::filesystem::path path = directory_ / filename;
+  std::error_code error;
+
+  if (!std::filesystem::is_regular_file(path, error)) {
+    LOG("PCM cache miss for filepath=", std::quoted(filepath), " sample_rate=", sample_rate);
+    return nullptr;
+  }
+
+  auto file = util::MappedFile::Create(path.string());
+
+  char magic[sizeof(kMagic) - 1];
+  uint32_t version = 0, rate = 0, channels = 0;
+  int64_t frames = 0;
+  SongHeader header{};
+  model::Song song{.filepath = filepath};
+
+  bool valid = file && Get(*file, magic) && Get(*file, version) && Get(*file, rate) &&
+               Get(*file, channels) && Get(*file, frames) && Get(*file, header) &&
+               GetString(*file, song.artist) && GetString(*file, song.title);
+
+  // Samples start right after metadata, on the next aligned offset
+  int64_t data_offset = 0;
+
+  if (valid) {
+    data_offset = (file->GetPosition() + kDataAlignment - 1) / kDataAlignment * kDataAlignment;
+    int64_t expected = data_offset + frames * kChannels * static_cast<int64_t>(sizeof(float));
+
+    valid = std::memcmp(magic, kMagic, sizeof(magic)) == 0 && version == kVersion &&
+            rate == static_cast<uint32_t>(sample_rate) && channels == kChannels && frames > 0 &&
+            file->GetSize() == expected;
+  }
+
+  if (!valid) {
+    ERROR("Invalid entry found in PCM cache, removing file=", filename);
+    file.reset();
+    std::filesystem::remove(path, error);
+    return nullptr;
+  }
+
+  song.num_channels = static_cast<uint16_t>(header.num_channels);
+  song.sample_rate = header.sample_rate;
+  song.bit_rate = header.bit_rate;
+  song.bit_depth = header.bit_depth;
+  song.duration = header.duration;
+
+  // Entry was just used, so it becomes the most recently used one
+  std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+
+  LOG("PCM cache hit for filepath=", std::quoted(filepath), " sample_rate=", sample_rate,
+      " frames=", frames);
+
+  auto entry = std::make_unique<Entry>(std::move(file), data_offset, song, sample_rate, frames);
+  entry->Seek(0);
+
+  return entry;
+}
+
+/* ********************************************************************************************** */
+
+std::unique_ptr<PcmCache::Writer> PcmCache::CreateWriter(const model::Song& song,
+                                                         int sample_rate) {
+  std::string filename = GetFilename(song.filepath, sample_rate);
+  if (filename.empty()) return nullptr;
+
+  std::scoped_lock lock(mutex_);
+
+  // Each writer has its own temporary file, even when the same song is decoded twice
+  std::filesystem::path temporary =
+      directory_ / (filename + "." + std::to_string(writers_++) + ".tmp");
+
+  auto max_frames = static_cast<int64_t>(max_size_ / (kChannels * sizeof(float)));
+
+  auto writer = std::make_unique<Writer>(directory_ / filename, temporary, song, sample_rate,
+                                         max_frames);
+
+  if (!writer->file_) {
+    ERROR("Cannot create temporary file for PCM cache entry");
+    return nullptr;
+  }
+
+  return writer;
+}
+
+/* ********************************************************************************************** */
+
+bool PcmCache::Store(std::unique_ptr<Writer>&& writer) {
+  if (!writer || writer->frames_ == 0) return false;
+
+  // Number of frames is only known after decoding the whole song
+  writer->file_.seekp(kFramesOffset);
+  Put(writer->file_, writer->frames_);
+  writer->file_.close();
+
+  if (writer->file_.fail()) {
+    ERROR("Cannot write PCM cache entry for filepath=", std::quoted(writer->song_.filepath));
+    return false;
+  }
+
+  std::scoped_lock lock(mutex_);
+  std::error_code error;
+
+  std::filesystem::rename(writer->temporary_, writer->filepath_, error);
+  if (error) {
+    ERROR("Cannot store PCM cache entry, error=", error.message());
+    return false;
+  }
+
+  LOG("Stored song into PCM cache with filepath=", std::quoted(writer->song_.filepath),
+      " frames=", writer->frames_);
+
+  // Temporary file does not exist anymore
+  writer->temporary_.clear();
+
+  Evict();
+  return true;
+}
+
+/* ********************************************************************************************** */
+
+std::string PcmCache::GetFilename(const std::string& filepath, int sample_rate) {
+  std::error_code error;
+  auto size = std::filesystem::file_size(filepath, error);
+  if (error) return std::string{};
+
+  auto modified = std::filesystem::last_write_time(filepath, error);
+  if (error) return std::string{};
+
+  std::ostringstream key;
+  key << filepath << '\n' << modified.time_since_epoch().count() << '\n' << size << '\n'
+      << sample_rate;
+
+  // FNV-1a hash, as it must be stable between executions (unlike std::hash)
+  uint64_t hash = 0xcbf29ce484222325;
+  for (char c : key.str()) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 0x100000001b3;
+  }
+
+  std::ostringstream filename;
+  filename << std::hex << std::setw(16) << std::setfill('0') << hash << kExtension;
+
+  return filename.str();
+}
+
+/* ********************************************************************************************** */
+
+void PcmCache::Evict() {
+  struct Candidate {
+    std::filesystem::path path;
+    uintmax_t size;
+    std::filesystem::file_time_type last_used;
+  };
+
+  std::vector<Candidate> entries;
+  uintmax_t total = 0;
+  std::error_code error;
+
+  for (auto it = std::filesystem::directory_iterator(directory_, error);
+       !error && it != std::filesystem::directory_iterator(); it.increment(error)) {
+    if (it->path().extension() != kExtension) continue;
+
+    uintmax_t size = it->file_size(error);
+    if (error) continue;
+
+    auto last_used = it->last_write_time(error);
+    if (error) continue;
+
+    total += size;
+    entries.push_back(Candidate{.path = it->path(), .size = size, .last_used = last_used});
+  }
+
+  if (total <= max_size_) return;
+
+  // Least recently used entries come first
+  std::sort(entries.begin(), entries.end(), [](const Candidate& lhs, const Candidate& rhs) {
+    return lhs.last_used < rhs.last_used;
+  });
+
+  for (const auto& entry : entries) {
+    if (total <= max_size_) break;
+
+    if (std::filesystem::remove(entry.path, error)) {
+      LOG("Evicted entry from PCM cache, file=", entry.path.filename(), " size=", entry.size);
+      total -= entry.size;
+    }
+  }
+}
+
+/* ********************************************************************************************** */
+
+PcmCache::Entry::Entry(std::unique_ptr<util::MappedFile>&& file, int64_t data_offset,
+                       const model::Song& song, int sample_rate, int64_t frames)
+    : file_{std::move(file)},
+      data_offset_{data_offset},
+      song_{song},
+      sample_rate_{sample_rate},
+      frames_{frames} {}
+
+/* ********************************************************************************************** */
+
+int PcmCache::Entry::Read(float* buffer, int frames) {
+  constexpr size_t kFrameSize = kChannels * sizeof(float);
+
+  size_t length = file_->Read(reinterpret_cast<uint8_t*>(buffer), frames * kFrameSize);
+  return static_cast<int>(length / kFrameSize);
+}
+
+/* ********************************************************************************************** */
+
+bool PcmCache::Entry::Seek(int64_t frame) {
+  if (frame < 0 || frame > frames_) return false;
+
+  int64_t offset = data_offset_ + frame * kChannels * static_cast<int64_t>(sizeof(float));
+  return file_->Seek(offset, SEEK_SET) == offset;
+}
+
+/* ********************************************************************************************** */
+
+PcmCache::Writer::Writer(const std::filesystem::path& filepath,
+                         const std::filesystem::path& temporary, const model::Song& song,
+                         int sample_rate, int64_t max_frames)
+    : filepath_{filepath},
+      temporary_{temporary},
+      file_{temporary, std::ios::binary | std::ios::trunc},
+      song_{song},
+      sample_rate_{sample_rate},
+      max_frames_{max_frames} {
+  if (!file_) return;
+
+  SongHeader header{
+      .num_channels = song.num_channels,
+      .sample_rate = song.sample_rate,
+      .bit_rate = song.bit_rate,
+      .bit_depth = song.bit_depth,
+      .duration = song.duration,
+  };
+
+  // Number of frames is written again when entry is stored
+  file_.write(kMagic, sizeof(kMagic) - 1);
+  Put(file_, kVersion);
+  Put(file_, static_cast<uint32_t>(sample_rate));
+  Put(file_, kChannels);
+  Put(file_, frames_);
+  Put(file_, header);
+  PutString(file_, song.artist);
+  PutString(file_, song.title);
+
+  // Pad metadata, so samples are aligned when file is mapped into memory
+  auto size = static_cast<int64_t>(file_.tellp());
+  std::vector<char> padding(static_cast<size_t>(-size & (kDataAlignment - 1)));
+  file_.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+}
+
+/* ********************************************************************************************** */
+
+PcmCache::Writer::~Writer() {
+  if (temporary_.empty()) return;
+
+  file_.close();
+
+  std::error_code error;
+  std::filesystem::remove(temporary_, error);
+}
+
+/* ********************************************************************************************** */
+
+bool PcmCache::Writer::Write(const float* samples, int frames) {
+  if (!file_ || frames_ + frames > max_frames_) return false;
+
+  file_.write(reinterpret_cast<const char*>(samples),
+              static_cast<std::streamsize>(frames * kChannels * sizeof(float)));
+
+  frames_ += frames;
+  return static_cast<bool>(file_);
+}
+
+}  // namespace driver
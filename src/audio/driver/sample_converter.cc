@@ -0,0 +1,57 @@
+#include "audio/driver/sample_converter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace driver {
+
+void SampleConverter::Convert(const float* input, int16_t* output, size_t size) {
+  constexpr float kMin = std::numeric_limits<int16_t>::min();
+  constexpr float kMax = std::numeric_limits<int16_t>::max();
+
+  for (size_t i = 0; i < size; i++) {
+    float sample = input[i] * kScaleS16;
+
+    // Only samples with a fractional part would be affected by rounding
+    if (dither_ && sample != std::nearbyint(sample)) sample += NextDither();
+
+    output[i] = static_cast<int16_t>(std::lrint(std::clamp(sample, kMin, kMax)));
+  }
+}
+
+/* ********************************************************************************************** */
+
+void SampleConverter::Convert(const float* input, int32_t* output, size_t size, int bit_depth) {
+  const double scale = std::ldexp(1., bit_depth - 1);
+  const double min = -scale;
+  const double max = scale - 1;
+
+  for (size_t i = 0; i < size; i++) {
+    double sample = std::clamp(static_cast<double>(input[i]) * scale, min, max);
+    output[i] = static_cast<int32_t>(std::lrint(sample));
+  }
+}
+
+/* ********************************************************************************************** */
+
+void SampleConverter::Convert(const float* input, float* output, size_t size) {
+  for (size_t i = 0; i < size; i++) output[i] = std::clamp(input[i], -1.f, 1.f);
+}
+
+/* ********************************************************************************************** */
+
+float SampleConverter::NextDither() {
+  auto next = [this] {
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 17;
+    state_ ^= state_ << 5;
+    return static_cast<float>(state_) * kUniformScale;
+  };
+
+  // Difference between two uniform values in [0, 1) results in a triangular distribution
+  float first = next();
+  return first - next();
+}
+
+}  // namespace driver
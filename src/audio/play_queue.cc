@@ -0,0 +1,240 @@
+#include "audio/play_queue.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <numeric>
+
+#include "util/logger.h"
+
+namespace audio {
+
+void PlayQueue::Enqueue(const std::string& filepath) {
+  LOG("Enqueue song with filepath=", std::quoted(filepath));
+  std::scoped_lock lock(mutex_);
+  changes_++;
+
+  items_.push_back(filepath);
+  size_t index = items_.size() - 1;
+
+  if (!shuffle_) {
+    order_.push_back(index);
+    return;
+  }
+
+  // Pick any position after the current song, so it is not skipped in this round
+  size_t first = cursor_ ? *cursor_ + 1 : 0;
+  std::uniform_int_distribution<size_t> distribution(first, order_.size());
+  order_.insert(order_.begin() + static_cast<std::ptrdiff_t>(distribution(random_)), index);
+}
+
+/* ********************************************************************************************** */
+
+void PlayQueue::InsertNext(const std::string& filepath) {
+  LOG("Insert next song with filepath=", std::quoted(filepath));
+  std::scoped_lock lock(mutex_);
+  changes_++;
+
+  // Keep it right after current song in both lists
+  size_t index = cursor_ ? order_[*cursor_] + 1 : 0;
+  size_t position = cursor_ ? *cursor_ + 1 : 0;
+
+  items_.insert(items_.begin() + static_cast<std::ptrdiff_t>(index), filepath);
+
+  for (auto& value : order_) {
+    if (value >= index) value++;
+  }
+
+  order_.insert(order_.begin() + static_cast<std::ptrdiff_t>(position), index);
+}
+
+/* ********************************************************************************************** */
+
+bool PlayQueue::Remove(size_t index) {
+  std::scoped_lock lock(mutex_);
+  if (index >= items_.size()) return false;
+
+  LOG("Remove song from queue with filepath=", std::quoted(items_[index]));
+  changes_++;
+
+  items_.erase(items_.begin() + static_cast<std::ptrdiff_t>(index));
+
+  auto it = std::find(order_.begin(), order_.end(), index);
+  auto position = static_cast<size_t>(std::distance(order_.begin(), it));
+  order_.erase(it);
+
+  for (auto& value : order_) {
+    if (value > index) value--;
+  }
+
+  // Cursor stays right before the song that came after the removed one
+  if (cursor_ && position <= *cursor_) {
+    cursor_ = *cursor_ > 0 ? std::optional<size_t>(*cursor_ - 1) : std::nullopt;
+  }
+
+  return true;
+}
+
+/* ********************************************************************************************** */
+
+void PlayQueue::Clear() {
+  LOG("Clear play queue");
+  std::scoped_lock lock(mutex_);
+  changes_++;
+
+  items_.clear();
+  order_.clear();
+  cursor_.reset();
+}
+
+/* ********************************************************************************************** */
+
+bool PlayQueue::Select(const std::string& filepath) {
+  std::scoped_lock lock(mutex_);
+  changes_++;
+
+  auto item = std::find(items_.begin(), items_.end(), filepath);
+  if (item == items_.end()) return false;
+
+  auto index = static_cast<size_t>(std::distance(items_.begin(), item));
+  auto position = std::find(order_.begin(), order_.end(), index);
+  cursor_ = static_cast<size_t>(std::distance(order_.begin(), position));
+
+  return true;
+}
+
+/* ********************************************************************************************** */
+
+std::optional<std::string> PlayQueue::PeekNext() const {
+  std::scoped_lock lock(mutex_);
+
+  auto position = GetNextPosition();
+  if (!position) return std::nullopt;
+
+  return items_[order_[*position]];
+}
+
+/* ********************************************************************************************** */
+
+std::optional<std::string> PlayQueue::Next() {
+  std::scoped_lock lock(mutex_);
+  changes_++;
+
+  auto position = GetNextPosition();
+  if (!position) return std::nullopt;
+
+  cursor_ = position;
+  return items_[order_[*position]];
+}
+
+/* ********************************************************************************************** */
+
+std::optional<std::string> PlayQueue::Previous() {
+  std::scoped_lock lock(mutex_);
+  changes_++;
+  if (!cursor_) return std::nullopt;
+
+  if (repeat_ != Repeat::One) {
+    if (*cursor_ > 0) {
+      (*cursor_)--;
+    } else if (repeat_ == Repeat::All) {
+      cursor_ = order_.size() - 1;
+    }
+  }
+
+  return items_[order_[*cursor_]];
+}
+
+/* ********************************************************************************************** */
+
+std::optional<std::string> PlayQueue::GetCurrent() const {
+  std::scoped_lock lock(mutex_);
+  if (!cursor_) return std::nullopt;
+
+  return items_[order_[*cursor_]];
+}
+
+/* ********************************************************************************************** */
+
+std::vector<std::string> PlayQueue::GetItems() const {
+  std::scoped_lock lock(mutex_);
+  return items_;
+}
+
+/* ********************************************************************************************** */
+
+size_t PlayQueue::Size() const {
+  std::scoped_lock lock(mutex_);
+  return items_.size();
+}
+
+/* ********************************************************************************************** */
+
+void PlayQueue::SetRepeat(Repeat mode) {
+  LOG("Set repeat mode with value=", static_cast<int>(mode));
+  std::scoped_lock lock(mutex_);
+  changes_++;
+  repeat_ = mode;
+}
+
+/* ********************************************************************************************** */
+
+PlayQueue::Repeat PlayQueue::GetRepeat() const {
+  std::scoped_lock lock(mutex_);
+  return repeat_;
+}
+
+/* ********************************************************************************************** */
+
+void PlayQueue::SetShuffle(bool enable) {
+  LOG("Set shuffle mode with value=", enable);
+  std::scoped_lock lock(mutex_);
+  changes_++;
+  if (shuffle_ == enable) return;
+
+  shuffle_ = enable;
+  std::optional<size_t> current;
+  if (cursor_) current = order_[*cursor_];
+
+  order_.resize(items_.size());
+  std::iota(order_.begin(), order_.end(), 0);
+
+  if (!shuffle_) {
+    // Back to the order in which songs were added, continuing from current song
+    cursor_ = current;
+    return;
+  }
+
+  // Current song goes first, so every other song is played once before repeating any of them
+  if (current) std::swap(order_[0], order_[*current]);
+
+  auto begin = order_.begin() + (current ? 1 : 0);
+  std::shuffle(begin, order_.end(), random_);
+
+  if (current) cursor_ = 0;
+}
+
+/* ********************************************************************************************** */
+
+bool PlayQueue::IsShuffled() const {
+  std::scoped_lock lock(mutex_);
+  return shuffle_;
+}
+
+/* ********************************************************************************************** */
+
+std::optional<size_t> PlayQueue::GetNextPosition() const {
+  if (order_.empty()) return std::nullopt;
+
+  // Queue has not started yet
+  if (!cursor_) return 0;
+
+  if (repeat_ == Repeat::One) return cursor_;
+
+  if (size_t next = *cursor_ + 1; next < order_.size()) return next;
+
+  if (repeat_ == Repeat::All) return 0;
+
+  return std::nullopt;
+}
+
+}  // namespace audio
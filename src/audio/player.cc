@@ -1,35 +1,64 @@
 #include "audio/player.h"
 
+#include <algorithm>
 #include <iomanip>
+#include <optional>
 #include <stdexcept>
 
 #ifndef SPECTRUM_DEBUG
 #include "audio/driver/alsa.h"
 #include "audio/driver/ffmpeg.h"
+#include "audio/driver/file_sink.h"
+#include "audio/driver/null_sink.h"
+#include "audio/driver/pcm_cache.h"
 #else
 #include "debug/dummy_decoder.h"
 #include "debug/dummy_playback.h"
 #endif
 
+#include "util/tracer.h"
 #include "view/base/notifier.h"
 
 namespace audio {
 
+namespace {
+
+//! Get time elapsed since the given moment (in milliseconds)
+int64_t GetElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+                                                               start)
+      .count();
+}
+
+}  // namespace
+
+/* ********************************************************************************************** */
+
 std::shared_ptr<Player> Player::Create(driver::Playback* playback, driver::Decoder* decoder,
-                                       bool asynchronous) {
+                                       bool asynchronous, const PlayerOptions& options) {
   LOG("Create new instance of player");
 
+  std::shared_ptr<driver::PcmCache> cache;
+
 #ifndef SPECTRUM_DEBUG
+  // Create cache for decoded songs (optional)
+  if (!options.cache_directory.empty()) {
+    auto max_size = static_cast<uintmax_t>(std::max(options.cache_size_mb, 0)) << 20;
+    cache = driver::PcmCache::Create(options.cache_directory, max_size);
+  }
+
   // Create playback object
   auto pb = playback != nullptr ? std::unique_ptr<driver::Playback>(std::move(playback))
-                                : std::make_unique<driver::Alsa>();
+                                : CreatePlayback(options);
 
   // Create decoder object
-  auto dec = decoder != nullptr ? std::unique_ptr<driver::Decoder>(std::move(decoder))
-                                : std::make_unique<driver::FFmpeg>();
+  auto dec = decoder != nullptr
+                 ? std::unique_ptr<driver::Decoder>(std::move(decoder))
+                 : std::make_unique<driver::FFmpeg>(options.dsp_backend, /*map_files=*/true,
+                                                    options.decoder_threads, cache);
 #else
   // Create playback object
-  auto pb = std::make_unique<driver::DummyPlayback>();
+  auto pb = CreatePlayback(options);
 
   // Create decoder object
   auto dec = std::make_unique<driver::DummyDecoder>();
@@ -39,12 +68,16 @@ std::shared_ptr<Player> Player::Create(driver::Playback* playback, driver::Decod
   // neither do we want to use std::make_shared explicitly calling operator new()
   struct MakeSharedEnabler : public Player {
     explicit MakeSharedEnabler(std::unique_ptr<driver::Playback>&& playback,
-                               std::unique_ptr<driver::Decoder>&& decoder)
-        : Player(std::move(playback), std::move(decoder)) {}
+                               std::unique_ptr<driver::Decoder>&& decoder,
+                               const PlayerOptions& options)
+        : Player(std::move(playback), std::move(decoder), options) {}
   };
 
   // Instantiate Player
-  auto player = std::make_shared<MakeSharedEnabler>(std::move(pb), std::move(dec));
+  auto player = std::make_shared<MakeSharedEnabler>(std::move(pb), std::move(dec), options);
+
+  // Cache is also used by decoder opening next song in advance
+  player->cache_ = std::move(cache);
 
   // Initialize internal components
   player->Init(asynchronous);
@@ -55,8 +88,8 @@ std::shared_ptr<Player> Player::Create(driver::Playback* playback, driver::Decod
 /* ********************************************************************************************** */
 
 Player::Player(std::unique_ptr<driver::Playback>&& playback,
-               std::unique_ptr<driver::Decoder>&& decoder)
-    : playback_{std::move(playback)}, decoder_{std::move(decoder)} {}
+               std::unique_ptr<driver::Decoder>&& decoder, const PlayerOptions& options)
+    : playback_{std::move(playback)}, decoder_{std::move(decoder)}, options_{options} {}
 
 /* ********************************************************************************************** */
 
@@ -70,6 +103,13 @@ Player::~Player() {
   if (audio_loop_.joinable()) {
     audio_loop_.join();
   }
+
+  if (playback_loop_.joinable()) {
+    playback_loop_.join();
+  }
+
+  // Dump telemetry from playback stream, as it is the only way to quantify underruns afterwards
+  LOG("Playback statistics on exit: ", playback_->GetStatistics());
 }
 
 /* ********************************************************************************************** */
@@ -77,37 +117,123 @@ Player::~Player() {
 void Player::Init(bool asynchronous) {
   LOG("Initialize player with async=", asynchronous);
 
+  if (!asynchronous) {
+    if (InitPlayback() != error::kSuccess) {
+      throw std::runtime_error("Cannot initialize playback stream in player");
+    }
+
+    if (options_.realtime_policy != util::RealtimePolicy::None) util::LockMemory();
+    return;
+  }
+
+  // Opening a device may take a while (listing every sound card), so it is done by audio thread
+  // and UI comes up right away. Any command received meanwhile just waits in the queue
+  audio_loop_ = std::thread([this] {
+    auto start = std::chrono::steady_clock::now();
+    init_result_ = InitPlayback();
+
+    // Decoupling decoding from playback is only possible when running as a thread
+    if (init_result_ == error::kSuccess && options_.buffer_depth_ms > 0) {
+      // Allocated only once for the highest sample rate, as it cannot be resized while playback
+      // thread is running, and always with room for at least two periods (to avoid starving)
+      int frames = std::max(options_.buffer_depth_ms * kMaxSampleRate / 1000, period_size_ * 2);
+      LOG("Allocate audio buffer with frames=", frames);
+
+      buffer_.samples.Resize(static_cast<size_t>(frames) * kChannels);
+      UpdateBufferDepth();
+
+      // Spawn thread for Playback
+      playback_loop_ = std::thread(&Player::PlaybackHandler, this);
+    }
+
+    // All buffers from audio path are already allocated (and zeroed) at this point, so locking
+    // them now makes them resident, while future allocations are locked as soon as they are touched
+    if (options_.realtime_policy != util::RealtimePolicy::None) util::LockMemory();
+
+    LOG("Player initialized in ", GetElapsedMs(start), "ms with result=", init_result_);
+    AudioHandler();
+  });
+}
+
+/* ********************************************************************************************** */
+
+error::Code Player::InitPlayback() {
+  // Latency profile may be changed by UI thread while player is still idle, which also reconfigures
+  // playback stream, so it must wait until stream is ready
+  std::unique_lock playback_lock(playback_mutex_);
+  auto start = std::chrono::steady_clock::now();
+
   // Open playback stream using default device
   error::Code result = playback_->CreatePlaybackStream();
+  LOG("Created playback stream in ", GetElapsedMs(start), "ms with result=", result);
 
   if (result != error::kSuccess) {
-    throw std::runtime_error("Cannot initialize playback stream in player");
+    ERROR("Cannot initialize playback stream in player");
+    return error::kSetupAudioParamsFailed;
   }
 
   // Configure desired parameters for playback
+  start = std::chrono::steady_clock::now();
   result = playback_->ConfigureParameters();
+  LOG("Configured playback stream in ", GetElapsedMs(start), "ms with result=", result);
 
   if (result != error::kSuccess) {
-    throw std::runtime_error("Cannot set parameters in player");
+    ERROR("Cannot set parameters in player");
+    return error::kSetupAudioParamsFailed;
   }
 
-  // This value is used to decide buffer size for song decoding
-  period_size_ = playback_->GetPeriodSize();
+  std::shared_ptr<interface::Notifier> media_notifier;
 
-  if (asynchronous) {
-    // Spawn thread for Audio player
-    audio_loop_ = std::thread(&Player::AudioHandler, this);
+  {
+    // This value is used to decide buffer size for song decoding
+    std::scoped_lock lock(notifier_mutex_);
+    period_size_ = static_cast<int>(playback_->GetPeriodSize());
+    initialized_ = true;
+    media_notifier = notifier_.lock();
   }
+
+  playback_lock.unlock();
+
+  // Interface registered before playback was ready did not get period size yet
+  if (media_notifier) media_notifier->NotifyPeriodSize(period_size_);
+
+  return error::kSuccess;
 }
 
 /* ********************************************************************************************** */
 
 void Player::ResetMediaControl(error::Code result, bool error_parsing) {
-  LOG("Reset media control with error code=", result);
+  LOG("Reset media control with error code=", result,
+      " coalesced_commands=", media_control_.coalesced.load());
   bool notify_finished = media_control_.state == State::Play;
+
+  // Song finished naturally, so play queue decides the next one by itself (without waiting for UI)
+  std::optional<std::string> upcoming;
+  if (result == error::kSuccess && notify_finished) upcoming = queue_->PeekNext();
   decoder_->ClearCache();
+
+  // Discard any sample from this song that was not played yet
+  if (buffer_.samples.IsEnabled()) buffer_.samples.RequestFlush();
+
+  // Next song is only played without gap when current one finishes naturally
+  DiscardNextSong();
+  {
+    std::scoped_lock lock(next_filepath_mutex_);
+    next_filepath_.clear();
+  }
+
   media_control_.Reset();
   curr_song_.reset();
+  clock_->Reset();
+  failed_preload_.clear();
+  preload_changes_.reset();
+
+  // Unless user has already asked for another song (so play queue only advances when its next
+  // song is effectively played, otherwise it would be skipped)
+  if (upcoming && media_control_.queue.Empty() && (upcoming = queue_->Next())) {
+    LOG("Advance to next song from play queue, filepath=", std::quoted(*upcoming));
+    media_control_.Push(Command::Play(*upcoming));
+  }
 
   auto media_notifier = notifier_.lock();
   if (!media_notifier) return;
@@ -115,8 +241,9 @@ void Player::ResetMediaControl(error::Code result, bool error_parsing) {
   if (result != error::kSuccess) {
     // In case of error, notify about it
     media_notifier->NotifyError(result);
-  } else if (notify_finished) {
-    // If song finished naturally, notify that has finished successfully
+  } else if (notify_finished && !upcoming) {
+    // If song finished naturally, notify that has finished successfully (unless play queue has
+    // already started the next one, so UI does not try to pick it too)
     media_notifier->NotifySongState(
         model::Song::CurrentInformation{.state = model::Song::MediaState::Finished});
   }
@@ -127,9 +254,10 @@ void Player::ResetMediaControl(error::Code result, bool error_parsing) {
 
 /* ********************************************************************************************** */
 
-bool Player::HandleCommand(void* buffer, int size, int64_t& new_position, int& last_position) {
+bool Player::HandleCommand(void* buffer, int size, int64_t& new_position, int& last_position,
+                           interface::Notifier* media_notifier) {
+  // Nothing here takes a lock or allocates memory while there is no command to handle
   auto command = media_control_.Pop();
-  auto media_notifier = notifier_.lock();
 
   if (media_control_.state == State::Stop || media_control_.state == State::Exit) {
     return false;
@@ -143,6 +271,7 @@ bool Player::HandleCommand(void* buffer, int size, int64_t& new_position, int& l
 
       // Stop current song
       media_control_.state = State::Stop;
+      std::scoped_lock lock(playback_mutex_);
       playback_->Stop();
       return false;
     } break;
@@ -150,14 +279,23 @@ bool Player::HandleCommand(void* buffer, int size, int64_t& new_position, int& l
     case Command::Identifier::PauseOrResume: {
       LOG("Audio handler received command to pause song");
       media_control_.state = TranslateCommand(command);
-      playback_->Pause();
+
+      // P.S.: samples from audio buffer are preserved, to be played right after resume
+      {
+        std::scoped_lock lock(playback_mutex_);
+        playback_->Pause();
+      }
+
+      // Position is frozen at the last sample written, until song is resumed
+      PublishPosition(new_position, /* running= */ false);
 
       // As this thread can stay blocked for a long time, waiting for a command,
       // notify state to media controller
       if (media_notifier) {
         media_notifier->NotifySongState(model::Song::CurrentInformation{
             .state = model::Song::MediaState::Pause,
-            .position = (uint32_t)last_position,
+            .position = new_position,
+            .sample_rate = format_.sample_rate,
         });
       }
 
@@ -179,39 +317,63 @@ bool Player::HandleCommand(void* buffer, int size, int64_t& new_position, int& l
 
         // Stop current song
         media_control_.state = TranslateCommand(command_after_wait);
+        std::scoped_lock lock(playback_mutex_);
         playback_->Stop();
         return false;
       }
 
       LOG("Audio handler received command to resume song");
+
+      // Volume changed while paused was discarded along with other commands, so apply it now
+      decoder_->SetVolume(volume_.load());
+      if (next_song_) next_decoder_->SetVolume(volume_.load());
+
+      {
+        // Samples written before pause are still queued, so sound comes back right away
+        std::scoped_lock lock(playback_mutex_);
+        playback_->Resume();
+      }
       media_control_.state = State::Play;
-      playback_->Prepare();
+      buffer_.Notify();
     } break;
 
     case Command::Identifier::Stop:
     case Command::Identifier::Exit: {
       LOG("Audio handler received command to", command);
       media_control_.state = TranslateCommand(command);
+      std::scoped_lock lock(playback_mutex_);
       playback_->Stop();
       return false;
     } break;
 
     case Command::Identifier::SeekForward: {
       int offset = command.GetContent<int>();
-      LOG("Audio handler received command to seek forward with value=", offset);
+      LOG("Audio handler received command to seek forward with value=", offset, "ms");
+
+      // Decoder is responsible to discard samples until reaching exactly this position (offset may
+      // be the sum from many seeks coalesced, so instead of ignoring it, stop at the last sample)
+      int64_t last = static_cast<int64_t>(curr_song_->duration) * format_.sample_rate - 1;
+      int64_t target = std::min(new_position + ToSamples(offset), last);
 
-      if ((new_position + offset) < curr_song_->duration) {
-        new_position += offset;
+      if (target > new_position) {
+        new_position = target;
+
+        // Samples decoded before seeking must not be played
+        if (buffer_.samples.IsEnabled()) buffer_.samples.RequestFlush();
         return true;
       }
     } break;
 
     case Command::Identifier::SeekBackward: {
       int offset = command.GetContent<int>();
-      LOG("Audio handler received command to seek backward with value=", offset);
+      LOG("Audio handler received command to seek backward with value=", offset, "ms");
+
+      // Same as above, but stopping at the beginning
+      if (new_position > 0) {
+        new_position = std::max<int64_t>(new_position - ToSamples(offset), 0);
 
-      if (new_position > 0 && (new_position - offset) >= 0) {
-        new_position -= offset;
+        // Samples decoded before seeking must not be played
+        if (buffer_.samples.IsEnabled()) buffer_.samples.RequestFlush();
         return true;
       }
     } break;
@@ -220,6 +382,20 @@ bool Player::HandleCommand(void* buffer, int size, int64_t& new_position, int& l
       model::Volume value = command.GetContent<model::Volume>();
       LOG("Audio handler received command to set volume with value=", value);
       decoder_->SetVolume(value);
+
+      // Keep the same volume on next song opened in advance
+      if (next_song_) next_decoder_->SetVolume(value);
+    } break;
+
+    case Command::Identifier::SetLatencyProfile: {
+      auto value = command.GetContent<driver::LatencyProfile>();
+      LOG("Audio handler received command to set latency profile with value=",
+          static_cast<int>(value));
+
+      if (error::Code result = ApplyLatencyProfile(value);
+          result != error::kSuccess && media_notifier) {
+        media_notifier->NotifyError(result);
+      }
     } break;
 
     case Command::Identifier::UpdateAudioFilters: {
@@ -227,32 +403,50 @@ bool Player::HandleCommand(void* buffer, int size, int64_t& new_position, int& l
       LOG("Audio handler received command to update audio filters");
       // TODO: handle error...
       decoder_->UpdateFilters(value);
+      filters_ = value;
+
+      // Filters are only applied when file is opened, so next song must be opened again
+      DiscardNextSong();
+      preload_changes_.reset();
     } break;
 
     default:
       break;
   }
 
-  // Send raw information to media controller to run audio analysis
-  if (media_notifier) {
-    media_notifier->SendAudioRaw(static_cast<int*>(buffer), size);
+  if (buffer_.samples.IsEnabled()) {
+    // Playback thread is responsible to send samples to both media controller and playback
+    WriteToBuffer(buffer, size);
+  } else {
+    // Send raw information to media controller to run audio analysis
+    if (media_notifier) {
+      TRACE_SCOPE("SendAudioRaw");
+      media_notifier->SendAudioRaw(static_cast<float*>(buffer), size * kChannels);
+    }
+
+    // Write samples to playback
+    playback_->AudioCallback(buffer, size);
   }
 
-  // Write samples to playback
-  playback_->AudioCallback(buffer, size);
+  PublishPosition(new_position + size, /* running= */ true);
 
-  // Notify song state to graphical interface
-  if (last_position != new_position) {
-    last_position = static_cast<int>(new_position);
+  // Notify song state to graphical interface (only when it reaches another second)
+  if (int seconds = static_cast<int>(new_position / format_.sample_rate);
+      last_position != seconds) {
+    last_position = seconds;
 
     if (media_notifier) {
       media_notifier->NotifySongState(model::Song::CurrentInformation{
           .state = model::Song::MediaState::Play,
-          .position = (uint32_t)last_position,
+          .position = new_position,
+          .sample_rate = format_.sample_rate,
       });
     }
   }
 
+  // Open next song in advance, in case that current song is about to finish
+  PreloadNextSong(new_position / format_.sample_rate);
+
   return true;
 }
 
@@ -261,6 +455,9 @@ bool Player::HandleCommand(void* buffer, int size, int64_t& new_position, int& l
 void Player::AudioHandler() {
   LOG("Start audio handler thread");
 
+  // Without audio buffer, this thread is also the one writing samples into playback stream
+  if (options_.buffer_depth_ms == 0) SetupRealtimeThread();
+
   // Block this thread until UI informs us a song to play
   while (media_control_.WaitFor(Command::Play())) {
     LOG("Audio handler received new song to play");
@@ -274,6 +471,19 @@ void Player::AudioHandler() {
         .filepath = command_play.GetContent<std::string>(),
     });
 
+    // Song may have been picked by user, so play queue continues from it
+    if (queue_->GetCurrent() != curr_song_->filepath) queue_->Select(curr_song_->filepath);
+
+    // Nothing can be played without a playback stream
+    if (init_result_ != error::kSuccess) {
+      ResetMediaControl(init_result_, /* error_parsing= */ true);
+      continue;
+    }
+
+    // Volume changed while no song was decoded never reached decoder (as commands are discarded
+    // while waiting for a song), so it is always taken from player
+    decoder_->SetVolume(volume_.load());
+
     // First, try to parse file (it may be or not a support file extension to decode)
     error::Code result = decoder_->OpenFile(*curr_song_);
 
@@ -289,16 +499,54 @@ void Player::AudioHandler() {
         media_notifier->NotifySongInformation(*curr_song_);
     }
 
-    // Inform playback driver to be ready to play
-    playback_->Prepare();
+    // Agree with playback on the format to use for this song (resampling only if necessary)
+    model::AudioFormat format = NegotiateFormat(*curr_song_);
+
+    if (result = decoder_->SetOutputFormat(format, options_.passthrough);
+        result == error::kSuccess) {
+      result = ApplyFormat(format);
+    }
+
+    if (result != error::kSuccess) {
+      ResetMediaControl(result);
+      continue;
+    }
+
+    {
+      // Inform playback driver to be ready to play
+      std::scoped_lock lock(playback_mutex_);
+      playback_->Prepare();
+    }
 
-    int position = -1;  // in seconds
+    // Notifier is kept while decoding song, instead of being locked for every decoded buffer
+    auto media_notifier = notifier_.lock();
+    bool keep_decoding = true;
 
-    // To keep decoding audio, return true in lambda function
-    result = decoder_->Decode(period_size_ / 2,
-                              [this, &position](void* buffer, int size, int64_t& new_position) {
-                                return HandleCommand(buffer, size, new_position, position);
-                              });
+    while (keep_decoding) {
+      int position = -1;  // in seconds
+
+      // To keep decoding audio, return true in lambda function
+      result = decoder_->Decode(
+          period_size_ / 2, [this, &position, notifier = media_notifier.get()](
+                                void* buffer, int size, int64_t& new_position) {
+            return HandleCommand(buffer, size, new_position, position, notifier);
+          });
+
+      // Song finished naturally and next one is already opened, so keep playback stream running
+      // and start decoding next song right after the last sample from current one
+      keep_decoding = result == error::kSuccess && media_control_.state == State::Play &&
+                      SwitchToNextSong();
+    }
+
+    // Song was decoded until the end, but there may be some samples left to play
+    if (result == error::kSuccess && buffer_.samples.IsEnabled()) WaitForBufferDrain();
+
+    // And they may not be enough to start playback stream by itself (e.g. song shorter than device
+    // buffer), as no more samples are coming
+    if (result == error::kSuccess && media_control_.state == State::Play) {
+      std::scoped_lock lock(playback_mutex_);
+      playback_->Finish();
+    }
 
     // Reached the end of song, originated from one of these situations:
     // 1. naturally; 2. forced to stop/exit by user; 3. error from decoding;
@@ -310,9 +558,418 @@ void Player::AudioHandler() {
 
 /* ********************************************************************************************** */
 
+void Player::PlaybackHandler() {
+  LOG("Start playback handler thread");
+  SetupRealtimeThread();
+
+  // Chunk has the same size as a period from playback stream (allocated up front, so it is touched
+  // before the first song)
+  std::vector<float> chunk(static_cast<size_t>(period_size_) * kChannels);
+
+  // Only consider as underrun when audio buffer becomes empty in the middle of a song
+  bool starving = true;
+
+  // Notifier is kept while playing, instead of being locked for every chunk (it is locked again
+  // whenever playing starts, as it may be registered meanwhile)
+  std::shared_ptr<interface::Notifier> media_notifier;
+  bool playing = false;
+
+  while (media_control_.state != State::Exit) {
+    if (media_control_.state != State::Play) {
+      starving = true;
+      playing = false;
+      media_notifier.reset();
+      buffer_.WaitFor(kIdleTimeout);
+      continue;
+    }
+
+    if (!playing) {
+      playing = true;
+      media_notifier = notifier_.lock();
+    }
+
+    // Keep playback stream locked while handling a chunk, so decoding thread knows when a chunk
+    // that has been already consumed from audio buffer is effectively written to playback
+    std::unique_lock lock(playback_mutex_);
+
+    // Period size may only change while playback stream is locked (by format or latency profile),
+    // and chunk is only reallocated when it does
+    chunk.resize(static_cast<size_t>(period_size_) * kChannels);
+    size_t count = buffer_.samples.Read(chunk.data(), chunk.size());
+
+    if (count == 0) {
+      lock.unlock();
+
+      if (!starving) {
+        buffer_.underruns++;
+        starving = true;
+      }
+
+      buffer_.WaitFor(kBufferBackoff);
+      continue;
+    }
+
+    starving = false;
+    int frames = static_cast<int>(count / kChannels);
+
+    // Send raw information to media controller to run audio analysis
+    if (media_notifier) {
+      TRACE_SCOPE("SendAudioRaw");
+      media_notifier->SendAudioRaw(chunk.data(), static_cast<int>(count));
+    }
+
+    // Write samples to playback (in case that state has changed meanwhile, just drop them)
+    if (media_control_.state == State::Play) playback_->AudioCallback(chunk.data(), frames);
+  }
+
+  LOG("Finish playback handler thread with underruns=", buffer_.underruns.load());
+}
+
+/* ********************************************************************************************** */
+
+void Player::SetupRealtimeThread() const {
+  if (options_.realtime_policy == util::RealtimePolicy::None) return;
+
+  // Stack is touched in advance, so there is no page fault later while writing samples
+  util::PrefaultStack();
+
+  if (!util::SetRealtimeScheduling(options_.realtime_policy, options_.realtime_priority)) {
+    LOG("Thread writing into playback stream keeps running with normal scheduling");
+  }
+}
+
+/* ********************************************************************************************** */
+
+void Player::WriteToBuffer(const void* buffer, int size) {
+  const auto* data = static_cast<const float*>(buffer);
+  size_t remaining = static_cast<size_t>(size) * kChannels;
+
+  // Only the depth asked for the current sample rate is filled, not the whole capacity
+  const size_t depth = buffer_.depth.load(std::memory_order_relaxed);
+
+  // Keep trying while song is playing, otherwise audio buffer will be flushed anyway
+  while (remaining > 0 && media_control_.state == State::Play) {
+    size_t size = buffer_.samples.Size();
+    size_t room = depth > size ? depth - size : 0;
+
+    size_t written = buffer_.samples.Write(data, std::min(remaining, room));
+    data += written;
+    remaining -= written;
+
+    buffer_.Notify();
+
+    // Audio buffer is full, so wait for playback thread to consume some samples
+    if (remaining > 0) std::this_thread::sleep_for(kBufferBackoff);
+  }
+}
+
+/* ********************************************************************************************** */
+
+void Player::PublishPosition(int64_t position, bool running) {
+  // Only atomic loads here, as this is called for every decoded buffer
+  int64_t pending = playback_->GetOutputDelay();
+  if (buffer_.samples.IsEnabled()) {
+    pending += static_cast<int64_t>(buffer_.samples.Size() / kChannels);
+  }
+
+  clock_->Publish(std::max<int64_t>(position - pending, 0), format_.sample_rate, running);
+}
+
+/* ********************************************************************************************** */
+
+void Player::WaitForBufferDrain() {
+  LOG("Wait for playback thread to consume remaining samples from audio buffer");
+
+  while (media_control_.state == State::Play && buffer_.samples.Size() > 0) {
+    buffer_.Notify();
+    std::this_thread::sleep_for(kBufferBackoff);
+  }
+
+  // Wait for the last chunk consumed to be written to playback stream
+  std::scoped_lock lock(playback_mutex_);
+}
+
+/* ********************************************************************************************** */
+
+std::unique_ptr<driver::Decoder> Player::CreateDecoder() const {
+#ifndef SPECTRUM_DEBUG
+  return std::make_unique<driver::FFmpeg>(options_.dsp_backend, /*map_files=*/true,
+                                          options_.decoder_threads, cache_);
+#else
+  return std::make_unique<driver::DummyDecoder>();
+#endif
+}
+
+/* ********************************************************************************************** */
+
+std::unique_ptr<driver::Playback> Player::CreatePlayback(const PlayerOptions& options) {
+#ifndef SPECTRUM_DEBUG
+  switch (options.output) {
+    case driver::PlaybackOutput::Null:
+      return std::make_unique<driver::NullSink>(options.output_paced);
+
+    case driver::PlaybackOutput::Wav:
+      return std::make_unique<driver::FileSink>(options.output_path,
+                                                driver::FileSink::Container::Wav, options.dither);
+
+    case driver::PlaybackOutput::Raw:
+      return std::make_unique<driver::FileSink>(options.output_path,
+                                                driver::FileSink::Container::Raw, options.dither);
+
+    case driver::PlaybackOutput::Alsa:
+    default:
+      return std::make_unique<driver::Alsa>(options.dither, options.playback_access,
+                                            options.latency_profile, options.output_device);
+  }
+#else
+  return std::make_unique<driver::DummyPlayback>();
+#endif
+}
+
+/* ********************************************************************************************** */
+
+void Player::PreloadNextSong(int64_t position) {
+  // Still too early to open next song
+  if (position + kPreloadThreshold < curr_song_->duration) return;
+
+  // This is called for every decoded buffer, so next song is read only after being changed
+  uint64_t changes = queue_->GetChanges() + next_filepath_changes_.load(std::memory_order_acquire);
+  if (preload_changes_ == changes) return;
+
+  preload_changes_ = changes;
+
+  // Play queue decides which song comes next, otherwise it is the one informed by UI
+  std::string filepath;
+  if (queue_->Size() > 0) {
+    filepath = queue_->PeekNext().value_or("");
+  } else {
+    std::scoped_lock lock(next_filepath_mutex_);
+    filepath = next_filepath_;
+  }
+
+  // Next song is already opened (or it could not be opened)
+  if (next_song_ && next_song_->filepath == filepath) return;
+  if (!filepath.empty() && filepath == failed_preload_) return;
+
+  // In case that UI has changed its mind about next song, close the old one
+  DiscardNextSong();
+  if (filepath.empty()) return;
+
+  LOG("Open next song in advance with filepath=", std::quoted(filepath));
+  if (!next_decoder_) next_decoder_ = CreateDecoder();
+
+  // Next song must sound exactly like the current one
+  next_decoder_->SetVolume(volume_.load());
+  if (!filters_.empty()) next_decoder_->UpdateFilters(filters_);
+
+  auto song = std::make_unique<model::Song>(model::Song{.filepath = filepath});
+
+  error::Code result = next_decoder_->OpenFile(*song);
+
+  if (result == error::kSuccess) {
+    next_format_ = NegotiateFormat(*song);
+    result = next_decoder_->SetOutputFormat(next_format_, options_.passthrough);
+  }
+
+  if (result != error::kSuccess) {
+    ERROR("Cannot open next song in advance, error=", result);
+
+    // Do not try it again, so after current song finishes, it will be handled as usual
+    failed_preload_ = filepath;
+    std::scoped_lock lock(next_filepath_mutex_);
+    if (next_filepath_ == filepath) next_filepath_.clear();
+    return;
+  }
+
+  next_song_ = std::move(song);
+}
+
+/* ********************************************************************************************** */
+
+bool Player::SwitchToNextSong() {
+  if (!next_song_) return false;
+
+  LOG("Switch to next song without reopening playback stream, filepath=",
+      std::quoted(next_song_->filepath));
+
+  // Playback stream cannot change its format while running, so there is a gap only in this case
+  if (next_format_ != format_) {
+    if (buffer_.samples.IsEnabled()) WaitForBufferDrain();
+
+    if (error::Code result = ApplyFormat(next_format_); result != error::kSuccess) {
+      ERROR("Cannot change format to play next song, error=", result);
+      DiscardNextSong();
+      return false;
+    }
+
+    std::scoped_lock lock(playback_mutex_);
+    playback_->Prepare();
+  }
+
+  // Current decoder is kept to open the song after the next one
+  decoder_->ClearCache();
+  std::swap(decoder_, next_decoder_);
+  curr_song_ = std::move(next_song_);
+  failed_preload_.clear();
+  preload_changes_.reset();
+
+  {
+    std::scoped_lock lock(next_filepath_mutex_);
+    if (next_filepath_ == curr_song_->filepath) next_filepath_.clear();
+  }
+
+  // Song came from play queue, so it becomes the current one there too
+  if (queue_->PeekNext() == curr_song_->filepath) queue_->Next();
+
+  // Send detailed audio information to UI (P.S.: song has not finished, it was replaced)
+  if (auto media_notifier = notifier_.lock(); media_notifier)
+    media_notifier->NotifySongInformation(*curr_song_);
+
+  return true;
+}
+
+/* ********************************************************************************************** */
+
+model::AudioFormat Player::NegotiateFormat(const model::Song& song) {
+  if (!options_.passthrough || song.sample_rate == 0) return kDefaultFormat;
+
+  // Decoder always outputs float, so any of these keeps the whole resolution from a song with more
+  // than 16 bits (in order of preference)
+  static constexpr model::AudioFormat kHighResolution[] = {
+      {0, kChannels, 32},
+      {0, kChannels, 24},
+      {0, kChannels, 32, /*floating_point=*/true},
+  };
+
+  std::scoped_lock lock(playback_mutex_);
+  uint32_t sample_rate = song.sample_rate;
+
+  for (;;) {
+    // Audio buffer is allocated for the highest sample rate, so anything above it is only played
+    // at an integer fraction from song sample rate
+    if (sample_rate <= kMaxSampleRate) {
+      if (song.bit_depth > kBitDepth) {
+        for (model::AudioFormat format : kHighResolution) {
+          format.sample_rate = sample_rate;
+          if (playback_->IsFormatSupported(format)) return format;
+        }
+      }
+
+      model::AudioFormat format{sample_rate, kChannels, kBitDepth};
+      if (format == kDefaultFormat || playback_->IsFormatSupported(format)) return format;
+    }
+
+    // Otherwise, try an integer fraction from song sample rate (e.g. 192kHz -> 96kHz -> 48kHz),
+    // which is still better than resampling to default rate
+    if (sample_rate % 2 != 0 || sample_rate / 2 < kSampleRate) break;
+    sample_rate /= 2;
+  }
+
+  LOG("Playback does not support song sample rate=", song.sample_rate, ", fallback to default");
+  return kDefaultFormat;
+}
+
+/* ********************************************************************************************** */
+
+error::Code Player::ApplyFormat(const model::AudioFormat& format) {
+  if (format == format_) return error::kSuccess;
+
+  LOG("Change playback format from ", format_, " to ", format);
+  std::scoped_lock lock(playback_mutex_);
+
+  if (error::Code result = playback_->SetFormat(format); result != error::kSuccess) return result;
+
+  // Period size depends on sample rate
+  bool rate_changed = format.sample_rate != format_.sample_rate;
+  format_ = format;
+  UpdatePeriodSize();
+  UpdateBufferDepth();
+
+  // Audio analysis must know which frequencies are represented by samples sent to it
+  if (auto media_notifier = notifier_.lock(); media_notifier && rate_changed) {
+    media_notifier->NotifySampleRate(static_cast<int>(format_.sample_rate));
+  }
+
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+error::Code Player::ApplyLatencyProfile(driver::LatencyProfile profile) {
+  LOG("Change playback latency profile to ", static_cast<int>(profile));
+  std::scoped_lock lock(playback_mutex_);
+
+  if (error::Code result = playback_->SetLatencyProfile(profile); result != error::kSuccess) {
+    return result;
+  }
+
+  // Period size granted by device depends on latency profile
+  UpdatePeriodSize();
+
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+void Player::UpdatePeriodSize() {
+  int period_size = static_cast<int>(playback_->GetPeriodSize());
+  if (period_size == period_size_) return;
+
+  LOG("Update period size from ", period_size_, " to ", period_size);
+  period_size_ = period_size;
+
+  if (auto media_notifier = notifier_.lock(); media_notifier) {
+    media_notifier->NotifyPeriodSize(period_size_);
+  }
+}
+
+/* ********************************************************************************************** */
+
+void Player::UpdateBufferDepth() {
+  if (!buffer_.samples.IsEnabled()) return;
+
+  // Same as done when allocating it, but for the current sample rate
+  int rate = static_cast<int>(format_.sample_rate);
+  int frames = std::max(options_.buffer_depth_ms * rate / 1000, period_size_ * 2);
+  size_t depth = std::min(static_cast<size_t>(frames) * kChannels, buffer_.samples.Capacity());
+
+  LOG("Update audio buffer depth to samples=", depth, " with sample_rate=", rate);
+  buffer_.depth.store(depth, std::memory_order_relaxed);
+  buffer_.sample_rate.store(format_.sample_rate, std::memory_order_relaxed);
+}
+
+/* ********************************************************************************************** */
+
+void Player::DiscardNextSong() {
+  if (!next_song_) return;
+
+  LOG("Discard next song opened in advance");
+  next_decoder_->ClearCache();
+  next_song_.reset();
+}
+
+/* ********************************************************************************************** */
+
 void Player::RegisterInterfaceNotifier(const std::shared_ptr<interface::Notifier>& notifier) {
   LOG("Register new interface notifier");
-  notifier_ = notifier;
+  bool initialized = false;
+
+  {
+    std::scoped_lock lock(notifier_mutex_);
+    notifier_ = notifier;
+    initialized = initialized_;
+  }
+
+  // Audio analysis must know the pace that samples are sent to it (otherwise it is sent as soon as
+  // playback stream is initialized)
+  if (initialized) notifier->NotifyPeriodSize(period_size_);
+
+  // Volume changed by another mixer goes straight to UI (listener only holds a weak reference, as
+  // it is called from a thread owned by playback)
+  playback_->SetVolumeListener(
+      [weak = std::weak_ptr<interface::Notifier>(notifier)](model::Volume value) {
+        if (auto media_notifier = weak.lock(); media_notifier) media_notifier->NotifyVolume(value);
+      });
 }
 
 /* ********************************************************************************************** */
@@ -352,13 +1009,17 @@ void Player::SetAudioVolume(const model::Volume& value) {
       if (result != error::kSuccess) {
         auto media_notifier = notifier_.lock();
         if (media_notifier) media_notifier->NotifyError(result);
+        return;
       }
+
+      volume_.store(value);
     } break;
 
     // Otherwise, add command to queue
     case State::Play:
     case State::Pause:
     case State::Stop:
+      volume_.store(value);
       media_control_.Push(Command::SetVolume(value));
       break;
 
@@ -371,7 +1032,7 @@ void Player::SetAudioVolume(const model::Volume& value) {
 
 model::Volume Player::GetAudioVolume() const {
   LOG("Get audio volume");
-  return decoder_->GetVolume();
+  return volume_.load();
 }
 
 /* ********************************************************************************************** */
@@ -397,6 +1058,7 @@ void Player::ApplyAudioFilters(const model::EqualizerPreset& filters) {
   switch (media_control_.state) {
     // If state is idle, there is no music playing
     case State::Idle: {
+      filters_ = filters;
       error::Code result = decoder_->UpdateFilters(filters);
 
       // Notify error
@@ -420,9 +1082,81 @@ void Player::ApplyAudioFilters(const model::EqualizerPreset& filters) {
 
 /* ********************************************************************************************** */
 
+void Player::SetNextSong(const std::string& filepath) {
+  LOG("Set next song with filepath=", std::quoted(filepath));
+  std::scoped_lock lock(next_filepath_mutex_);
+  next_filepath_ = filepath;
+  next_filepath_changes_++;
+}
+
+/* ********************************************************************************************** */
+
+void Player::SetLatencyProfile(driver::LatencyProfile profile) {
+  LOG("Set latency profile with value=", static_cast<int>(profile));
+
+  // Apply latency profile directly or add new command to audio queue, based on current media state
+  switch (media_control_.state) {
+    // If state is idle, there is no music playing
+    case State::Idle: {
+      error::Code result = ApplyLatencyProfile(profile);
+
+      // Notify error
+      if (result != error::kSuccess) {
+        auto media_notifier = notifier_.lock();
+        if (media_notifier) media_notifier->NotifyError(result);
+      }
+    } break;
+
+    // Otherwise, add command to queue
+    case State::Play:
+    case State::Pause:
+    case State::Stop:
+      media_control_.Push(Command::SetLatencyProfile(profile));
+      break;
+
+    default:
+      break;
+  }
+}
+
+/* ********************************************************************************************** */
+
 void Player::Exit() {
   LOG("Add command to queue: Exit");
   media_control_.Push(Command::Exit());
+  buffer_.Notify();
+}
+
+/* ********************************************************************************************** */
+
+Player::BufferStatus Player::GetBufferStatus() const {
+  if (!buffer_.samples.IsEnabled()) return BufferStatus{};
+
+  // Convert number of samples into milliseconds (from the same sample rate as samples in buffer)
+  auto to_ms = [rate = buffer_.sample_rate.load(std::memory_order_relaxed)](size_t samples) {
+    return static_cast<int>(samples / kChannels * 1000 / rate);
+  };
+
+  return BufferStatus{
+      .capacity_ms = to_ms(buffer_.depth.load(std::memory_order_relaxed)),
+      .fill_ms = to_ms(buffer_.samples.Size()),
+      .underruns = buffer_.underruns.load(),
+  };
+}
+
+/* ********************************************************************************************** */
+
+Player::CommandStatus Player::GetCommandStatus() const {
+  return CommandStatus{
+      .queue_depth = media_control_.queue.Size(),
+      .coalesced = media_control_.coalesced.load(),
+  };
+}
+
+/* ********************************************************************************************** */
+
+driver::Playback::Statistics Player::GetPlaybackStatistics() const {
+  return playback_->GetStatistics();
 }
 
 }  // namespace audio
@@ -2,19 +2,26 @@
  * \file
  * \brief Main function
  */
-#include <cstdlib>  // for EXIT_SUCCESS
+#include <algorithm>  // for max
+#include <cstdlib>    // for EXIT_SUCCESS
 #include <exception>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
 #include <string>
 
 #include "audio/player.h"                          // for Player
 #include "ftxui/component/screen_interactive.hpp"  // for ScreenInteractive
+#include "middleware/headless_controller.h"        // for HeadlessController
 #include "middleware/media_controller.h"           // for MediaController
 #include "util/arg_parser.h"                       // for ArgumentParser
 #include "util/logger.h"                           // For Logger
+#include "util/tracer.h"                           // for Tracer
 #include "view/base/terminal.h"                    // for Terminal
 
 //! Command-line argument parsing
-bool parse(int argc, char** argv, std::string& path) {
+bool parse(int argc, char** argv, std::string& path, audio::PlayerOptions& options,
+           bool& analysis) {
   using util::Argument;
   using util::ExpectedArguments;
   using util::ParsedArguments;
@@ -31,7 +38,84 @@ bool parse(int argc, char** argv, std::string& path) {
         Argument{
             .name = "directory",
             .choices = {"-d", "--directory"},
-            .description = "Initialize listing files from the given directory path",
+            .description = "Initialize listing files from the given directory path (or play "
+                           "every song from it, or a single file, when output is not \"alsa\")",
+        },
+        Argument{
+            .name = "buffer",
+            .choices = {"-b", "--buffer"},
+            .description = "Set audio buffer depth in milliseconds between decoding and playback "
+                           "(use 0 to disable it)",
+        },
+        Argument{
+            .name = "dsp",
+            .choices = {"-p", "--dsp"},
+            .description = "Select implementation for volume and equalizer: \"ffmpeg\" (default) "
+                           "or \"native\"",
+        },
+        Argument{
+            .name = "passthrough",
+            .choices = {"-t", "--passthrough"},
+            .description = "Play songs with their own sample rate when supported by device, "
+                           "without resampling: \"on\" (default) or \"off\"",
+        },
+        Argument{
+            .name = "mmap",
+            .choices = {"-m", "--mmap"},
+            .description = "Write samples straight into device buffer mapped into memory, when "
+                           "supported by device: \"on\" (default) or \"off\"",
+        },
+        Argument{
+            .name = "latency",
+            .choices = {"-L", "--latency"},
+            .description = "Set playback latency profile: \"ultra-low\" (~10ms), \"balanced\" "
+                           "(default) or \"power-save\" (~500ms, fewer CPU wakeups)",
+        },
+        Argument{
+            .name = "realtime",
+            .choices = {"-r", "--realtime"},
+            .description = "Write samples with real-time scheduling and memory locked: \"fifo\" "
+                           "or \"rr\", optionally followed by \":priority\" (default: 70)",
+        },
+        Argument{
+            .name = "threads",
+            .choices = {"-j", "--threads"},
+            .description = "Set number of threads for decoding: \"auto\" (default), \"off\" or "
+                           "a fixed number",
+        },
+        Argument{
+            .name = "cache",
+            .choices = {"-c", "--cache"},
+            .description = "Keep decoded songs in the given directory path, so they are played "
+                           "again without decoding (with \"ffmpeg\" DSP, only songs played with "
+                           "passthrough, full volume and flat equalizer are kept)",
+        },
+        Argument{
+            .name = "cache_size",
+            .choices = {"-s", "--cache-size"},
+            .description = "Set maximum size in megabytes for decoded songs cache (default: 1024)",
+        },
+        Argument{
+            .name = "output",
+            .choices = {"-o", "--output"},
+            .description = "Select where samples are played: \"alsa\" (default, or "
+                           "\"alsa:<device>\" for a specific device), \"null\" (as fast as "
+                           "possible, or \"null:paced\" for real-time pace), \"wav:<path>\" or "
+                           "\"raw:<path>\" (these run without user interface, exiting after "
+                           "playing songs from directory)",
+        },
+        Argument{
+            .name = "analysis",
+            .choices = {"-a", "--analysis"},
+            .description = "Run audio analysis on samples even when output is not \"alsa\" "
+                           "(there is no spectrum to show, but it is measured as part of "
+                           "playback): \"on\" (default) or \"off\"",
+        },
+        Argument{
+            .name = "trace",
+            .choices = {"-T", "--trace"},
+            .description = "Record time spent on each stage from audio pipeline and write it on "
+                           "exit to specified path (Chrome Trace Event format, e.g. for Perfetto)",
         },
     };
 
@@ -45,11 +129,146 @@ bool parse(int argc, char** argv, std::string& path) {
       util::Logger::GetInstance().Configure(*logging_path);
     }
 
+    // Check if contains filepath for tracing
+    if (auto tracing_path = parsed_args["trace"]; tracing_path) {
+      // Enable tracing, so it is written to specified path on exit
+      util::Tracer::GetInstance().Configure(*tracing_path);
+    }
+
     // Check if contains dirpath for initial file listing
     if (auto initial_path = parsed_args["directory"]; initial_path) {
       path = *initial_path;
     }
 
+    // Check if contains audio buffer depth
+    if (auto buffer_depth = parsed_args["buffer"]; buffer_depth) {
+      options.buffer_depth_ms = std::max(std::stoi(*buffer_depth), 0);
+    }
+
+    // Check if contains DSP backend
+    if (auto backend = parsed_args["dsp"]; backend) {
+      if (*backend != "ffmpeg" && *backend != "native") {
+        std::cerr << "spectrum: invalid value for DSP backend\n";
+        return false;
+      }
+
+      options.dsp_backend =
+          *backend == "native" ? driver::DspBackend::Native : driver::DspBackend::Filtergraph;
+    }
+
+    // Check if contains passthrough mode
+    if (auto passthrough = parsed_args["passthrough"]; passthrough) {
+      if (*passthrough != "on" && *passthrough != "off") {
+        std::cerr << "spectrum: invalid value for passthrough\n";
+        return false;
+      }
+
+      options.passthrough = *passthrough == "on";
+    }
+
+    // Check if contains access method for playback
+    if (auto mmap = parsed_args["mmap"]; mmap) {
+      if (*mmap != "on" && *mmap != "off") {
+        std::cerr << "spectrum: invalid value for mmap\n";
+        return false;
+      }
+
+      options.playback_access =
+          *mmap == "on" ? driver::PlaybackAccess::Mmap : driver::PlaybackAccess::ReadWrite;
+    }
+
+    // Check if contains latency profile for playback
+    if (auto latency = parsed_args["latency"]; latency) {
+      if (*latency == "ultra-low") {
+        options.latency_profile = driver::LatencyProfile::UltraLow;
+      } else if (*latency == "balanced") {
+        options.latency_profile = driver::LatencyProfile::Balanced;
+      } else if (*latency == "power-save") {
+        options.latency_profile = driver::LatencyProfile::PowerSave;
+      } else {
+        std::cerr << "spectrum: invalid value for latency profile\n";
+        return false;
+      }
+    }
+
+    // Check if contains real-time scheduling for playback
+    if (auto realtime = parsed_args["realtime"]; realtime) {
+      std::string policy = realtime->substr(0, realtime->find(':'));
+
+      if (policy != "fifo" && policy != "rr") {
+        std::cerr << "spectrum: invalid value for real-time scheduling\n";
+        return false;
+      }
+
+      options.realtime_policy =
+          policy == "rr" ? util::RealtimePolicy::RoundRobin : util::RealtimePolicy::Fifo;
+
+      if (policy.size() < realtime->size()) {
+        options.realtime_priority = std::stoi(realtime->substr(policy.size() + 1));
+      }
+    }
+
+    // Check if contains number of decoding threads
+    if (auto threads = parsed_args["threads"]; threads) {
+      if (*threads == "auto") {
+        options.decoder_threads = 0;
+      } else if (*threads == "off") {
+        options.decoder_threads = 1;
+      } else if (int count = std::stoi(*threads); count > 0) {
+        options.decoder_threads = count;
+      } else {
+        std::cerr << "spectrum: invalid value for number of threads\n";
+        return false;
+      }
+    }
+
+    // Check if contains directory for decoded songs cache
+    if (auto cache = parsed_args["cache"]; cache) {
+      options.cache_directory = *cache;
+    }
+
+    // Check if contains maximum size for decoded songs cache
+    if (auto cache_size = parsed_args["cache_size"]; cache_size) {
+      options.cache_size_mb = std::max(std::stoi(*cache_size), 0);
+    }
+
+    // Check if contains output for playback
+    if (auto output = parsed_args["output"]; output) {
+      std::string type = output->substr(0, output->find(':'));
+      std::string value = type.size() < output->size() ? output->substr(type.size() + 1) : "";
+
+      if (type == "alsa") {
+        options.output = driver::PlaybackOutput::Alsa;
+        options.output_device = value;
+      } else if (type == "null" && (value.empty() || value == "paced")) {
+        options.output = driver::PlaybackOutput::Null;
+        options.output_paced = !value.empty();
+      } else if ((type == "wav" || type == "raw") && !value.empty()) {
+        options.output = type == "wav" ? driver::PlaybackOutput::Wav : driver::PlaybackOutput::Raw;
+        options.output_path = value;
+      } else {
+        std::cerr << "spectrum: invalid value for output\n";
+        return false;
+      }
+    }
+
+    // Check if contains audio analysis mode (only for output without user interface)
+    if (auto analysis_mode = parsed_args["analysis"]; analysis_mode) {
+      if (*analysis_mode != "on" && *analysis_mode != "off") {
+        std::cerr << "spectrum: invalid value for analysis\n";
+        return false;
+      }
+
+      analysis = *analysis_mode == "on";
+    }
+
+  } catch (std::logic_error&) {
+    // Got some value that is not a number for buffer depth, number of threads, cache size or
+    // real-time priority
+    std::cerr << "spectrum: invalid value for buffer depth, number of threads, cache size or "
+                 "real-time priority\n";
+    return false;
+
   } catch (util::parsing_error&) {
     // Got some error while trying to parse, or even received help as argument
     // Just let ArgumentParser handle it
@@ -61,16 +280,60 @@ bool parse(int argc, char** argv, std::string& path) {
 
 /* ********************************************************************************************** */
 
+//! Play every song from path without terminal user interface (e.g. rendering into a file)
+void play_headless(const std::shared_ptr<audio::Player>& player, const std::string& path,
+                   bool analysis) {
+  // Number of bars for audio analysis, close to the one calculated for a common terminal width
+  static constexpr int kNumberBars = 40;
+
+  auto queue = player->GetPlayQueue();
+  auto files = middleware::HeadlessController::ListFiles(
+      path.empty() ? std::filesystem::current_path() : std::filesystem::path{path});
+
+  for (const auto& file : files) queue->Enqueue(file.string());
+
+  // Without terminal, MediaController only runs audio analysis on samples received from player
+  std::shared_ptr<middleware::MediaController> analyzer;
+  if (analysis) analyzer = middleware::MediaController::Create(nullptr, player, kNumberBars);
+
+  // Player advances to the next song by itself, controller only waits for the last one
+  auto controller = middleware::HeadlessController::Create(player, queue, analyzer);
+  player->RegisterInterfaceNotifier(controller);
+
+  if (!controller->Start()) {
+    std::cerr << "spectrum: nothing to play\n";
+    return;
+  }
+
+  controller->WaitForCompletion();
+}
+
+/* ********************************************************************************************** */
+
 int main(int argc, char** argv) {
   // In case of getting some unexpected argument or some other error:
   // Do not execute the program
   std::string initial_dir;
-  if (!parse(argc, argv, initial_dir)) {
+  audio::PlayerOptions options{.buffer_depth_ms = audio::PlayerOptions::kDefaultBufferDepth};
+  bool analysis = true;
+  if (!parse(argc, argv, initial_dir, options, analysis)) {
     return EXIT_SUCCESS;
   }
 
   // Create and initialize a new player
-  auto player = audio::Player::Create();
+  auto player = audio::Player::Create(nullptr, nullptr, true, options);
+
+  // Samples are not played on a sound device, so there is no need for a terminal
+  if (options.output != driver::PlaybackOutput::Alsa) {
+    play_headless(player, initial_dir, analysis);
+
+    // Join player threads before writing trace events recorded while playing (if tracing was
+    // enabled), as they would still be recording events otherwise
+    player.reset();
+    util::Tracer::GetInstance().Dump();
+
+    return EXIT_SUCCESS;
+  }
 
   // Create and initialize a new terminal window
   auto terminal = interface::Terminal::Create(initial_dir);
@@ -85,6 +348,9 @@ int main(int argc, char** argv) {
   terminal->RegisterPlayerNotifier(middleware);
   player->RegisterInterfaceNotifier(middleware);
 
+  // Song progress is read straight from player on every render
+  terminal->RegisterPlaybackClock(player->GetPlaybackClock());
+
   // Create a full-size screen and register callbacks
   ftxui::ScreenInteractive screen = ftxui::ScreenInteractive::Fullscreen();
 
@@ -96,5 +362,11 @@ int main(int argc, char** argv) {
   screen.Loop(terminal);
   screen.ResetPosition(true);
 
+  // Join middleware and player threads before writing trace events recorded while playing (if
+  // tracing was enabled), as they would still be recording events otherwise
+  middleware.reset();
+  player.reset();
+  util::Tracer::GetInstance().Dump();
+
   return EXIT_SUCCESS;
 }
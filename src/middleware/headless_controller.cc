@@ -0,0 +1,134 @@
+#include "middleware/headless_controller.h"
+
+#include <algorithm>
+#include <iomanip>
+
+#include "util/logger.h"
+
+namespace middleware {
+
+std::shared_ptr<HeadlessController> HeadlessController::Create(
+    const std::shared_ptr<audio::AudioControl>& player_ctl,
+    const std::shared_ptr<audio::PlayQueue>& queue,
+    const std::shared_ptr<interface::Notifier>& analysis) {
+  LOG("Create new instance of headless controller with analysis=", analysis != nullptr);
+
+  // Same as done by MediaController, to keep the default constructor hidden
+  struct MakeSharedEnabler : public HeadlessController {
+    MakeSharedEnabler(const std::shared_ptr<audio::AudioControl>& player_ctl,
+                      const std::shared_ptr<audio::PlayQueue>& queue,
+                      const std::shared_ptr<interface::Notifier>& analysis)
+        : HeadlessController(player_ctl, queue, analysis) {}
+  };
+
+  return std::make_shared<MakeSharedEnabler>(player_ctl, queue, analysis);
+}
+
+/* ********************************************************************************************** */
+
+HeadlessController::HeadlessController(const std::shared_ptr<audio::AudioControl>& player_ctl,
+                                       const std::shared_ptr<audio::PlayQueue>& queue,
+                                       const std::shared_ptr<interface::Notifier>& analysis)
+    : player_ctl_{player_ctl}, queue_{queue}, analysis_{analysis} {}
+
+/* ********************************************************************************************** */
+
+std::vector<std::filesystem::path> HeadlessController::ListFiles(
+    const std::filesystem::path& path) {
+  std::error_code error;
+  if (!std::filesystem::is_directory(path, error)) return {path};
+
+  std::vector<std::filesystem::path> files;
+
+  for (const auto& entry : std::filesystem::directory_iterator(path, error)) {
+    if (entry.is_regular_file(error)) files.push_back(entry.path());
+  }
+
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+/* ********************************************************************************************** */
+
+bool HeadlessController::Start() {
+  LOG("Start playing songs without user interface, queue size=", queue_->Size());
+
+  if (queue_->Size() == 0) {
+    Finish();
+    return false;
+  }
+
+  PlayNext();
+  return true;
+}
+
+/* ********************************************************************************************** */
+
+void HeadlessController::WaitForCompletion() {
+  std::unique_lock lock(mutex_);
+  finished_cv_.wait(lock, [this] { return finished_; });
+}
+
+/* ********************************************************************************************** */
+
+void HeadlessController::NotifySongInformation(const model::Song& info) {
+  LOG("Playing song with filepath=", std::quoted(info.filepath));
+}
+
+/* ********************************************************************************************** */
+
+void HeadlessController::NotifySongState(const model::Song::CurrentInformation& state) {
+  // Player only notifies it after the last song from play queue
+  if (state.state == model::Song::MediaState::Finished) Finish();
+}
+
+/* ********************************************************************************************** */
+
+void HeadlessController::SendAudioRaw(float* buffer, int size) {
+  if (analysis_) analysis_->SendAudioRaw(buffer, size);
+}
+
+/* ********************************************************************************************** */
+
+void HeadlessController::NotifyPeriodSize(int size) {
+  if (analysis_) analysis_->NotifyPeriodSize(size);
+}
+
+/* ********************************************************************************************** */
+
+void HeadlessController::NotifySampleRate(int sample_rate) {
+  if (analysis_) analysis_->NotifySampleRate(sample_rate);
+}
+
+/* ********************************************************************************************** */
+
+void HeadlessController::NotifyError(error::Code code) {
+  ERROR("Cannot play song, skipping it with error=", code);
+  PlayNext();
+}
+
+/* ********************************************************************************************** */
+
+void HeadlessController::PlayNext() {
+  auto player = player_ctl_.lock();
+  auto filepath = queue_->Next();
+
+  if (!player || !filepath) {
+    Finish();
+    return;
+  }
+
+  player->Play(*filepath);
+}
+
+/* ********************************************************************************************** */
+
+void HeadlessController::Finish() {
+  LOG("Finished playing songs without user interface");
+
+  std::scoped_lock lock(mutex_);
+  finished_ = true;
+  finished_cv_.notify_all();
+}
+
+}  // namespace middleware
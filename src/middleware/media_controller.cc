@@ -48,6 +48,9 @@ std::shared_ptr<MediaController> MediaController::Create(
 
   controller->Init(number_bars, asynchronous);
 
+  // Without terminal (headless mode), audio analysis still runs but there is no UI to show it
+  if (!terminal) return controller;
+
   // As we have no audio analysis output at this point, simply create a dummy output to show in UI
   auto event_bars =
       interface::CustomEvent::DrawAudioSpectrum(std::vector<double>(number_bars, 0.001));
@@ -64,6 +67,7 @@ MediaController::MediaController(const std::shared_ptr<interface::EventDispatche
     : audio::Notifier(),
       interface::Notifier(),
       dispatcher_{dispatcher},
+      headless_{dispatcher == nullptr},
       player_ctl_{player_ctl},
       analyzer_{std::move(analyzer)} {}
 
@@ -130,6 +134,9 @@ void MediaController::AnalysisHandler() {
         analyzer_->Execute(input.data(), static_cast<int>(input.size()), output.data());
         previous = output;
 
+        // There is no UI to send result when running headless
+        if (headless_) break;
+
         auto dispatcher = GetDispatcher();
         if (!dispatcher) break;
 
@@ -243,6 +250,15 @@ void MediaController::ApplyAudioFilters(const model::EqualizerPreset& filters) {
 
 /* ********************************************************************************************** */
 
+void MediaController::NotifyNextFileSelection(const std::filesystem::path& file) {
+  auto player = player_ctl_.lock();
+  if (!player) return;
+
+  player->SetNextSong(file);
+}
+
+/* ********************************************************************************************** */
+
 void MediaController::ClearSongInformation(bool playing) {
   if (playing) sync_data_.Push(Command::RunClearAnimationWithoutRegain);
 
@@ -288,13 +304,39 @@ void MediaController::NotifySongState(const model::Song::CurrentInformation& sta
 
 /* ********************************************************************************************** */
 
-void MediaController::SendAudioRaw(int* buffer, int size) {
+void MediaController::SendAudioRaw(float* buffer, int size) {
   // Append audio data to be analyzed by thread
   sync_data_.Append(buffer, size);
 }
 
 /* ********************************************************************************************** */
 
+void MediaController::NotifyPeriodSize(int size) {
+  LOG("Set period size for audio analysis with value=", size);
+  analyzer_->SetPeriodSize(size);
+}
+
+/* ********************************************************************************************** */
+
+void MediaController::NotifySampleRate(int sample_rate) {
+  LOG("Set sample rate for audio analysis with value=", sample_rate);
+  analyzer_->SetSampleRate(sample_rate);
+}
+
+/* ********************************************************************************************** */
+
+void MediaController::NotifyVolume(model::Volume value) {
+  auto dispatcher = GetDispatcher();
+  if (!dispatcher) return;
+
+  auto event = interface::CustomEvent::UpdateVolume(value);
+
+  // Notify Media Player block to display the new volume
+  dispatcher->SendEvent(event);
+}
+
+/* ********************************************************************************************** */
+
 void MediaController::NotifyError(error::Code code) {
   auto dispatcher = GetDispatcher();
   if (!dispatcher) return;
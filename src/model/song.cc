@@ -20,6 +20,14 @@ bool Song::CurrentInformation::operator!=(const Song::CurrentInformation& other)
   return !operator==(other);
 }
 
+int64_t Song::CurrentInformation::GetMilliseconds() const {
+  return sample_rate > 0 ? position * 1000 / sample_rate : 0;
+}
+
+uint32_t Song::CurrentInformation::GetSeconds() const {
+  return sample_rate > 0 ? static_cast<uint32_t>(position / sample_rate) : 0;
+}
+
 bool Song::operator==(const Song& other) const {
   return std::tie(filepath, artist, title, num_channels, sample_rate, bit_rate, bit_depth, duration,
                   curr_info) == std::tie(other.filepath, other.artist, other.title,
@@ -58,7 +66,8 @@ std::ostream& operator<<(std::ostream& out, const Song::MediaState& state) {
 
 //! Song::CurrentInformation pretty print
 std::ostream& operator<<(std::ostream& out, const Song::CurrentInformation& info) {
-  out << "{state:" << info.state << " position:" << info.position << "}";
+  out << "{state:" << info.state << " position:" << info.position
+      << " sample_rate:" << info.sample_rate << "}";
   return out;
 }
 
@@ -0,0 +1,125 @@
+#include "util/mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include "util/logger.h"
+
+namespace util {
+
+MappedFile::MappedFile(const uint8_t* data, size_t size) : data_{data}, size_{size} {}
+
+/* ********************************************************************************************** */
+
+std::unique_ptr<MappedFile> MappedFile::Create(const std::string& filepath) {
+  int fd = open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    ERROR("Cannot open file to map into memory, errno=", errno);
+    return nullptr;
+  }
+
+  struct stat info {};
+  if (fstat(fd, &info) < 0 || !S_ISREG(info.st_mode) || info.st_size == 0) {
+    LOG("File cannot be mapped into memory, it is not a regular file or it is empty");
+    close(fd);
+    return nullptr;
+  }
+
+  auto size = static_cast<size_t>(info.st_size);
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  // Mapping keeps its own reference to file, so descriptor is not needed anymore
+  close(fd);
+
+  if (data == MAP_FAILED) {
+    ERROR("Cannot map file into memory, errno=", errno);
+    return nullptr;
+  }
+
+  // Content is expected to be read from beginning to end, so kernel can use a bigger read-ahead
+  madvise(data, size, MADV_SEQUENTIAL);
+
+  // Simply extend the MappedFile class, as we do not want to expose the default constructor
+  struct MakeUniqueEnabler : public MappedFile {
+    MakeUniqueEnabler(const uint8_t* data, size_t size) : MappedFile(data, size) {}
+  };
+
+  return std::make_unique<MakeUniqueEnabler>(static_cast<const uint8_t*>(data), size);
+}
+
+/* ********************************************************************************************** */
+
+MappedFile::~MappedFile() { munmap(const_cast<uint8_t*>(data_), size_); }
+
+/* ********************************************************************************************** */
+
+size_t MappedFile::Read(uint8_t* buffer, size_t size) {
+  size_t length = std::min(size, size_ - position_);
+  if (length == 0) return 0;
+
+  // Keep prefetched region ahead of reading, so page faults are unlikely to block
+  if (position_ + length + kPrefetchWindow / 2 > prefetched_) Prefetch();
+
+  std::memcpy(buffer, data_ + position_, length);
+  position_ += length;
+
+  return length;
+}
+
+/* ********************************************************************************************** */
+
+int64_t MappedFile::Seek(int64_t offset, int whence) {
+  int64_t reference = 0;
+
+  switch (whence) {
+    case SEEK_SET:
+      reference = 0;
+      break;
+
+    case SEEK_CUR:
+      reference = static_cast<int64_t>(position_);
+      break;
+
+    case SEEK_END:
+      reference = static_cast<int64_t>(size_);
+      break;
+
+    default:
+      return -1;
+  }
+
+  int64_t target = reference + offset;
+  if (target < 0 || target > static_cast<int64_t>(size_)) return -1;
+
+  position_ = static_cast<size_t>(target);
+
+  // After seeking backwards, prefetched region must follow the new position
+  if (position_ + kPrefetchWindow < prefetched_) prefetched_ = 0;
+
+  return target;
+}
+
+/* ********************************************************************************************** */
+
+void MappedFile::Prefetch() {
+  static const auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+  // Region must start at a page boundary
+  size_t begin = std::max(position_, prefetched_);
+  begin -= begin % page_size;
+
+  size_t end = std::min(size_, position_ + kPrefetchWindow);
+  if (begin >= end) return;
+
+  madvise(const_cast<uint8_t*>(data_) + begin, end - begin, MADV_WILLNEED);
+  prefetched_ = end;
+}
+
+}  // namespace util
@@ -0,0 +1,61 @@
+#include "util/realtime.h"
+
+#include <alloca.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "util/logger.h"
+
+namespace util {
+
+bool SetRealtimeScheduling(RealtimePolicy policy, int priority) {
+  if (policy == RealtimePolicy::None) return false;
+
+  int sched_policy = policy == RealtimePolicy::RoundRobin ? SCHED_RR : SCHED_FIFO;
+
+  sched_param param{};
+  param.sched_priority = std::clamp(priority, sched_get_priority_min(sched_policy),
+                                    sched_get_priority_max(sched_policy));
+
+  if (int result = pthread_setschedparam(pthread_self(), sched_policy, &param); result != 0) {
+    LOG("Cannot set real-time scheduling with policy=", static_cast<int>(policy),
+        " priority=", param.sched_priority, ", keeping normal scheduling, error=",
+        std::strerror(result));
+    return false;
+  }
+
+  LOG("Set real-time scheduling with policy=", static_cast<int>(policy),
+      " priority=", param.sched_priority);
+  return true;
+}
+
+/* ********************************************************************************************** */
+
+bool LockMemory() {
+  if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+    LOG("Cannot lock memory, pages may be swapped out, error=", std::strerror(errno));
+    return false;
+  }
+
+  LOG("Locked current and future pages into memory");
+  return true;
+}
+
+/* ********************************************************************************************** */
+
+void PrefaultStack(size_t size) {
+  // Region from alloca lives in the stack of calling thread, and volatile keeps writes from being
+  // optimized away
+  auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  auto* stack = static_cast<volatile unsigned char*>(alloca(size));
+
+  for (size_t offset = 0; offset < size; offset += page_size) stack[offset] = 0;
+}
+
+}  // namespace util
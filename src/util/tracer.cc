@@ -0,0 +1,97 @@
+#include "util/tracer.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+#include "util/logger.h"
+
+namespace util {
+
+void Tracer::Configure(const std::string& path) {
+  LOG("Enable tracing to filepath=", std::quoted(path));
+
+  path_ = path;
+  epoch_ = Clock::now();
+  enabled_.store(true, std::memory_order_release);
+}
+
+/* ********************************************************************************************** */
+
+void Tracer::Record(const char* name, Clock::time_point begin, Clock::time_point end) {
+  // Ring buffer is created only once for each thread, so it is the only time that locks
+  thread_local ThreadBuffer* buffer = Register();
+
+  size_t count = buffer->count.load(std::memory_order_relaxed);
+
+  buffer->events[count & (kEventsPerThread - 1)] = Event{
+      .name = name,
+      .begin = std::chrono::duration_cast<std::chrono::nanoseconds>(begin - epoch_).count(),
+      .duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count(),
+  };
+
+  buffer->count.store(count + 1, std::memory_order_release);
+}
+
+/* ********************************************************************************************** */
+
+void Tracer::Write(std::ostream& out) const {
+  std::scoped_lock lock(mutex_);
+
+  // Timestamps from Chrome Trace Event format are in microseconds
+  auto to_micro = [](int64_t nanoseconds) { return static_cast<double>(nanoseconds) / 1000.0; };
+
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  out << std::fixed << std::setprecision(3);
+
+  bool first = true;
+
+  for (const auto& buffer : buffers_) {
+    // Events from a thread that is still running may be overwritten while writing them, so only
+    // the ones that were completely recorded are taken (and the oldest are lost after a lap)
+    size_t count = buffer->count.load(std::memory_order_acquire);
+    size_t begin = count > kEventsPerThread ? count - kEventsPerThread : 0;
+
+    for (size_t i = begin; i < count; i++) {
+      const Event& event = buffer->events[i & (kEventsPerThread - 1)];
+
+      out << (first ? "" : ",") << "\n{\"name\":\"" << event.name
+          << "\",\"cat\":\"audio\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id
+          << ",\"ts\":" << to_micro(event.begin) << ",\"dur\":" << to_micro(event.duration) << "}";
+
+      first = false;
+    }
+  }
+
+  out << "\n]}\n";
+}
+
+/* ********************************************************************************************** */
+
+bool Tracer::Dump() const {
+  if (path_.empty()) return false;
+
+  std::ofstream file(path_, std::ios::trunc);
+  if (!file) {
+    ERROR("Cannot open trace file with filepath=", std::quoted(path_));
+    return false;
+  }
+
+  LOG("Write trace events to filepath=", std::quoted(path_));
+  Write(file);
+
+  return file.good();
+}
+
+/* ********************************************************************************************** */
+
+Tracer::ThreadBuffer* Tracer::Register() {
+  std::scoped_lock lock(mutex_);
+
+  int id = static_cast<int>(buffers_.size()) + 1;
+  buffers_.push_back(std::make_unique<ThreadBuffer>(id));
+
+  return buffers_.back().get();
+}
+
+}  // namespace util
@@ -105,6 +105,10 @@ std::ostream& operator<<(std::ostream& out, const CustomEvent::Identifier& i) {
       out << "ApplyAudioFilters";
       break;
 
+    case CustomEvent::Identifier::NotifyNextFileSelection:
+      out << "NotifyNextFileSelection";
+      break;
+
     case CustomEvent::Identifier::Refresh:
       out << "Refresh";
       break;
@@ -309,6 +313,17 @@ CustomEvent CustomEvent::ApplyAudioFilters(const model::EqualizerPreset& filters
 
 /* ********************************************************************************************** */
 
+// Static
+CustomEvent CustomEvent::NotifyNextFileSelection(const std::filesystem::path& file_path) {
+  return CustomEvent{
+      .type = Type::FromInterfaceToAudioThread,
+      .id = Identifier::NotifyNextFileSelection,
+      .content = file_path,
+  };
+}
+
+/* ********************************************************************************************** */
+
 // Static
 CustomEvent CustomEvent::Refresh() {
   return CustomEvent{
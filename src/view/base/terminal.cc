@@ -88,6 +88,15 @@ void Terminal::RegisterPlayerNotifier(const std::shared_ptr<audio::Notifier>& no
 
 /* ********************************************************************************************** */
 
+void Terminal::RegisterPlaybackClock(const std::shared_ptr<const model::PlaybackClock>& clock) {
+  int index = GetIndexFromBlockIdentifier(model::BlockIdentifier::MediaPlayer);
+  auto media_player = std::static_pointer_cast<MediaPlayer>(children_.at(index));
+
+  media_player->SetPlaybackClock(clock);
+}
+
+/* ********************************************************************************************** */
+
 void Terminal::RegisterEventSenderCallback(EventCallback cb) {
   cb_send_event_ = cb;
   cb_send_event_(ftxui::Event::Custom);  // force a refresh to handle any pending custom event
@@ -380,6 +389,11 @@ bool Terminal::HandleEventFromInterfaceToAudioThread(const CustomEvent& event) {
 
     } break;
 
+    case CustomEvent::Identifier::NotifyNextFileSelection: {
+      auto content = event.GetContent<std::filesystem::path>();
+      media_ctl->NotifyNextFileSelection(content);
+    } break;
+
     default:
       event_handled = false;
       break;
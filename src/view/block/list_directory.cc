@@ -167,6 +167,16 @@ bool ListDirectory::OnCustomEvent(const CustomEvent& event) {
 
     // Set current song
     curr_playing_ = event.GetContent<model::Song>().filepath;
+
+#ifndef SPECTRUM_DEBUG
+    // Let player know in advance which file comes next, so it can be played without any gap
+    if (auto file = SelectNextToPlay(); !file.empty()) {
+      LOG("Notify next file to play: ", file);
+      auto dispatcher = GetDispatcher();
+      auto event_next = interface::CustomEvent::NotifyNextFileSelection(file);
+      dispatcher->SendEvent(event_next);
+    }
+#endif
   }
 
   if (event == CustomEvent::Identifier::ClearSongInfo) {
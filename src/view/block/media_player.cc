@@ -1,5 +1,7 @@
 #include "view/block/media_player.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <sstream>
 #include <utility>  // for move
@@ -67,8 +69,9 @@ ftxui::Element MediaPlayer::Render() {
 
   // Only fill these fields when exists a current song playing
   if (IsPlaying() || song_.duration > 0) {
-    position = (float)song_.curr_info.position / (float)song_.duration;
-    curr_time = model::time_to_string(song_.curr_info.position);
+    int64_t milliseconds = GetPosition();
+    position = (float)milliseconds / (float)(song_.duration * 1000);
+    curr_time = model::time_to_string(static_cast<uint32_t>(milliseconds / 1000));
     total_time = model::time_to_string(song_.duration);
   }
 
@@ -220,7 +223,7 @@ bool MediaPlayer::OnEvent(ftxui::Event event) {
     LOG("Handle key to seek forward in current song");
     auto dispatcher = GetDispatcher();
 
-    auto event_seek = interface::CustomEvent::SeekForwardPosition(1);
+    auto event_seek = interface::CustomEvent::SeekForwardPosition(kSeekOffset);
     dispatcher->SendEvent(event_seek);
 
     return true;
@@ -231,7 +234,7 @@ bool MediaPlayer::OnEvent(ftxui::Event event) {
     LOG("Handle key to seek backward in current song");
     auto dispatcher = GetDispatcher();
 
-    auto event_seek = interface::CustomEvent::SeekBackwardPosition(1);
+    auto event_seek = interface::CustomEvent::SeekBackwardPosition(kSeekOffset);
     dispatcher->SendEvent(event_seek);
 
     return true;
@@ -285,20 +288,21 @@ bool MediaPlayer::OnMouseEvent(ftxui::Event event) const {
     // Acquire pointer to dispatcher
     auto dispatcher = GetDispatcher();
 
-    // Calculate new song position based on screen coordinates
+    // Calculate new song position (in milliseconds) based on screen coordinates
     int real_x = event.mouse().x - duration_box_.x_min;
-    auto new_position =
-        (int)floor(floor(song_.duration * real_x) / (duration_box_.x_max - duration_box_.x_min));
+    int64_t new_position = static_cast<int64_t>(song_.duration) * 1000 * real_x /
+                           (duration_box_.x_max - duration_box_.x_min);
 
-    int offset = std::abs(int(new_position - song_.curr_info.position));
+    int64_t curr_position = GetPosition();
+    int offset = static_cast<int>(std::abs(new_position - curr_position));
 
     // Do nothing if result is equal the current position
-    if (new_position == song_.curr_info.position) return true;
+    if (new_position == curr_position) return true;
 
     LOG("Handle left click mouse event on song progress bar");
 
     // Send event to player
-    interface::CustomEvent event_seek = new_position > song_.curr_info.position
+    interface::CustomEvent event_seek = new_position > curr_position
                                             ? interface::CustomEvent::SeekForwardPosition(offset)
                                             : interface::CustomEvent::SeekBackwardPosition(offset);
 
@@ -315,4 +319,19 @@ bool MediaPlayer::OnMouseEvent(ftxui::Event event) const {
   return false;
 }
 
+/* ********************************************************************************************** */
+
+int64_t MediaPlayer::GetPosition() const {
+  // Clock is read right now (extrapolated from the last samples written), so it is always ahead of
+  // the last song state received, which is only updated once per second
+  if (clock_ && IsPlaying()) {
+    if (int64_t position = clock_->GetMilliseconds(); position >= 0) {
+      if (song_.duration > 0) position = std::min<int64_t>(position, song_.duration * 1000LL);
+      return position;
+    }
+  }
+
+  return song_.curr_info.GetMilliseconds();
+}
+
 }  // namespace interface
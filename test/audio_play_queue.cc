@@ -0,0 +1,158 @@
+#include <gmock/gmock-matchers.h>  // for ElementsAre, EXPECT_THAT
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "audio/play_queue.h"
+#include "util/logger.h"
+
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::UnorderedElementsAreArray;
+
+/**
+ * @brief Tests with PlayQueue class
+ */
+class PlayQueueTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() { util::Logger::GetInstance().Configure(); }
+
+  void SetUp() override {
+    for (const auto& song : kSongs) queue.Enqueue(song);
+  }
+
+  //! Advance through queue until it finishes (or reaches maximum number of songs)
+  auto PlayAll(size_t max_songs = 10) -> std::vector<std::string> {
+    std::vector<std::string> played;
+    while (played.size() < max_songs) {
+      auto song = queue.Next();
+      if (!song) break;
+      played.push_back(*song);
+    }
+
+    return played;
+  }
+
+ protected:
+  const std::vector<std::string> kSongs{"a.mp3", "b.mp3", "c.mp3", "d.mp3"};  //!< Initial songs
+
+  audio::PlayQueue queue{/* seed= */ 42};  //!< Fixed seed, so shuffle order is always the same
+};
+
+/* ********************************************************************************************** */
+
+TEST_F(PlayQueueTest, PlayInOrder) {
+  EXPECT_EQ(queue.Size(), 4);
+  EXPECT_EQ(queue.GetCurrent(), std::nullopt);
+
+  // Peek does not advance
+  EXPECT_EQ(queue.PeekNext(), "a.mp3");
+  EXPECT_EQ(queue.PeekNext(), "a.mp3");
+
+  EXPECT_THAT(PlayAll(), ElementsAre("a.mp3", "b.mp3", "c.mp3", "d.mp3"));
+
+  // Queue has finished, but last song is still the current one
+  EXPECT_EQ(queue.PeekNext(), std::nullopt);
+  EXPECT_EQ(queue.GetCurrent(), "d.mp3");
+
+  EXPECT_EQ(queue.Previous(), "c.mp3");
+  EXPECT_EQ(queue.Previous(), "b.mp3");
+  EXPECT_EQ(queue.Previous(), "a.mp3");
+
+  // Already at the first song
+  EXPECT_EQ(queue.Previous(), "a.mp3");
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(PlayQueueTest, InsertAndRemove) {
+  queue.Select("b.mp3");
+  queue.InsertNext("x.mp3");
+
+  EXPECT_THAT(queue.GetItems(), ElementsAre("a.mp3", "b.mp3", "x.mp3", "c.mp3", "d.mp3"));
+  EXPECT_EQ(queue.PeekNext(), "x.mp3");
+
+  // Removing current song keeps the next one
+  EXPECT_TRUE(queue.Remove(1));
+  EXPECT_EQ(queue.PeekNext(), "x.mp3");
+
+  // Removing a song before the current one does not change it either
+  EXPECT_TRUE(queue.Remove(0));
+  EXPECT_FALSE(queue.Remove(10));
+
+  EXPECT_THAT(PlayAll(), ElementsAre("x.mp3", "c.mp3", "d.mp3"));
+
+  queue.Clear();
+  EXPECT_EQ(queue.Size(), 0);
+  EXPECT_EQ(queue.Next(), std::nullopt);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(PlayQueueTest, RepeatModes) {
+  queue.Select("d.mp3");
+
+  queue.SetRepeat(audio::PlayQueue::Repeat::One);
+  EXPECT_EQ(queue.Next(), "d.mp3");
+  EXPECT_EQ(queue.Previous(), "d.mp3");
+
+  // Back to the beginning after the last song, in both directions
+  queue.SetRepeat(audio::PlayQueue::Repeat::All);
+  EXPECT_EQ(queue.Next(), "a.mp3");
+  EXPECT_EQ(queue.Previous(), "d.mp3");
+
+  EXPECT_THAT(PlayAll(6), ElementsAre("a.mp3", "b.mp3", "c.mp3", "d.mp3", "a.mp3", "b.mp3"));
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(PlayQueueTest, ShuffleKeepsCurrentSong) {
+  queue.Select("c.mp3");
+  queue.SetShuffle(true);
+
+  EXPECT_TRUE(queue.IsShuffled());
+  EXPECT_EQ(queue.GetCurrent(), "c.mp3");
+
+  // Every other song is played exactly once, and a song enqueued meanwhile is not skipped
+  queue.Enqueue("e.mp3");
+  auto played = PlayAll();
+
+  EXPECT_THAT(played, UnorderedElementsAreArray({"a.mp3", "b.mp3", "d.mp3", "e.mp3"}));
+
+  // Disabling shuffle goes back to the order in which songs were added
+  queue.SetShuffle(false);
+  EXPECT_EQ(queue.GetCurrent(), played.back());
+  EXPECT_THAT(queue.GetItems(), ElementsAre("a.mp3", "b.mp3", "c.mp3", "d.mp3", "e.mp3"));
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(PlayQueueTest, CountChanges) {
+  uint64_t changes = queue.GetChanges();
+
+  // Reading does not change anything
+  queue.PeekNext();
+  queue.GetCurrent();
+  queue.Size();
+  EXPECT_EQ(queue.GetChanges(), changes);
+
+  // While any change (including advancing) is counted
+  queue.Next();
+  EXPECT_GT(queue.GetChanges(), changes);
+
+  changes = queue.GetChanges();
+  queue.Enqueue("e.mp3");
+  EXPECT_GT(queue.GetChanges(), changes);
+
+  // Removing a song that does not exist changes nothing
+  changes = queue.GetChanges();
+  EXPECT_FALSE(queue.Remove(10));
+  EXPECT_EQ(queue.GetChanges(), changes);
+}
+
+}  // namespace
@@ -0,0 +1,352 @@
+#include <dlfcn.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <pthread.h>
+
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "audio/player.h"
+#include "general/sync_testing.h"
+#include "mock/decoder_mock.h"
+#include "mock/interface_notifier_mock.h"
+#include "mock/playback_mock.h"
+#include "model/application_error.h"
+#include "util/logger.h"
+
+/* ********************************************************************************************** */
+//! Count memory allocations and mutex locks done by a thread (only while tracking is enabled)
+//! P.S.: These replace functions for the whole executable, so only tests from this file are built
+//! into it
+
+namespace {
+
+thread_local bool track_calls = false;  //!< Enable counters for the current thread
+thread_local int allocations = 0;       //!< Number of memory allocations
+thread_local int locks = 0;             //!< Number of mutex locks
+
+}  // namespace
+
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex) {
+  // Forward to the original function from libc
+  using LockFunction = int (*)(pthread_mutex_t*);
+  static auto original = reinterpret_cast<LockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+
+  if (track_calls) locks++;
+  return original(mutex);
+}
+
+void* operator new(size_t size) {
+  if (track_calls) allocations++;
+  if (void* ptr = std::malloc(size == 0 ? 1 : size); ptr) return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+/* ********************************************************************************************** */
+
+namespace {
+
+using ::testing::_;
+using ::testing::AnyNumber;
+using ::testing::Field;
+using ::testing::InSequence;
+using ::testing::Invoke;
+using ::testing::Return;
+
+using testing::TestSyncer;
+
+/**
+ * @brief Tests with Player class, checking that audio thread follows real-time constraints
+ */
+class PlayerTest : public ::testing::Test {
+  // using-declarations
+  using Player = std::shared_ptr<audio::Player>;
+  using NotifierMock = std::shared_ptr<InterfaceNotifierMock>;
+
+ protected:
+  static void SetUpTestSuite() { util::Logger::GetInstance().Configure(); }
+
+  void SetUp() override {
+    // Create mocks
+    PlaybackMock* pb_mock = new PlaybackMock();
+    DecoderMock* dc_mock = new DecoderMock();
+
+    // Setup init expectations
+    {
+      InSequence seq;
+
+      EXPECT_CALL(*pb_mock, CreatePlaybackStream());
+      EXPECT_CALL(*pb_mock, ConfigureParameters());
+      EXPECT_CALL(*pb_mock, GetPeriodSize());
+    }
+
+    notifier = std::make_shared<InterfaceNotifierMock>();
+    EXPECT_CALL(*notifier, NotifyPeriodSize(0));
+    EXPECT_CALL(*pb_mock, SetVolumeListener(_));
+
+    // Create Player without thread, so test decides which thread runs each loop
+    audio_player = audio::Player::Create(pb_mock, dc_mock, /*asynchronous=*/false);
+    audio_player->RegisterInterfaceNotifier(notifier);
+  }
+
+  void TearDown() override {
+    audio_player.reset();
+    notifier.reset();
+  }
+
+  //! Getter for Playback (necessary as inner variable is an unique_ptr)
+  auto GetPlayback() -> PlaybackMock* {
+    return reinterpret_cast<PlaybackMock*>(audio_player->playback_.get());
+  }
+
+  //! Getter for Decoder (necessary as inner variable is an unique_ptr)
+  auto GetDecoder() -> DecoderMock* {
+    return reinterpret_cast<DecoderMock*>(audio_player->decoder_.get());
+  }
+
+  //! Setup decoder used to open next song in advance (gapless playback)
+  auto SetupNextDecoder() -> DecoderMock* {
+    audio_player->next_decoder_ = std::make_unique<DecoderMock>();
+    return reinterpret_cast<DecoderMock*>(audio_player->next_decoder_.get());
+  }
+
+  //! Getter for Public API for Player media control
+  auto GetAudioControl() -> std::shared_ptr<audio::AudioControl> { return audio_player; }
+
+  //! Run audio loop (same one executed as a thread in the real-life)
+  void RunAudioLoop() { audio_player->AudioHandler(); }
+
+  //! Allocate audio buffer between decoding and playback (same as done by Init in real-life)
+  void EnableAudioBuffer(int frames, int period_size) {
+    audio_player->period_size_ = period_size;
+    audio_player->buffer_.samples.Resize(static_cast<size_t>(frames) * 2);
+    audio_player->buffer_.depth = static_cast<size_t>(frames) * 2;
+  }
+
+  //! Run playback loop (same one executed as a thread in the real-life)
+  void RunPlaybackLoop() { audio_player->PlaybackHandler(); }
+
+ protected:
+  Player audio_player;    //!< Audio player responsible for playing songs
+  NotifierMock notifier;  //!< API for audio player to send interface events
+};
+
+/* ********************************************************************************************** */
+
+TEST_F(PlayerTest, NoLockOrAllocationWhileDecoding) {
+  static constexpr int kFrames = 256;   //!< Frames per decoded buffer
+  static constexpr int kBuffers = 200;  //!< Number of decoded buffers measured
+
+  // Audio buffer fits the whole song, so decoding thread never waits for playback thread
+  EnableAudioBuffer(kFrames * (kBuffers + 1), kFrames);
+
+  // Make sure that counters really work, otherwise this test would always pass
+  {
+    std::mutex mutex;
+    track_calls = true;
+    mutex.lock();
+    auto value = std::make_unique<int>(0);
+    track_calls = false;
+    mutex.unlock();
+
+    ASSERT_EQ(locks, 1);
+    ASSERT_EQ(allocations, 1);
+  }
+
+  int decode_locks = -1;
+  int decode_allocations = -1;
+
+  auto player = [&](TestSyncer& syncer) {
+    auto playback = GetPlayback();
+    auto decoder = GetDecoder();
+
+    // Song is long enough to never open the next song in advance
+    EXPECT_CALL(*decoder, OpenFile(_)).WillOnce(Invoke([](model::Song& song) {
+      song.duration = 100;
+      return error::kSuccess;
+    }));
+
+    EXPECT_CALL(*notifier, NotifySongInformation(_));
+
+    EXPECT_CALL(*playback, Prepare()).WillOnce(Return(error::kSuccess));
+
+    // Position does not change, so song state is notified only for the first buffer, and no other
+    // mock is called by audio thread while counting
+    EXPECT_CALL(*decoder, Decode(_, _))
+        .WillOnce(Invoke([&](int dummy, driver::Decoder::AudioCallback callback) {
+          int64_t position = 0;
+          std::vector<float> samples(kFrames * 2);
+          callback(samples.data(), kFrames, position);
+
+          locks = allocations = 0;
+          track_calls = true;
+
+          for (int i = 0; i < kBuffers; i++) callback(samples.data(), kFrames, position);
+
+          track_calls = false;
+          decode_locks = locks;
+          decode_allocations = allocations;
+
+          return error::kSuccess;
+        }));
+
+    // Both are called by playback thread
+    EXPECT_CALL(*notifier, SendAudioRaw(_, _)).Times(AnyNumber());
+    EXPECT_CALL(*playback, AudioCallback(_, _)).WillRepeatedly(Return(error::kSuccess));
+
+    EXPECT_CALL(*notifier, NotifySongState(model::Song::CurrentInformation{
+                               .state = model::Song::MediaState::Play, .position = 0}));
+
+    // These are called by Player::ResetMediaControl()
+    EXPECT_CALL(*decoder, ClearCache());
+    EXPECT_CALL(*notifier, NotifySongState(model::Song::CurrentInformation{
+                               .state = model::Song::MediaState::Finished}));
+    EXPECT_CALL(*notifier, ClearSongInformation(true)).WillOnce(Invoke([&] {
+      syncer.NotifyStep(2);
+    }));
+
+    // Notify that expectations are set, and run audio loop
+    syncer.NotifyStep(1);
+    RunAudioLoop();
+  };
+
+  auto client = [&](TestSyncer& syncer) {
+    auto player_ctl = GetAudioControl();
+    syncer.WaitForStep(1);
+
+    // Ask Audio Player to play file
+    player_ctl->Play("Daft Punk - Something About Us");
+
+    // Wait for Player to finish playing song before client asks to exit
+    syncer.WaitForStep(2);
+    player_ctl->Exit();
+  };
+
+  auto playback = [&](TestSyncer&) { RunPlaybackLoop(); };
+
+  testing::RunAsyncTest({player, client, playback});
+
+  RecordProperty("locks", decode_locks);
+  RecordProperty("allocations", decode_allocations);
+
+  // Without any command to handle, audio thread must not block or allocate memory per buffer
+  EXPECT_EQ(decode_locks, 0);
+  EXPECT_EQ(decode_allocations, 0);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(PlayerTest, NoLockOrAllocationWhileWaitingForNextSong) {
+  static constexpr int kFrames = 256;   //!< Frames per decoded buffer
+  static constexpr int kBuffers = 200;  //!< Number of decoded buffers measured
+
+  const std::string first_song{"Aphex Twin - Xtal"};
+  const std::string next_song{"Aphex Twin - Tha"};
+
+  // Audio buffer fits the whole song, so decoding thread never waits for playback thread
+  EnableAudioBuffer(kFrames * (kBuffers + 1), kFrames);
+
+  auto queue = audio_player->GetPlayQueue();
+  queue->Enqueue(first_song);
+  queue->Enqueue(next_song);
+
+  int decode_locks = -1;
+  int decode_allocations = -1;
+  int finished_songs = 0;
+
+  auto player = [&](TestSyncer& syncer) {
+    auto playback = GetPlayback();
+    auto decoder = GetDecoder();
+    auto next_decoder = SetupNextDecoder();
+
+    EXPECT_CALL(*playback, Prepare()).Times(2).WillRepeatedly(Return(error::kSuccess));
+
+    {
+      InSequence seq;
+
+      // Song is so short that every buffer is decoded while it is time to open the next song
+      EXPECT_CALL(*decoder, OpenFile(Field(&model::Song::filepath, first_song)))
+          .WillOnce(Invoke([](model::Song& song) {
+            song.duration = 1;
+            return error::kSuccess;
+          }));
+      EXPECT_CALL(*notifier, NotifySongInformation(_));
+
+      // Next song from play queue cannot be opened in advance, so it is opened again later
+      EXPECT_CALL(*next_decoder, SetVolume(_)).WillOnce(Return(error::kSuccess));
+      EXPECT_CALL(*next_decoder, OpenFile(Field(&model::Song::filepath, next_song)))
+          .WillOnce(Return(error::kInvalidFile));
+
+      EXPECT_CALL(*decoder, OpenFile(Field(&model::Song::filepath, next_song)))
+          .WillOnce(Return(error::kSuccess));
+      EXPECT_CALL(*notifier, NotifySongInformation(_));
+    }
+
+    // Play queue and next song informed by UI are read only once, by the first buffer, so no
+    // other buffer takes a lock while waiting for current song to finish
+    EXPECT_CALL(*decoder, Decode(_, _))
+        .WillOnce(Invoke([&](int dummy, driver::Decoder::AudioCallback callback) {
+          int64_t position = 0;
+          std::vector<float> samples(kFrames * 2);
+          callback(samples.data(), kFrames, position);
+
+          locks = allocations = 0;
+          track_calls = true;
+
+          for (int i = 0; i < kBuffers; i++) callback(samples.data(), kFrames, position);
+
+          track_calls = false;
+          decode_locks = locks;
+          decode_allocations = allocations;
+
+          return error::kSuccess;
+        }))
+        .WillOnce(Return(error::kSuccess));
+
+    // Both are called by playback thread
+    EXPECT_CALL(*notifier, SendAudioRaw(_, _)).Times(AnyNumber());
+    EXPECT_CALL(*playback, AudioCallback(_, _)).WillRepeatedly(Return(error::kSuccess));
+
+    EXPECT_CALL(*notifier, NotifySongState(_)).Times(AnyNumber());
+
+    // These are called by Player::ResetMediaControl()
+    EXPECT_CALL(*decoder, ClearCache()).Times(2);
+    EXPECT_CALL(*notifier, ClearSongInformation(true)).Times(2).WillRepeatedly(Invoke([&] {
+      if (++finished_songs == 2) syncer.NotifyStep(2);
+    }));
+
+    // Notify that expectations are set, and run audio loop
+    syncer.NotifyStep(1);
+    RunAudioLoop();
+  };
+
+  auto client = [&](TestSyncer& syncer) {
+    auto player_ctl = GetAudioControl();
+    syncer.WaitForStep(1);
+
+    // Ask Audio Player to play the first song from play queue
+    player_ctl->Play(first_song);
+
+    // Wait for Player to finish playing both songs before client asks to exit
+    syncer.WaitForStep(2);
+    player_ctl->Exit();
+  };
+
+  auto playback = [&](TestSyncer&) { RunPlaybackLoop(); };
+
+  testing::RunAsyncTest({player, client, playback});
+
+  RecordProperty("locks", decode_locks);
+  RecordProperty("allocations", decode_allocations);
+
+  EXPECT_EQ(decode_locks, 0);
+  EXPECT_EQ(decode_allocations, 0);
+}
+
+}  // namespace
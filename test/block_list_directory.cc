@@ -3,8 +3,11 @@
 #include <gtest/gtest-message.h>    // for Message
 #include <gtest/gtest-test-part.h>  // for TestPartResult
 
-#include <filesystem>  // for current_path, path
+#include <algorithm>   // for transform
+#include <cctype>      // for tolower
+#include <filesystem>  // for current_path, path, directory_iterator
 #include <memory>      // for __shared_ptr_access
+#include <string>      // for string
 
 #include "ftxui/component/component.hpp"       // for Make
 #include "ftxui/component/component_base.hpp"  // for Component, ComponentBase
@@ -66,16 +69,16 @@ TEST_F(ListDirectoryTest, InitialRender) {
 │test                          │
 │> ..                          │
 │  audio_lyric_finder.cc       │
+│  audio_play_queue.cc         │
 │  audio_player.cc             │
+│  audio_player_realtime.cc    │
 │  block_file_info.cc          │
 │  block_list_directory.cc     │
 │  block_media_player.cc       │
 │  block_tab_viewer.cc         │
 │  CMakeLists.txt              │
-│  driver_fftw.cc              │
-│  general                     │
-│  middleware_media_controller.│
-│  mock                        │
+│  driver_dsp_chain.cc         │
+│  driver_ffmpeg.cc            │
 ╰──────────────────────────────╯)";
 
   EXPECT_THAT(rendered, StrEq(expected));
@@ -99,16 +102,16 @@ TEST_F(ListDirectoryTest, NavigateOnMenu) {
 │test                          │
 │  ..                          │
 │  audio_lyric_finder.cc       │
-│  audio_player.cc             │
-│> block_file_info.cc          │
+│  audio_play_queue.cc         │
+│> audio_player.cc             │
+│  audio_player_realtime.cc    │
+│  block_file_info.cc          │
 │  block_list_directory.cc     │
 │  block_media_player.cc       │
 │  block_tab_viewer.cc         │
 │  CMakeLists.txt              │
-│  driver_fftw.cc              │
-│  general                     │
-│  middleware_media_controller.│
-│  mock                        │
+│  driver_dsp_chain.cc         │
+│  driver_ffmpeg.cc            │
 ╰──────────────────────────────╯)";
 
   EXPECT_THAT(rendered, StrEq(expected));
@@ -117,8 +120,20 @@ TEST_F(ListDirectoryTest, NavigateOnMenu) {
 /* ********************************************************************************************** */
 
 TEST_F(ListDirectoryTest, NavigateToMockDir) {
+  // Select mock directory by its name, counting how many entries are listed after it (so this
+  // keeps working when new test files are added)
+  auto to_lower = [](std::string name) {
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    return name;
+  };
+
+  int entries_after_mock = 0;
+  for (const auto& entry : std::filesystem::directory_iterator(LISTDIR_PATH)) {
+    if (to_lower(entry.path().filename().string()) > "mock") entries_after_mock++;
+  }
+
   block->OnEvent(ftxui::Event::End);
-  block->OnEvent(ftxui::Event::ArrowUp);
+  for (int i = 0; i < entries_after_mock; i++) block->OnEvent(ftxui::Event::ArrowUp);
   block->OnEvent(ftxui::Event::Return);
 
   ftxui::Render(*screen, block->Render());
@@ -159,15 +174,15 @@ TEST_F(ListDirectoryTest, EnterOnSearchMode) {
 │test                          │
 │> ..                          │
 │  audio_lyric_finder.cc       │
+│  audio_play_queue.cc         │
 │  audio_player.cc             │
+│  audio_player_realtime.cc    │
 │  block_file_info.cc          │
 │  block_list_directory.cc     │
 │  block_media_player.cc       │
 │  block_tab_viewer.cc         │
 │  CMakeLists.txt              │
-│  driver_fftw.cc              │
-│  general                     │
-│  middleware_media_controller.│
+│  driver_dsp_chain.cc         │
 │Search:                       │
 ╰──────────────────────────────╯)";
 
@@ -188,16 +203,16 @@ TEST_F(ListDirectoryTest, SingleCharacterInSearchMode) {
 ╭ files ───────────────────────╮
 │test                          │
 │> audio_lyric_finder.cc       │
+│  audio_play_queue.cc         │
 │  audio_player.cc             │
+│  audio_player_realtime.cc    │
 │  block_file_info.cc          │
 │  block_list_directory.cc     │
 │  block_media_player.cc       │
 │  block_tab_viewer.cc         │
 │  CMakeLists.txt              │
-│  driver_fftw.cc              │
-│  general                     │
-│  middleware_media_controller.│
-│  util_argparser.cc           │
+│  driver_dsp_chain.cc         │
+│  driver_ffmpeg.cc            │
 │Search:e                      │
 ╰──────────────────────────────╯)";
 
@@ -281,16 +296,16 @@ TEST_F(ListDirectoryTest, EnterAndExitSearchMode) {
 │test                          │
 │> ..                          │
 │  audio_lyric_finder.cc       │
+│  audio_play_queue.cc         │
 │  audio_player.cc             │
+│  audio_player_realtime.cc    │
 │  block_file_info.cc          │
 │  block_list_directory.cc     │
 │  block_media_player.cc       │
 │  block_tab_viewer.cc         │
 │  CMakeLists.txt              │
-│  driver_fftw.cc              │
-│  general                     │
-│  middleware_media_controller.│
-│  mock                        │
+│  driver_dsp_chain.cc         │
+│  driver_ffmpeg.cc            │
 ╰──────────────────────────────╯)";
 
   EXPECT_THAT(rendered, StrEq(expected));
@@ -308,6 +323,7 @@ TEST_F(ListDirectoryTest, NotifyFileSelection) {
                                     VariantWith<std::filesystem::path>(IsSameFilename(file))))))
       .Times(1);
 
+  block->OnEvent(ftxui::Event::ArrowDown);
   block->OnEvent(ftxui::Event::ArrowDown);
   block->OnEvent(ftxui::Event::ArrowDown);
   block->OnEvent(ftxui::Event::Return);
@@ -321,16 +337,16 @@ TEST_F(ListDirectoryTest, NotifyFileSelection) {
 │test                          │
 │  ..                          │
 │  audio_lyric_finder.cc       │
+│  audio_play_queue.cc         │
 │> audio_player.cc             │
+│  audio_player_realtime.cc    │
 │  block_file_info.cc          │
 │  block_list_directory.cc     │
 │  block_media_player.cc       │
 │  block_tab_viewer.cc         │
 │  CMakeLists.txt              │
-│  driver_fftw.cc              │
-│  general                     │
-│  middleware_media_controller.│
-│  mock                        │
+│  driver_dsp_chain.cc         │
+│  driver_ffmpeg.cc            │
 ╰──────────────────────────────╯)";
 
   EXPECT_THAT(rendered, StrEq(expected));
@@ -359,17 +375,17 @@ TEST_F(ListDirectoryTest, RunTextAnimation) {
   std::string expected = R"(
 ╭ files ───────────────────────╮
 │test                          │
-│  audio_player.cc             │
-│  block_file_info.cc          │
-│  block_list_directory.cc     │
-│  block_media_player.cc       │
-│  block_tab_viewer.cc         │
-│  CMakeLists.txt              │
-│  driver_fftw.cc              │
+│  driver_pcm_cache.cc         │
+│  driver_sample_converter.cc  │
 │  general                     │
+│  middleware_headless_controll│
 │  middleware_media_controller.│
 │  mock                        │
 │  util_argparser.cc           │
+│  util_mapped_file.cc         │
+│  util_mpsc_queue.cc          │
+│  util_ring_buffer.cc         │
+│  util_tracer.cc              │
 │> this_is_a_really_long_pathna│
 ╰──────────────────────────────╯)";
 
@@ -388,17 +404,17 @@ TEST_F(ListDirectoryTest, RunTextAnimation) {
   expected = R"(
 ╭ files ───────────────────────╮
 │test                          │
-│  audio_player.cc             │
-│  block_file_info.cc          │
-│  block_list_directory.cc     │
-│  block_media_player.cc       │
-│  block_tab_viewer.cc         │
-│  CMakeLists.txt              │
-│  driver_fftw.cc              │
+│  driver_pcm_cache.cc         │
+│  driver_sample_converter.cc  │
 │  general                     │
+│  middleware_headless_controll│
 │  middleware_media_controller.│
 │  mock                        │
 │  util_argparser.cc           │
+│  util_mapped_file.cc         │
+│  util_mpsc_queue.cc          │
+│  util_ring_buffer.cc         │
+│  util_tracer.cc              │
 │> is_a_really_long_pathname.mp│
 ╰──────────────────────────────╯)";
 
@@ -498,13 +514,13 @@ TEST_F(ListDirectoryTest, ScrollMenuOnBigList) {
   std::string expected = R"(
 ╭ files ───────────────────────╮
 │test                          │
-│  block_tab_viewer.cc         │
-│  CMakeLists.txt              │
-│  driver_fftw.cc              │
-│  general                     │
 │  middleware_media_controller.│
 │  mock                        │
 │  util_argparser.cc           │
+│  util_mapped_file.cc         │
+│  util_mpsc_queue.cc          │
+│  util_ring_buffer.cc         │
+│  util_tracer.cc              │
 │  some_music_0.mp3            │
 │  some_music_1.mp3            │
 │  some_music_2.mp3            │
@@ -530,6 +546,7 @@ TEST_F(ListDirectoryTest, PlayNextFileAfterFinished) {
                                     VariantWith<std::filesystem::path>(file)))))
       .Times(1);
 
+  block->OnEvent(ftxui::Event::ArrowDown);
   block->OnEvent(ftxui::Event::ArrowDown);
   block->OnEvent(ftxui::Event::ArrowDown);
   block->OnEvent(ftxui::Event::Return);
@@ -543,16 +560,16 @@ TEST_F(ListDirectoryTest, PlayNextFileAfterFinished) {
 │test                          │
 │  ..                          │
 │  audio_lyric_finder.cc       │
+│  audio_play_queue.cc         │
 │> audio_player.cc             │
+│  audio_player_realtime.cc    │
 │  block_file_info.cc          │
 │  block_list_directory.cc     │
 │  block_media_player.cc       │
 │  block_tab_viewer.cc         │
 │  CMakeLists.txt              │
-│  driver_fftw.cc              │
-│  general                     │
-│  middleware_media_controller.│
-│  mock                        │
+│  driver_dsp_chain.cc         │
+│  driver_ffmpeg.cc            │
 ╰──────────────────────────────╯)";
 
   EXPECT_THAT(rendered, StrEq(expected));
@@ -567,6 +584,15 @@ TEST_F(ListDirectoryTest, PlayNextFileAfterFinished) {
                                                                          .bit_depth = 32,
                                                                          .duration = 120});
 
+  // Expect to notify player about next file to play
+  std::filesystem::path next_file{LISTDIR_PATH + std::string{"/audio_player_realtime.cc"}};
+  EXPECT_CALL(*dispatcher,
+              SendEvent(AllOf(Field(&interface::CustomEvent::id,
+                                    interface::CustomEvent::Identifier::NotifyNextFileSelection),
+                              Field(&interface::CustomEvent::content,
+                                    VariantWith<std::filesystem::path>(next_file)))))
+      .Times(1);
+
   derived->OnCustomEvent(event_update);
   EXPECT_EQ(file, derived->curr_playing_.value());
 
@@ -574,8 +600,6 @@ TEST_F(ListDirectoryTest, PlayNextFileAfterFinished) {
   auto event_finish = interface::CustomEvent::UpdateSongState(
       model::Song::CurrentInformation{.state = model::Song::MediaState::Finished});
 
-  std::filesystem::path next_file{LISTDIR_PATH + std::string{"/block_file_info.cc"}};
-
   EXPECT_CALL(*dispatcher,
               SendEvent(AllOf(Field(&interface::CustomEvent::id,
                                     interface::CustomEvent::Identifier::NotifyFileSelection),
@@ -589,6 +613,15 @@ TEST_F(ListDirectoryTest, PlayNextFileAfterFinished) {
   auto& content = std::get<model::Song>(event_update.content);
   content.filepath = next_file;
 
+  // Expect to notify player about next file to play
+  std::filesystem::path next_hint{LISTDIR_PATH + std::string{"/block_file_info.cc"}};
+  EXPECT_CALL(*dispatcher,
+              SendEvent(AllOf(Field(&interface::CustomEvent::id,
+                                    interface::CustomEvent::Identifier::NotifyNextFileSelection),
+                              Field(&interface::CustomEvent::content,
+                                    VariantWith<std::filesystem::path>(next_hint)))))
+      .Times(1);
+
   derived->OnCustomEvent(event_update);
   EXPECT_EQ(next_file, derived->curr_playing_.value());
 }
@@ -600,7 +633,7 @@ TEST_F(ListDirectoryTest, StartPlayingLastFileAndPlayNextAfterFinished) {
   auto derived = std::static_pointer_cast<interface::ListDirectory>(block);
 
   // Setup expectation to play last file
-  std::filesystem::path file{LISTDIR_PATH + std::string{"/util_argparser.cc"}};
+  std::filesystem::path file{LISTDIR_PATH + std::string{"/util_tracer.cc"}};
   EXPECT_CALL(*dispatcher,
               SendEvent(AllOf(Field(&interface::CustomEvent::id,
                                     interface::CustomEvent::Identifier::NotifyFileSelection),
@@ -618,18 +651,18 @@ TEST_F(ListDirectoryTest, StartPlayingLastFileAndPlayNextAfterFinished) {
   std::string expected = R"(
 ╭ files ───────────────────────╮
 │test                          │
-│  audio_lyric_finder.cc       │
-│  audio_player.cc             │
-│  block_file_info.cc          │
-│  block_list_directory.cc     │
-│  block_media_player.cc       │
-│  block_tab_viewer.cc         │
-│  CMakeLists.txt              │
-│  driver_fftw.cc              │
+│  driver_file_sink.cc         │
+│  driver_pcm_cache.cc         │
+│  driver_sample_converter.cc  │
 │  general                     │
+│  middleware_headless_controll│
 │  middleware_media_controller.│
 │  mock                        │
-│> util_argparser.cc           │
+│  util_argparser.cc           │
+│  util_mapped_file.cc         │
+│  util_mpsc_queue.cc          │
+│  util_ring_buffer.cc         │
+│> util_tracer.cc              │
 ╰──────────────────────────────╯)";
 
   EXPECT_THAT(rendered, StrEq(expected));
@@ -644,6 +677,15 @@ TEST_F(ListDirectoryTest, StartPlayingLastFileAndPlayNextAfterFinished) {
                                                                          .bit_depth = 32,
                                                                          .duration = 120});
 
+  // Expect to notify player about next file to play
+  std::filesystem::path next_file{LISTDIR_PATH + std::string{"/audio_lyric_finder.cc"}};
+  EXPECT_CALL(*dispatcher,
+              SendEvent(AllOf(Field(&interface::CustomEvent::id,
+                                    interface::CustomEvent::Identifier::NotifyNextFileSelection),
+                              Field(&interface::CustomEvent::content,
+                                    VariantWith<std::filesystem::path>(next_file)))))
+      .Times(1);
+
   derived->OnCustomEvent(event_update);
   EXPECT_EQ(file, derived->curr_playing_.value());
 
@@ -651,8 +693,6 @@ TEST_F(ListDirectoryTest, StartPlayingLastFileAndPlayNextAfterFinished) {
   auto event_finish = interface::CustomEvent::UpdateSongState(
       model::Song::CurrentInformation{.state = model::Song::MediaState::Finished});
 
-  std::filesystem::path next_file{LISTDIR_PATH + std::string{"/audio_lyric_finder.cc"}};
-
   EXPECT_CALL(*dispatcher,
               SendEvent(AllOf(Field(&interface::CustomEvent::id,
                                     interface::CustomEvent::Identifier::NotifyFileSelection),
@@ -666,6 +706,15 @@ TEST_F(ListDirectoryTest, StartPlayingLastFileAndPlayNextAfterFinished) {
   auto& content = std::get<model::Song>(event_update.content);
   content.filepath = next_file;
 
+  // Expect to notify player about next file to play
+  std::filesystem::path next_hint{LISTDIR_PATH + std::string{"/audio_play_queue.cc"}};
+  EXPECT_CALL(*dispatcher,
+              SendEvent(AllOf(Field(&interface::CustomEvent::id,
+                                    interface::CustomEvent::Identifier::NotifyNextFileSelection),
+                              Field(&interface::CustomEvent::content,
+                                    VariantWith<std::filesystem::path>(next_hint)))))
+      .Times(1);
+
   derived->OnCustomEvent(event_update);
   EXPECT_EQ(next_file, derived->curr_playing_.value());
 }
@@ -3,6 +3,7 @@
 #include "general/block.h"
 #include "general/utils.h"  // for FilterAnsiCommands
 #include "mock/event_dispatcher_mock.h"
+#include "model/playback_clock.h"
 #include "util/logger.h"
 #include "view/block/media_player.h"
 
@@ -118,7 +119,8 @@ TEST_F(MediaPlayerTest, StartPlaying) {
 
   model::Song::CurrentInformation info{
       .state = model::Song::MediaState::Play,
-      .position = 103,
+      .position = 103 * 44100,
+      .sample_rate = 44100,
   };
 
   // Process custom event on block to update song state
@@ -147,6 +149,60 @@ TEST_F(MediaPlayerTest, StartPlaying) {
 
 /* ********************************************************************************************** */
 
+TEST_F(MediaPlayerTest, RenderPositionFromPlaybackClock) {
+  model::Song audio{
+      .filepath = "/another/custom/path/to/music.mp3",
+      .artist = "Mr.Kitty",
+      .title = "After Dark",
+      .num_channels = 2,
+      .sample_rate = 44100,
+      .bit_rate = 256000,
+      .bit_depth = 32,
+      .duration = 259,
+  };
+
+  // Process custom event on block to update song info
+  auto event_update = interface::CustomEvent::UpdateSongInfo(audio);
+  Process(event_update);
+
+  // Last song state received is a few seconds behind
+  model::Song::CurrentInformation info{
+      .state = model::Song::MediaState::Play,
+      .position = 100 * 44100,
+      .sample_rate = 44100,
+  };
+
+  auto event_info = interface::CustomEvent::UpdateSongState(info);
+  Process(event_info);
+
+  // Playback clock holds the audible position, so it takes precedence over song state
+  auto clock = std::make_shared<model::PlaybackClock>();
+  clock->Publish(103 * 44100, 44100, /* running= */ false);
+
+  std::static_pointer_cast<interface::MediaPlayer>(block)->SetPlaybackClock(clock);
+
+  ftxui::Render(*screen, block->Render());
+  std::string rendered = utils::FilterAnsiCommands(screen->ToString());
+
+  std::string expected = R"(
+╭ player ──────────────────────────────────────────────────────╮
+│                                                              │
+│                       ╭──────╮╭──────╮                       │
+│                       │ ⣶  ⣶ ││ ⣶⣶⣶⣶ │                       │
+│                       │ ⣿  ⣿ ││ ⣿⣿⣿⣿ │                       │
+│                       │ ⠿  ⠿ ││ ⠿⠿⠿⠿ │                       │
+│                       ╰──────╯╰──────╯      Volume: 100%     │
+│                                                              │
+│     ████████████████████▋                                    │
+│     01:43                                          04:19     │
+│                                                              │
+╰──────────────────────────────────────────────────────────────╯)";
+
+  EXPECT_THAT(rendered, StrEq(expected));
+}
+
+/* ********************************************************************************************** */
+
 TEST_F(MediaPlayerTest, PauseAndResume) {
   model::Song audio{
       .filepath = "/another/custom/path/to/music.mp3",
@@ -165,7 +221,8 @@ TEST_F(MediaPlayerTest, PauseAndResume) {
 
   model::Song::CurrentInformation info{
       .state = model::Song::MediaState::Pause,
-      .position = 11,
+      .position = 11 * 44100,
+      .sample_rate = 44100,
   };
 
   // Process custom event on block to update song state, pause song
@@ -196,7 +253,8 @@ TEST_F(MediaPlayerTest, PauseAndResume) {
 
   event_info.content = model::Song::CurrentInformation{
       .state = model::Song::MediaState::Play,
-      .position = 12,
+      .position = 12 * 44100,
+      .sample_rate = 44100,
   };
 
   // Process custom event on block to resume song
@@ -343,7 +401,8 @@ TEST_F(MediaPlayerTest, StartPlayingAndClear) {
 
   model::Song::CurrentInformation info{
       .state = model::Song::MediaState::Play,
-      .position = 103,
+      .position = 103 * 44100,
+      .sample_rate = 44100,
   };
 
   // Process custom event on block to update song state
@@ -415,7 +474,8 @@ TEST_F(MediaPlayerTest, StartPlayingAndSendKeyboardCommands) {
 
   model::Song::CurrentInformation info{
       .state = model::Song::MediaState::Play,
-      .position = 103,
+      .position = 103 * 44100,
+      .sample_rate = 44100,
   };
 
   // Process custom event on block to update song state
@@ -522,7 +582,8 @@ TEST_F(MediaPlayerTest, StartPlayingAndStop) {
 
   model::Song::CurrentInformation info{
       .state = model::Song::MediaState::Play,
-      .position = 83,
+      .position = 83 * 44100,
+      .sample_rate = 44100,
   };
 
   // Process custom event on block to update song state
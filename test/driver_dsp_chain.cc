@@ -0,0 +1,188 @@
+#include <gmock/gmock-matchers.h>  // for StrEq, EXPECT_THAT
+#include <gmock/gmock.h>
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "audio/driver/dsp_chain.h"
+#include "model/audio_filter.h"
+#include "model/volume.h"
+
+namespace {
+
+using Kernel = driver::DspChain::Kernel;
+
+/**
+ * @brief Tests with DspChain class
+ */
+class DspChainTest : public ::testing::Test {
+ protected:
+  //! Create interleaved stereo sine wave (same content for both channels)
+  static std::vector<float> CreateSineWave(double frequency, float amplitude, int frames) {
+    const double kPi = std::acos(-1);
+    std::vector<float> samples(frames * kChannels);
+
+    for (int i = 0; i < frames; i++) {
+      auto value = static_cast<float>(amplitude * std::sin(2 * kPi * frequency * i / kSampleRate));
+      std::fill_n(samples.begin() + i * kChannels, kChannels, value);
+    }
+
+    return samples;
+  }
+
+  //! Run DspChain over the whole input, splitting it into buffers like the decoder does
+  static std::vector<float> Process(driver::DspChain& chain, const std::vector<float>& input) {
+    std::vector<float> output(input.size());
+    const int frames = static_cast<int>(input.size()) / kChannels;
+
+    for (int offset = 0; offset < frames; offset += kBufferSize) {
+      int size = std::min(kBufferSize, frames - offset);
+      chain.Process(input.data() + offset * kChannels, output.data() + offset * kChannels, size);
+    }
+
+    return output;
+  }
+
+  //! Calculate RMS value from samples, ignoring the first ones (filter transient)
+  static double CalculateRms(const std::vector<float>& samples) {
+    double sum = 0;
+    size_t count = 0;
+
+    for (size_t i = kTransient * kChannels; i < samples.size(); i++, count++) {
+      sum += static_cast<double>(samples[i]) * samples[i];
+    }
+
+    return std::sqrt(sum / count);
+  }
+
+ protected:
+  static constexpr int kSampleRate = 44100;  //!< Sample rate
+  static constexpr int kChannels = 2;        //!< Number of interleaved channels
+  static constexpr int kFrames = 44100;      //!< Number of frames processed on each test
+  static constexpr int kBufferSize = 1024;   //!< Maximum number of frames per buffer
+  static constexpr int kTransient = 4410;    //!< Frames ignored while filters settle down
+};
+
+/* ********************************************************************************************** */
+
+TEST_F(DspChainTest, FlatPresetKeepsSignal) {
+  driver::DspChain chain{kChannels, kSampleRate};
+  chain.UpdateFilters(model::AudioFilter::CreatePresets()["Custom"]);
+
+  auto input = CreateSineWave(440, 0.5f, kFrames);
+  auto output = Process(chain, input);
+
+  for (size_t i = 0; i < input.size(); i++) {
+    ASSERT_NEAR(output[i], input[i], 1e-6);
+  }
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(DspChainTest, ApplyVolume) {
+  driver::DspChain chain{kChannels, kSampleRate};
+  chain.UpdateFilters(model::AudioFilter::CreatePresets()["Custom"]);
+
+  auto input = CreateSineWave(440, 0.5f, kFrames);
+  double original = CalculateRms(Process(chain, input));
+
+  chain.SetVolume(model::Volume{0.5f});
+  double attenuated = CalculateRms(Process(chain, input));
+
+  EXPECT_NEAR(attenuated / original, 0.5, 0.01);
+
+  // Muted volume must result in silence
+  model::Volume muted{1.f};
+  muted.ToggleMute();
+  chain.SetVolume(muted);
+
+  EXPECT_EQ(CalculateRms(Process(chain, input)), 0);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(DspChainTest, BoostAndCutAtCenterFrequency) {
+  model::EqualizerPreset preset = model::AudioFilter::CreatePresets()["Custom"];
+  auto& band = preset[5];  // 1kHz
+
+  driver::DspChain chain{kChannels, kSampleRate};
+  chain.UpdateFilters(preset);
+
+  auto input = CreateSineWave(band.frequency, 0.1f, kFrames);
+  double flat = CalculateRms(Process(chain, input));
+
+  // Gain is expected to be close to the one set for the band (neighbour bands are flat)
+  band.gain = model::AudioFilter::kMaxGain;
+  chain.UpdateFilters(preset);
+  double boost = 20 * std::log10(CalculateRms(Process(chain, input)) / flat);
+
+  EXPECT_NEAR(boost, model::AudioFilter::kMaxGain, 0.5);
+
+  band.gain = model::AudioFilter::kMinGain;
+  chain.UpdateFilters(preset);
+  double cut = 20 * std::log10(CalculateRms(Process(chain, input)) / flat);
+
+  EXPECT_NEAR(cut, model::AudioFilter::kMinGain, 0.5);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(DspChainTest, KeepHeadroomAboveFullScale) {
+  model::EqualizerPreset preset = model::AudioFilter::CreatePresets()["Custom"];
+  auto& band = preset[5];  // 1kHz
+  band.gain = model::AudioFilter::kMaxGain;
+
+  driver::DspChain chain{kChannels, kSampleRate};
+  chain.UpdateFilters(preset);
+
+  auto output = Process(chain, CreateSineWave(band.frequency, 1.f, kFrames));
+
+  // Output is not clamped, it is up to the playback to saturate it on conversion
+  auto [min, max] = std::minmax_element(output.begin(), output.end());
+
+  EXPECT_GT(*max, 1.f);
+  EXPECT_LT(*min, -1.f);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(DspChainTest, KernelsMatchScalarImplementation) {
+  const model::EqualizerPreset preset = model::AudioFilter::CreatePresets()["Rock"];
+  auto input = CreateSineWave(64, 0.3f, kFrames);
+
+  // Add some high frequency content, so all bands have something to do
+  auto treble = CreateSineWave(9000, 0.2f, kFrames);
+  for (size_t i = 0; i < input.size(); i++) input[i] += treble[i];
+
+  driver::DspChain reference{kChannels, kSampleRate, Kernel::Scalar};
+  reference.SetVolume(model::Volume{0.8f});
+  reference.UpdateFilters(preset);
+
+  ASSERT_EQ(reference.GetKernel(), Kernel::Scalar);
+  auto expected = Process(reference, input);
+
+  for (auto kernel : {Kernel::Sse, Kernel::Avx2, Kernel::Neon}) {
+    if (!driver::DspChain::IsSupported(kernel)) continue;
+
+    driver::DspChain chain{kChannels, kSampleRate, kernel};
+    chain.SetVolume(model::Volume{0.8f});
+    chain.UpdateFilters(preset);
+
+    ASSERT_EQ(chain.GetKernel(), kernel);
+    auto output = Process(chain, input);
+
+    // Fused multiply-add rounds differently, so accept a minimal difference (less than 1 LSB from
+    // a 16-bit sample)
+    for (size_t i = 0; i < output.size(); i++) {
+      ASSERT_LE(std::abs(output[i] - expected[i]), 1.f / 32768)
+          << "kernel=" << static_cast<int>(kernel) << " index=" << i;
+    }
+  }
+}
+
+}  // namespace
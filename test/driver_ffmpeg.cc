@@ -0,0 +1,300 @@
+#include <gmock/gmock-matchers.h>  // for StrEq, EXPECT_THAT
+#include <gmock/gmock.h>
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+#include "audio/driver/ffmpeg.h"
+#include "model/application_error.h"
+#include "model/audio_filter.h"
+#include "model/song.h"
+#include "util/logger.h"
+
+namespace {
+
+/**
+ * @brief Tests with FFmpeg class
+ */
+class FFmpegTest : public ::testing::Test {
+  // using-declarations
+  using FFmpeg = std::unique_ptr<driver::FFmpeg>;
+
+ protected:
+  static void SetUpTestSuite() { util::Logger::GetInstance().Configure(); }
+
+  void SetUp() override {
+    filepath = std::filesystem::temp_directory_path() / "spectrum_ffmpeg_test.wav";
+    CreateWaveFile();
+
+    decoder = std::make_unique<driver::FFmpeg>();
+  }
+
+  void TearDown() override {
+    decoder.reset();
+    std::filesystem::remove(filepath);
+  }
+
+  //! Write a stereo sine wave into a WAV file (using the same format as decoder output)
+  void CreateWaveFile() const {
+    std::ofstream file(filepath, std::ios::binary);
+
+    // Write value in little-endian
+    auto write = [&file](uint32_t value, int bytes) {
+      for (int i = 0; i < bytes; i++) file.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+    };
+
+    const uint32_t frames = kSampleRate * kDuration;
+    const uint32_t data_size = frames * kChannels * sizeof(int16_t);
+
+    // RIFF header
+    file << "RIFF";
+    write(36 + data_size, 4);
+    file << "WAVE";
+
+    // Format chunk (PCM)
+    file << "fmt ";
+    write(16, 4);
+    write(1, 2);
+    write(kChannels, 2);
+    write(kSampleRate, 4);
+    write(kSampleRate * kChannels * sizeof(int16_t), 4);
+    write(kChannels * sizeof(int16_t), 2);
+    write(16, 2);
+
+    // Data chunk
+    file << "data";
+    write(data_size, 4);
+
+    const double kPi = std::acos(-1);
+    for (uint32_t i = 0; i < frames; i++) {
+      auto sample = static_cast<int16_t>(8000 * std::sin(2 * kPi * 440 * i / kSampleRate));
+      for (int channel = 0; channel < kChannels; channel++) write(static_cast<uint16_t>(sample), 2);
+    }
+  }
+
+  //! Getter for number of times that filtergraph was rebuilt while decoding
+  int GetGraphRebuilds() const { return decoder->graph_rebuilds_; }
+
+  //! Check if running filtergraph has reached parameters from the latest filters update
+  bool FiltersApplied() const { return decoder->applied_filters_ == decoder->audio_filters_; }
+
+  //! Choose threading for the decoder found for codec
+  static auto ChooseThreading(AVCodecID codec_id, int requested) {
+    return driver::FFmpeg::ChooseThreading(avcodec_find_decoder(codec_id), requested);
+  }
+
+  //! Getter for number of threads used by the opened codec
+  int GetThreadCount() const { return decoder->decoder_->thread_count; }
+
+  //! Check if opened song is served from cache (instead of being decoded)
+  bool IsPlayingFromCache() const { return decoder->cached_song_ != nullptr; }
+
+ protected:
+  static constexpr int kSampleRate = 44100;  //!< Sample rate from WAV file
+  static constexpr int kChannels = 2;        //!< Number of channels from WAV file
+  static constexpr int kDuration = 3;        //!< WAV file duration (in seconds)
+  static constexpr int kSamples = 1024;      //!< Maximum number of samples per decoded buffer
+
+  std::filesystem::path filepath;  //!< Temporary WAV file
+  FFmpeg decoder;                  //!< Audio decoder and equalizer
+};
+
+/* ********************************************************************************************** */
+
+TEST_F(FFmpegTest, DragFrequencyBarWithoutRebuildingGraph) {
+  model::EqualizerPreset preset = model::AudioFilter::CreatePresets()["Custom"];
+  ASSERT_EQ(decoder->UpdateFilters(preset), error::kSuccess);
+
+  model::Song song{.filepath = filepath.string()};
+  ASSERT_EQ(decoder->OpenFile(song), error::kSuccess);
+
+  // Simulate user dragging a frequency bar from minimum to maximum gain, sending a new preset to
+  // decoder for each buffer (in the same way that Player does when it receives commands from UI)
+  auto& bar = preset[4];
+  bar.gain = model::AudioFilter::kMinGain;
+
+  int buffers = 0;
+  error::Code result = decoder->Decode(kSamples, [&](void*, int, int64_t&) {
+    if (bar.gain < model::AudioFilter::kMaxGain) {
+      bar.SetNormalizedGain(bar.gain + 1);
+      EXPECT_EQ(decoder->UpdateFilters(preset), error::kSuccess);
+    }
+
+    buffers++;
+    return true;
+  });
+
+  EXPECT_EQ(result, error::kSuccess);
+  EXPECT_GT(buffers, model::AudioFilter::kMaxGain - model::AudioFilter::kMinGain);
+
+  // Gain changes must be applied to existing equalizer filters
+  EXPECT_EQ(GetGraphRebuilds(), 0);
+  EXPECT_TRUE(FiltersApplied());
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(FFmpegTest, ChangeBandsRebuildingGraph) {
+  model::EqualizerPreset preset = model::AudioFilter::CreatePresets()["Custom"];
+  ASSERT_EQ(decoder->UpdateFilters(preset), error::kSuccess);
+
+  model::Song song{.filepath = filepath.string()};
+  ASSERT_EQ(decoder->OpenFile(song), error::kSuccess);
+
+  // Move the highest band to another frequency in the middle of decoding
+  model::EqualizerPreset other = preset;
+  other.back().frequency = 12000;
+
+  bool updated = false;
+  error::Code result = decoder->Decode(kSamples, [&](void*, int, int64_t&) {
+    if (!updated) {
+      updated = true;
+      EXPECT_EQ(decoder->UpdateFilters(other), error::kSuccess);
+    }
+
+    return true;
+  });
+
+  EXPECT_EQ(result, error::kSuccess);
+
+  // A different set of bands requires a new filtergraph
+  EXPECT_EQ(GetGraphRebuilds(), 1);
+  EXPECT_TRUE(FiltersApplied());
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(FFmpegTest, ChangeBandsWithNativeDspBackend) {
+  decoder = std::make_unique<driver::FFmpeg>(driver::DspBackend::Native);
+
+  model::EqualizerPreset preset = model::AudioFilter::CreatePresets()["Custom"];
+  ASSERT_EQ(decoder->UpdateFilters(preset), error::kSuccess);
+
+  model::Song song{.filepath = filepath.string()};
+  ASSERT_EQ(decoder->OpenFile(song), error::kSuccess);
+
+  // Move the highest band to another frequency in the middle of decoding
+  model::EqualizerPreset other = preset;
+  other.back().frequency = 12000;
+
+  bool updated = false;
+  float peak = 0;
+
+  error::Code result = decoder->Decode(kSamples, [&](void* buffer, int size, int64_t&) {
+    if (!updated) {
+      updated = true;
+      EXPECT_EQ(decoder->UpdateFilters(other), error::kSuccess);
+    }
+
+    // Output must be the same sine wave from file (as all bands are flat)
+    auto samples = static_cast<float*>(buffer);
+    for (int i = 0; i < size * kChannels; i++) peak = std::max(peak, samples[i]);
+
+    return true;
+  });
+
+  EXPECT_EQ(result, error::kSuccess);
+  EXPECT_NEAR(peak * 32768, 8000, 1);
+
+  // Filtergraph is used only for decoding, so it is never rebuilt
+  EXPECT_EQ(GetGraphRebuilds(), 0);
+  EXPECT_TRUE(FiltersApplied());
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(FFmpegTest, SeekWhileDrainingLastSamples) {
+  model::Song song{.filepath = filepath.string()};
+  ASSERT_EQ(decoder->OpenFile(song), error::kSuccess);
+
+  const int64_t total = kSampleRate * kDuration;
+
+  int last_size = 0;
+  int64_t played = 0;
+
+  error::Code result = decoder->Decode(kSamples, [&](void*, int size, int64_t& position) {
+    // Last buffer is smaller than the others, as it is pulled while flushing filtergraph, so seek
+    // backward right there
+    if (last_size == 0 && position + size == total) {
+      EXPECT_LT(size, kSamples);
+      last_size = size;
+      position = kSampleRate;
+      return true;
+    }
+
+    played += size;
+    return true;
+  });
+
+  EXPECT_EQ(result, error::kSuccess);
+  ASSERT_GT(last_size, 0);
+
+  // Song must be played again from the requested position until its end
+  EXPECT_EQ(played, (total - last_size) + (total - kSampleRate));
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(FFmpegTest, FindCachedSongAfterChangingSampleRate) {
+  auto directory = std::filesystem::temp_directory_path() / "spectrum_ffmpeg_cache_test";
+  auto cache = driver::PcmCache::Create(directory, 64 * 1024 * 1024);
+  ASSERT_NE(cache, nullptr);
+
+  const model::AudioFormat format{48000, kChannels, 16};
+  model::Song song{.filepath = filepath.string()};
+
+  // Decode song until its end using another sample rate, so it is stored in cache
+  decoder = std::make_unique<driver::FFmpeg>(driver::DspBackend::Filtergraph, true,
+                                             driver::FFmpeg::kAutoThreads, cache);
+
+  ASSERT_EQ(decoder->OpenFile(song), error::kSuccess);
+  ASSERT_EQ(decoder->SetOutputFormat(format, /*passthrough=*/true), error::kSuccess);
+  ASSERT_EQ(decoder->Decode(kSamples, [](void*, int, int64_t&) { return true; }),
+            error::kSuccess);
+  decoder->ClearCache();
+
+  // New decoder opens song with its default sample rate, so song is only found in cache after
+  // agreeing on the output format
+  decoder = std::make_unique<driver::FFmpeg>(driver::DspBackend::Filtergraph, true,
+                                             driver::FFmpeg::kAutoThreads, cache);
+
+  ASSERT_EQ(decoder->OpenFile(song), error::kSuccess);
+  EXPECT_FALSE(IsPlayingFromCache());
+
+  ASSERT_EQ(decoder->SetOutputFormat(format, /*passthrough=*/true), error::kSuccess);
+  EXPECT_TRUE(IsPlayingFromCache());
+
+  decoder.reset();
+  std::filesystem::remove_all(directory);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(FFmpegTest, ThreadingFollowsCodecPolicy) {
+  // Codec with small frames (or without threading support) always decodes on a single thread
+  EXPECT_EQ(ChooseThreading(AV_CODEC_ID_PCM_S16LE, driver::FFmpeg::kAutoThreads).count, 1);
+  EXPECT_EQ(ChooseThreading(AV_CODEC_ID_PCM_S16LE, 4).count, 1);
+
+  model::Song song{.filepath = filepath.string()};
+  ASSERT_EQ(decoder->OpenFile(song), error::kSuccess);
+  EXPECT_EQ(GetThreadCount(), 1);
+
+  // Otherwise, threading follows the requested mode
+  EXPECT_EQ(ChooseThreading(AV_CODEC_ID_FLAC, driver::FFmpeg::kNoThreads).count, 1);
+
+  auto fixed = ChooseThreading(AV_CODEC_ID_FLAC, 3);
+  EXPECT_EQ(fixed.count, 3);
+  EXPECT_TRUE(fixed.type & FF_THREAD_FRAME);
+
+  auto automatic = ChooseThreading(AV_CODEC_ID_FLAC, driver::FFmpeg::kAutoThreads);
+  EXPECT_GE(automatic.count, 1);
+  EXPECT_LE(automatic.count, 4);
+}
+
+}  // namespace
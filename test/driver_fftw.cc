@@ -3,6 +3,7 @@
 #include <gtest/gtest-message.h>    // for Message
 #include <gtest/gtest-test-part.h>  // for TestPartResult
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <memory>
@@ -98,4 +99,33 @@ TEST_F(FftwTest, InitAndExecute) {
   ASSERT_THAT(right, ElementsAreArray(expected_2000MHz));
 }
 
+/* ********************************************************************************************** */
+
+TEST_F(FftwTest, FollowSampleRate) {
+  constexpr int kSampleRate = 48000;
+  analyzer->SetSampleRate(kSampleRate);
+
+  int out_size = analyzer->GetOutputSize();
+  std::vector<double> out(out_size, 0);
+  std::vector<double> in(kBufferSize, 0);
+
+  // Same signals from InitAndExecute, but sampled at 48kHz
+  for (int k = 0; k < 300; k++) {
+    for (int n = 0; n < kBufferSize / 2; n++) {
+      double t = (n + (double)k * kBufferSize / 2) / kSampleRate;
+      in[n * 2] = sin(2 * M_PI * 200 * t) * 20000;
+      in[n * 2 + 1] = sin(2 * M_PI * 2000 * t) * 20000;
+    }
+
+    analyzer->Execute(in.data(), kBufferSize, out.data());
+  }
+
+  // Each signal must still show up on the same bars as when sampled at 44.1kHz
+  auto left = std::max_element(out.begin(), out.begin() + kNumberBars);
+  EXPECT_EQ(std::distance(out.begin(), left), 2);
+
+  const double* right = out.data() + kNumberBars;
+  EXPECT_GT(right[6] + right[7], 0.9);
+}
+
 }  // namespace
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "audio/driver/file_sink.h"
+
+namespace {
+
+/**
+ * @brief Tests with FileSink class
+ */
+class FileSinkTest : public ::testing::Test {
+ protected:
+  void SetUp() override { path = std::filesystem::temp_directory_path() / "spectrum_sink.wav"; }
+
+  void TearDown() override { std::filesystem::remove(path); }
+
+  //! Create sink with output file ready to write
+  auto CreateSink(driver::FileSink::Container container) -> std::unique_ptr<driver::FileSink> {
+    auto sink = std::make_unique<driver::FileSink>(path, container, /*dither=*/false);
+    EXPECT_EQ(sink->CreatePlaybackStream(), error::kSuccess);
+    return sink;
+  }
+
+  //! Write the same stereo frame (left, right) multiple times
+  static void WriteFrames(driver::FileSink& sink, int frames, float left, float right) {
+    std::vector<float> samples;
+    for (int i = 0; i < frames; i++) samples.insert(samples.end(), {left, right});
+
+    EXPECT_EQ(sink.AudioCallback(samples.data(), frames), error::kSuccess);
+  }
+
+  //! Read whole output file
+  auto ReadFile() const -> std::vector<uint8_t> {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), {});
+  }
+
+  //! Read little-endian field from file content
+  template <typename T>
+  static T Get(const std::vector<uint8_t>& content, size_t offset) {
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); i++) value |= static_cast<T>(content[offset + i]) << (8 * i);
+    return value;
+  }
+
+ protected:
+  std::filesystem::path path;  //!< Output file
+};
+
+/* ********************************************************************************************** */
+
+TEST_F(FileSinkTest, WriteWavFile) {
+  auto sink = CreateSink(driver::FileSink::Container::Wav);
+
+  ASSERT_EQ(sink->SetFormat(model::AudioFormat{48000, 2, 16}), error::kSuccess);
+  WriteFrames(*sink, 3, 0.5f, -0.5f);
+  EXPECT_EQ(sink->Stop(), error::kSuccess);
+
+  auto content = ReadFile();
+  ASSERT_EQ(content.size(), 44 + 3 * 2 * sizeof(int16_t));
+
+  EXPECT_EQ(std::memcmp(content.data(), "RIFF", 4), 0);
+  EXPECT_EQ(Get<uint32_t>(content, 4), content.size() - 8);
+  EXPECT_EQ(std::memcmp(content.data() + 8, "WAVEfmt ", 8), 0);
+  EXPECT_EQ(Get<uint16_t>(content, 20), 1);       // integer PCM
+  EXPECT_EQ(Get<uint16_t>(content, 22), 2);       // channels
+  EXPECT_EQ(Get<uint32_t>(content, 24), 48000);   // sample rate
+  EXPECT_EQ(Get<uint32_t>(content, 28), 192000);  // byte rate
+  EXPECT_EQ(Get<uint16_t>(content, 32), 4);       // block align
+  EXPECT_EQ(Get<uint16_t>(content, 34), 16);      // bit depth
+  EXPECT_EQ(std::memcmp(content.data() + 36, "data", 4), 0);
+  EXPECT_EQ(Get<uint32_t>(content, 40), 12);
+
+  EXPECT_EQ(static_cast<int16_t>(Get<uint16_t>(content, 44)), 16384);
+  EXPECT_EQ(static_cast<int16_t>(Get<uint16_t>(content, 46)), -16384);
+
+  EXPECT_EQ(sink->GetStatistics().frames, 3);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(FileSinkTest, AppendSongsToSameFile) {
+  auto sink = CreateSink(driver::FileSink::Container::Wav);
+  WriteFrames(*sink, 2, 0.f, 0.f);
+  sink->Stop();
+
+  // Header is kept up to date after each song
+  WriteFrames(*sink, 5, 0.f, 0.f);
+  sink->Stop();
+
+  auto content = ReadFile();
+  EXPECT_EQ(content.size(), 44 + 7 * 4);
+  EXPECT_EQ(Get<uint32_t>(content, 40), 7 * 4);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(FileSinkTest, FormatIsFixedAfterFirstSample) {
+  auto sink = CreateSink(driver::FileSink::Container::Raw);
+
+  // Any integer format is accepted before writing samples
+  EXPECT_TRUE(sink->IsFormatSupported(model::AudioFormat{96000, 2, 32}));
+  EXPECT_FALSE(sink->IsFormatSupported(model::AudioFormat{96000, 2, 24}));
+
+  ASSERT_EQ(sink->SetFormat(model::AudioFormat{96000, 2, 32}), error::kSuccess);
+  WriteFrames(*sink, 1, 1.f, -1.f);
+
+  EXPECT_TRUE(sink->IsFormatSupported(model::AudioFormat{96000, 2, 32}));
+  EXPECT_FALSE(sink->IsFormatSupported(model::AudioFormat{44100, 2, 16}));
+  EXPECT_NE(sink->SetFormat(model::AudioFormat{44100, 2, 16}), error::kSuccess);
+
+  // Raw file holds only samples
+  sink.reset();
+  auto content = ReadFile();
+  ASSERT_EQ(content.size(), 2 * sizeof(int32_t));
+
+  EXPECT_EQ(static_cast<int32_t>(Get<uint32_t>(content, 0)), INT32_MAX);
+  EXPECT_EQ(static_cast<int32_t>(Get<uint32_t>(content, 4)), INT32_MIN);
+}
+
+}  // namespace
@@ -0,0 +1,172 @@
+#include <gmock/gmock-matchers.h>  // for ElementsAre, EXPECT_THAT
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "audio/driver/pcm_cache.h"
+#include "model/song.h"
+
+namespace {
+
+using ::testing::ElementsAre;
+
+/**
+ * @brief Tests with PcmCache class
+ */
+class PcmCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    directory = std::filesystem::temp_directory_path() / "spectrum_pcm_cache";
+    std::filesystem::remove_all(directory);
+
+    cache = driver::PcmCache::Create(directory, kMaxSize);
+    ASSERT_NE(cache, nullptr);
+
+    for (const auto& name : {"song_a.mp3", "song_b.mp3", "song_c.mp3"}) {
+      auto filepath = std::filesystem::temp_directory_path() / name;
+      std::ofstream(filepath, std::ios::binary) << "content from " << name;
+      songs.push_back(filepath.string());
+    }
+  }
+
+  void TearDown() override {
+    cache.reset();
+    std::filesystem::remove_all(directory);
+    for (const auto& song : songs) std::filesystem::remove(song);
+  }
+
+  //! Store song into cache, with a sequence of samples (0, 1, 2, ...)
+  bool StoreSong(const std::string& filepath, int frames = kFrames) {
+    model::Song song{
+        .filepath = filepath,
+        .artist = "Artist",
+        .title = "Title",
+        .num_channels = 2,
+        .sample_rate = 44100,
+        .bit_rate = 256000,
+        .bit_depth = 32,
+        .duration = 3,
+    };
+
+    auto writer = cache->CreateWriter(song, kSampleRate);
+    if (!writer) return false;
+
+    std::vector<float> samples(static_cast<size_t>(frames) * 2);
+    for (size_t i = 0; i < samples.size(); i++) samples[i] = static_cast<float>(i);
+
+    return writer->Write(samples.data(), frames) && cache->Store(std::move(writer));
+  }
+
+  //! Make all entries look like they were used long time ago
+  void ExpireEntries() {
+    auto past = std::filesystem::file_time_type::clock::now() - std::chrono::hours(1);
+    for (const auto& file : std::filesystem::directory_iterator(directory))
+      std::filesystem::last_write_time(file.path(), past);
+  }
+
+  //! Count files in cache directory
+  int CountFiles() const {
+    auto files = std::filesystem::directory_iterator(directory);
+    return static_cast<int>(std::distance(begin(files), end(files)));
+  }
+
+ protected:
+  static constexpr int kSampleRate = 48000;                //!< Output sample rate
+  static constexpr int kFrames = 1000;                     //!< Frames stored for each song
+  static constexpr uintmax_t kMaxSize = 2 * kFrames * 10;  //!< Room for only two songs
+
+  std::filesystem::path directory;          //!< Cache directory
+  std::shared_ptr<driver::PcmCache> cache;  //!< Cache under test
+  std::vector<std::string> songs;           //!< Song files (not really audio, only content)
+};
+
+/* ********************************************************************************************** */
+
+TEST_F(PcmCacheTest, StoreAndFindSong) {
+  EXPECT_EQ(cache->Find(songs[0], kSampleRate), nullptr);
+  ASSERT_TRUE(StoreSong(songs[0]));
+
+  auto entry = cache->Find(songs[0], kSampleRate);
+  ASSERT_NE(entry, nullptr);
+
+  EXPECT_EQ(entry->GetFrames(), kFrames);
+  EXPECT_EQ(entry->GetSampleRate(), kSampleRate);
+  EXPECT_EQ(entry->GetSong().filepath, songs[0]);
+  EXPECT_EQ(entry->GetSong().artist, "Artist");
+  EXPECT_EQ(entry->GetSong().title, "Title");
+  EXPECT_EQ(entry->GetSong().bit_rate, 256000);
+  EXPECT_EQ(entry->GetSong().duration, 3);
+
+  std::vector<float> output(4);
+  EXPECT_EQ(entry->Read(output.data(), 2), 2);
+  EXPECT_THAT(output, ElementsAre(0, 1, 2, 3));
+
+  // Seek goes exactly to the requested frame
+  EXPECT_TRUE(entry->Seek(kFrames - 1));
+  EXPECT_EQ(entry->Read(output.data(), 2), 1);
+  EXPECT_EQ(output[0], 2 * (kFrames - 1));
+  EXPECT_EQ(entry->Read(output.data(), 2), 0);
+
+  EXPECT_FALSE(entry->Seek(kFrames + 1));
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(PcmCacheTest, ModifiedSongIsNotFound) {
+  ASSERT_TRUE(StoreSong(songs[0]));
+
+  // Samples were stored for another output sample rate
+  EXPECT_EQ(cache->Find(songs[0], 44100), nullptr);
+
+  // Song has changed since it was stored
+  std::ofstream(songs[0], std::ios::app) << "tag edited";
+  EXPECT_EQ(cache->Find(songs[0], kSampleRate), nullptr);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(PcmCacheTest, DiscardEntryNotStored) {
+  model::Song song{.filepath = songs[0]};
+  std::vector<float> samples(kFrames * 2);
+
+  auto writer = cache->CreateWriter(song, kSampleRate);
+  ASSERT_NE(writer, nullptr);
+  EXPECT_TRUE(writer->Write(samples.data(), kFrames));
+  EXPECT_EQ(CountFiles(), 1);
+
+  // Song was not decoded until the end, so temporary file is removed
+  writer.reset();
+  EXPECT_EQ(CountFiles(), 0);
+  EXPECT_EQ(cache->Find(songs[0], kSampleRate), nullptr);
+
+  // Song bigger than the whole cache is never stored
+  EXPECT_FALSE(StoreSong(songs[0], 3 * kFrames));
+  EXPECT_EQ(CountFiles(), 0);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(PcmCacheTest, EvictLeastRecentlyUsed) {
+  ASSERT_TRUE(StoreSong(songs[0]));
+  ASSERT_TRUE(StoreSong(songs[1]));
+  ExpireEntries();
+
+  // First song is played again, so the second one becomes the least recently used
+  EXPECT_NE(cache->Find(songs[0], kSampleRate), nullptr);
+
+  ASSERT_TRUE(StoreSong(songs[2]));
+  EXPECT_EQ(CountFiles(), 2);
+
+  EXPECT_NE(cache->Find(songs[0], kSampleRate), nullptr);
+  EXPECT_EQ(cache->Find(songs[1], kSampleRate), nullptr);
+  EXPECT_NE(cache->Find(songs[2], kSampleRate), nullptr);
+}
+
+}  // namespace
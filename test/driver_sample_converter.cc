@@ -0,0 +1,118 @@
+#include <gmock/gmock-matchers.h>  // for StrEq, EXPECT_THAT
+#include <gmock/gmock.h>
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "audio/driver/sample_converter.h"
+
+namespace {
+
+/**
+ * @brief Tests with SampleConverter class
+ */
+class SampleConverterTest : public ::testing::Test {
+ protected:
+  static constexpr float kLsb = 1.f / 32768;  //!< Value from the least significant bit in S16
+  static constexpr size_t kSamples = 100000;  //!< Number of samples for statistical tests
+};
+
+/* ********************************************************************************************** */
+
+TEST_F(SampleConverterTest, KeepExactSamplesWithDither) {
+  driver::SampleConverter converter{/*dither=*/true};
+
+  // Every value from S16 is exactly representable as float, so dither must not touch them
+  std::vector<int16_t> expected(65536);
+  std::iota(expected.begin(), expected.end(), INT16_MIN);
+
+  std::vector<float> input(expected.size());
+  for (size_t i = 0; i < input.size(); i++) input[i] = expected[i] * kLsb;
+
+  std::vector<int16_t> output(input.size());
+  converter.Convert(input.data(), output.data(), input.size());
+
+  EXPECT_EQ(output, expected);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(SampleConverterTest, SaturateOnClipping) {
+  driver::SampleConverter converter;
+
+  const std::vector<float> input{1.5f, -1.5f, 1.f, -1.f};
+
+  std::vector<int16_t> output_s16(input.size());
+  converter.Convert(input.data(), output_s16.data(), input.size());
+
+  EXPECT_THAT(output_s16, ::testing::ElementsAre(INT16_MAX, INT16_MIN, INT16_MAX, INT16_MIN));
+
+  std::vector<int32_t> output_s32(input.size());
+  converter.Convert(input.data(), output_s32.data(), input.size());
+
+  EXPECT_THAT(output_s32, ::testing::ElementsAre(INT32_MAX, INT32_MIN, INT32_MAX, INT32_MIN));
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(SampleConverterTest, DitherPreservesSignalBelowLsb) {
+  // Signal smaller than half LSB disappears when rounded without dither
+  std::vector<float> input(kSamples, 0.25f * kLsb);
+  std::vector<int16_t> output(input.size());
+
+  driver::SampleConverter plain{/*dither=*/false};
+  plain.Convert(input.data(), output.data(), input.size());
+
+  EXPECT_EQ(std::accumulate(output.begin(), output.end(), 0), 0);
+
+  // With TPDF dither, output stays within 1 LSB and its mean matches the original signal
+  driver::SampleConverter dithered{/*dither=*/true};
+  dithered.Convert(input.data(), output.data(), input.size());
+
+  double sum = 0;
+  for (auto sample : output) {
+    ASSERT_GE(sample, -1);
+    ASSERT_LE(sample, 1);
+    sum += sample;
+  }
+
+  EXPECT_NEAR(sum / kSamples, 0.25, 0.01);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(SampleConverterTest, ConvertToS32) {
+  driver::SampleConverter converter;
+
+  const std::vector<float> input{0.f, 0.5f, -0.5f, kLsb};
+  std::vector<int32_t> output(input.size());
+
+  converter.Convert(input.data(), output.data(), input.size());
+
+  EXPECT_THAT(output, ::testing::ElementsAre(0, 1 << 30, -(1 << 30), 1 << 16));
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(SampleConverterTest, ConvertToS24AndFloat) {
+  driver::SampleConverter converter;
+
+  const std::vector<float> input{0.5f, kLsb, 1.5f, -1.5f};
+
+  // S24 is stored in the lower bits from 32 bits
+  std::vector<int32_t> output_s24(input.size());
+  converter.Convert(input.data(), output_s24.data(), input.size(), /*bit_depth=*/24);
+
+  EXPECT_THAT(output_s24, ::testing::ElementsAre(1 << 22, 1 << 8, (1 << 23) - 1, -(1 << 23)));
+
+  // Float samples are only saturated
+  std::vector<float> output_float(input.size());
+  converter.Convert(input.data(), output_float.data(), input.size());
+
+  EXPECT_THAT(output_float, ::testing::ElementsAre(0.5f, kLsb, 1.f, -1.f));
+}
+
+}  // namespace
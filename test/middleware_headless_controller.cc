@@ -0,0 +1,148 @@
+#include <gmock/gmock-matchers.h>  // for ElementsAre, EXPECT_THAT
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "audio/play_queue.h"
+#include "middleware/headless_controller.h"
+#include "mock/audio_control_mock.h"
+#include "mock/interface_notifier_mock.h"
+#include "model/application_error.h"
+#include "model/song.h"
+#include "util/logger.h"
+
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::InSequence;
+using ::testing::StrEq;
+
+/**
+ * @brief Tests with HeadlessController class
+ */
+class HeadlessControllerTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() { util::Logger::GetInstance().Configure(); }
+
+  void SetUp() override {
+    audio_ctl = std::make_shared<AudioControlMock>();
+    queue = std::make_shared<audio::PlayQueue>();
+    controller = middleware::HeadlessController::Create(audio_ctl, queue);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(kDirectory); }
+
+  //! Notify controller that play queue has finished (as done by player)
+  void NotifyFinished() {
+    controller->NotifySongState(model::Song::CurrentInformation{
+        .state = model::Song::MediaState::Finished, .position = 0, .sample_rate = 0});
+  }
+
+ protected:
+  std::shared_ptr<AudioControlMock> audio_ctl;                       //!< Audio player
+  std::shared_ptr<audio::PlayQueue> queue;                           //!< Songs to play
+  std::shared_ptr<middleware::HeadlessController> controller;        //!< Controller under test
+  const std::filesystem::path kDirectory{"/tmp/spectrum_headless"};  //!< Directory with songs
+};
+
+/* ********************************************************************************************** */
+
+TEST_F(HeadlessControllerTest, ListFilesFromDirectory) {
+  std::filesystem::create_directories(kDirectory / "subdirectory");
+  for (const auto& name : {"c.mp3", "a.mp3", "b.wav"}) std::ofstream(kDirectory / name);
+
+  // Only regular files, in alphabetical order
+  EXPECT_THAT(middleware::HeadlessController::ListFiles(kDirectory),
+              ElementsAre(kDirectory / "a.mp3", kDirectory / "b.wav", kDirectory / "c.mp3"));
+
+  // Single file is played as it is
+  EXPECT_THAT(middleware::HeadlessController::ListFiles(kDirectory / "a.mp3"),
+              ElementsAre(kDirectory / "a.mp3"));
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(HeadlessControllerTest, NothingToPlay) {
+  EXPECT_CALL(*audio_ctl, Play).Times(0);
+
+  EXPECT_FALSE(controller->Start());
+
+  // Must not block
+  controller->WaitForCompletion();
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(HeadlessControllerTest, PlayUntilQueueFinishes) {
+  queue->Enqueue("a.mp3");
+  queue->Enqueue("b.mp3");
+
+  // Player advances to the next song by itself, so only the first one is requested
+  EXPECT_CALL(*audio_ctl, Play(StrEq("a.mp3")));
+
+  EXPECT_TRUE(controller->Start());
+
+  NotifyFinished();
+  controller->WaitForCompletion();
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(HeadlessControllerTest, SkipSongsThatFailToPlay) {
+  queue->Enqueue("a.mp3");
+  queue->Enqueue("b.txt");
+  queue->Enqueue("c.mp3");
+
+  InSequence seq;
+  EXPECT_CALL(*audio_ctl, Play(StrEq("a.mp3")));
+  EXPECT_CALL(*audio_ctl, Play(StrEq("b.txt")));
+
+  EXPECT_TRUE(controller->Start());
+
+  // First song fails, so controller asks for the next one
+  controller->NotifyError(error::kInvalidFile);
+
+  // Player plays the remaining song by itself
+  NotifyFinished();
+  controller->WaitForCompletion();
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(HeadlessControllerTest, FinishWhenLastSongFailsToPlay) {
+  queue->Enqueue("a.mp3");
+
+  EXPECT_CALL(*audio_ctl, Play(StrEq("a.mp3")));
+
+  EXPECT_TRUE(controller->Start());
+
+  // There is no other song to play, so it must not block
+  controller->NotifyError(error::kInvalidFile);
+  controller->WaitForCompletion();
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(HeadlessControllerTest, ForwardAudioToAnalysis) {
+  auto analysis = std::make_shared<InterfaceNotifierMock>();
+  controller = middleware::HeadlessController::Create(audio_ctl, queue, analysis);
+
+  std::vector<float> buffer(16, 1.f);
+
+  // Only audio samples and their format are needed to run audio analysis
+  EXPECT_CALL(*analysis, NotifySampleRate(Eq(44100)));
+  EXPECT_CALL(*analysis, NotifyPeriodSize(Eq(1024)));
+  EXPECT_CALL(*analysis, SendAudioRaw(Eq(buffer.data()), Eq(16)));
+
+  controller->NotifySampleRate(44100);
+  controller->NotifyPeriodSize(1024);
+  controller->SendAudioRaw(buffer.data(), static_cast<int>(buffer.size()));
+}
+
+}  // namespace
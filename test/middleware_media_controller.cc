@@ -151,16 +151,20 @@ TEST_F(MediaControllerTest, ExecuteAllMethodsFromAudioNotifier) {
   EXPECT_CALL(*analyzer, Init(Eq(number_bars)));
   notifier->ResizeAnalysisOutput(number_bars);
 
-  int skip_seconds = 25;
-  EXPECT_CALL(*audio_ctl, SeekForwardPosition(Eq(skip_seconds)));
-  notifier->SeekForwardPosition(skip_seconds);
+  int skip_ms = 25000;
+  EXPECT_CALL(*audio_ctl, SeekForwardPosition(Eq(skip_ms)));
+  notifier->SeekForwardPosition(skip_ms);
 
-  EXPECT_CALL(*audio_ctl, SeekBackwardPosition(Eq(skip_seconds)));
-  notifier->SeekBackwardPosition(skip_seconds);
+  EXPECT_CALL(*audio_ctl, SeekBackwardPosition(Eq(skip_ms)));
+  notifier->SeekBackwardPosition(skip_ms);
 
   model::EqualizerPreset preset = model::AudioFilter::CreatePresets()["Custom"];
   EXPECT_CALL(*audio_ctl, ApplyAudioFilters(preset));
   notifier->ApplyAudioFilters(preset);
+
+  std::filesystem::path next_music{"/stairway/to/heaven_live.flac"};
+  EXPECT_CALL(*audio_ctl, SetNextSong(Eq(next_music)));
+  notifier->NotifyNextFileSelection(next_music);
 }
 
 /* ********************************************************************************************** */
@@ -204,6 +208,14 @@ TEST_F(MediaControllerTest, ExecuteAllMethodsFromInterfaceNotifier) {
   // TODO: what should be done on this one?
   //   notifier->SendAudioRaw();
 
+  model::Volume volume{0.35f};
+  EXPECT_CALL(*dispatcher,
+              SendEvent(AllOf(Field(&interface::CustomEvent::id,
+                                    interface::CustomEvent::Identifier::UpdateVolume),
+                              Field(&interface::CustomEvent::content,
+                                    VariantWith<model::Volume>(volume)))));
+  notifier->NotifyVolume(volume);
+
   error::Code error = error::kUnknownError;
   EXPECT_CALL(*dispatcher, SetApplicationError(Eq(error)));
   notifier->NotifyError(error);
@@ -247,7 +259,57 @@ TEST_F(MediaControllerTest, AnalysisOnRawAudio) {
 
     // Send random data to the thread to analyze it
     syncer.WaitForStep(1);
-    std::vector<int> buffer(sample_size, 1);
+    std::vector<float> buffer(sample_size, 1.f);
+    notifier->SendAudioRaw(buffer.data(), buffer.size());
+
+    // Wait for Analysis to finish before exiting from controller
+    syncer.WaitForStep(2);
+    controller->Exit();
+  };
+
+  testing::RunAsyncTest({analysis, client});
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(MediaControllerTest, AnalysisWithoutDispatcher) {
+  int sample_size = 16;
+
+  // Create controller without terminal, as done in headless mode
+  auto an_mock = new AnalyzerMock();
+  EXPECT_CALL(*an_mock, Init(Eq(kNumberBars)));
+
+  controller = middleware::MediaController::Create(nullptr, audio_ctl, kNumberBars, an_mock, false);
+
+  auto analysis = [&](TestSyncer& syncer) {
+    auto analyzer = GetAnalyzer();
+
+    // Setup all expectations
+    InSequence seq;
+
+    EXPECT_CALL(*analyzer, GetBufferSize()).WillOnce(Return(sample_size));
+    EXPECT_CALL(*analyzer, GetOutputSize()).WillOnce(Return(kNumberBars));
+
+    // Audio analysis must still run, even with no UI to send its result
+    EXPECT_CALL(*analyzer, Execute(_, Eq(sample_size), _))
+        .WillOnce(Invoke([&](double*, int, double*) {
+          syncer.NotifyStep(2);
+          return error::kSuccess;
+        }));
+
+    EXPECT_CALL(*dispatcher, SendEvent(_)).Times(0);
+
+    // Notify that expectations are set, and run audio loop
+    syncer.NotifyStep(1);
+    RunAnalysisLoop();
+  };
+
+  auto client = [&](TestSyncer& syncer) {
+    auto notifier = GetInterfaceNotifier();
+
+    // Send random data to the thread to analyze it
+    syncer.WaitForStep(1);
+    std::vector<float> buffer(sample_size, 1.f);
     notifier->SendAudioRaw(buffer.data(), buffer.size());
 
     // Wait for Analysis to finish before exiting from controller
@@ -346,7 +408,7 @@ TEST_F(MediaControllerTest, AnalysisAndClearAnimation) {
 
     // In order to run ClearAnimation, must send some raw data first (to fill internal buffer)
     syncer.WaitForStep(1);
-    std::vector<int> buffer(sample_size, 1);
+    std::vector<float> buffer(sample_size, 1.f);
     notifier->SendAudioRaw(buffer.data(), buffer.size());
 
     // Send a Pause notification to run ClearAnimation
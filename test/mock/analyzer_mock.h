@@ -17,6 +17,8 @@ class AnalyzerMock final : public driver::Analyzer {
   MOCK_METHOD(error::Code, Init, (int), (override));
   MOCK_METHOD(error::Code, Execute, (double *, int, double *), (override));
   MOCK_METHOD(int, GetBufferSize, (), (override));
+  MOCK_METHOD(void, SetPeriodSize, (int), (override));
+  MOCK_METHOD(void, SetSampleRate, (int), (override));
   MOCK_METHOD(int, GetOutputSize, (), (override));
 };
 
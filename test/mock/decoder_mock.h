@@ -19,6 +19,7 @@ namespace {
 class DecoderMock final : public driver::Decoder {
  public:
   MOCK_METHOD(error::Code, OpenFile, (model::Song &), (override));
+  MOCK_METHOD(error::Code, SetOutputFormat, (const model::AudioFormat &, bool), (override));
   MOCK_METHOD(error::Code, Decode, (int, AudioCallback), (override));
   MOCK_METHOD(void, ClearCache, (), (override));
   MOCK_METHOD(error::Code, SetVolume, (model::Volume), (override));
@@ -17,7 +17,10 @@ class InterfaceNotifierMock final : public interface::Notifier {
   MOCK_METHOD(void, ClearSongInformation, (bool), (override));
   MOCK_METHOD(void, NotifySongInformation, (const model::Song &), (override));
   MOCK_METHOD(void, NotifySongState, (const model::Song::CurrentInformation &), (override));
-  MOCK_METHOD(void, SendAudioRaw, (int *, int), (override));
+  MOCK_METHOD(void, SendAudioRaw, (float *, int), (override));
+  MOCK_METHOD(void, NotifyPeriodSize, (int), (override));
+  MOCK_METHOD(void, NotifySampleRate, (int), (override));
+  MOCK_METHOD(void, NotifyVolume, (model::Volume), (override));
   MOCK_METHOD(void, NotifyError, (error::Code), (override));
 };
 
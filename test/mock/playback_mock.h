@@ -16,13 +16,19 @@ class PlaybackMock final : public driver::Playback {
  public:
   MOCK_METHOD(error::Code, CreatePlaybackStream, (), (override));
   MOCK_METHOD(error::Code, ConfigureParameters, (), (override));
+  MOCK_METHOD(bool, IsFormatSupported, (const model::AudioFormat&), (override));
+  MOCK_METHOD(error::Code, SetFormat, (const model::AudioFormat&), (override));
+  MOCK_METHOD(error::Code, SetLatencyProfile, (driver::LatencyProfile), (override));
   MOCK_METHOD(error::Code, Prepare, (), (override));
   MOCK_METHOD(error::Code, Pause, (), (override));
+  MOCK_METHOD(error::Code, Resume, (), (override));
   MOCK_METHOD(error::Code, Stop, (), (override));
   MOCK_METHOD(error::Code, AudioCallback, (void*, int), (override));
   MOCK_METHOD(error::Code, SetVolume, (model::Volume), (override));
   MOCK_METHOD(model::Volume, GetVolume, (), (override));
+  MOCK_METHOD(void, SetVolumeListener, (VolumeListener), (override));
   MOCK_METHOD(uint32_t, GetPeriodSize, (), (const override));
+  MOCK_METHOD(Statistics, GetStatistics, (), (const override));
 };
 
 }  // namespace
@@ -0,0 +1,102 @@
+#include <gmock/gmock-matchers.h>  // for ElementsAre, EXPECT_THAT
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <vector>
+
+#include "util/mapped_file.h"
+
+namespace {
+
+using ::testing::ElementsAre;
+
+/**
+ * @brief Tests with MappedFile class
+ */
+class MappedFileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    filepath = std::filesystem::temp_directory_path() / "spectrum_mapped_file.bin";
+
+    // Fill file with a sequence of bytes (0, 1, 2, ...)
+    std::vector<char> content(kFileSize);
+    std::iota(content.begin(), content.end(), 0);
+
+    std::ofstream file(filepath, std::ios::binary);
+    file.write(content.data(), content.size());
+  }
+
+  void TearDown() override { std::filesystem::remove(filepath); }
+
+ protected:
+  static constexpr size_t kFileSize = 16;  //!< File size in bytes
+
+  std::filesystem::path filepath;  //!< Temporary file
+};
+
+/* ********************************************************************************************** */
+
+TEST_F(MappedFileTest, ReadWholeFile) {
+  auto file = util::MappedFile::Create(filepath.string());
+  ASSERT_NE(file, nullptr);
+  EXPECT_EQ(file->GetSize(), kFileSize);
+
+  std::vector<uint8_t> output(6);
+  EXPECT_EQ(file->Read(output.data(), output.size()), 6);
+  EXPECT_THAT(output, ElementsAre(0, 1, 2, 3, 4, 5));
+  EXPECT_EQ(file->GetPosition(), 6);
+
+  // Only the remaining content is read
+  output.resize(kFileSize);
+  EXPECT_EQ(file->Read(output.data(), output.size()), kFileSize - 6);
+  EXPECT_EQ(output[0], 6);
+  EXPECT_EQ(output[kFileSize - 7], kFileSize - 1);
+
+  // Nothing else to read
+  EXPECT_EQ(file->Read(output.data(), output.size()), 0);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(MappedFileTest, SeekAndRead) {
+  auto file = util::MappedFile::Create(filepath.string());
+  ASSERT_NE(file, nullptr);
+
+  std::vector<uint8_t> output(2);
+
+  EXPECT_EQ(file->Seek(10, SEEK_SET), 10);
+  EXPECT_EQ(file->Read(output.data(), output.size()), 2);
+  EXPECT_THAT(output, ElementsAre(10, 11));
+
+  EXPECT_EQ(file->Seek(-8, SEEK_CUR), 4);
+  EXPECT_EQ(file->Read(output.data(), output.size()), 2);
+  EXPECT_THAT(output, ElementsAre(4, 5));
+
+  EXPECT_EQ(file->Seek(-2, SEEK_END), kFileSize - 2);
+  EXPECT_EQ(file->Read(output.data(), output.size()), 2);
+  EXPECT_THAT(output, ElementsAre(14, 15));
+
+  // Invalid positions must not change the current one
+  EXPECT_EQ(file->Seek(-1, SEEK_SET), -1);
+  EXPECT_EQ(file->Seek(1, SEEK_END), -1);
+  EXPECT_EQ(file->GetPosition(), kFileSize);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(MappedFileTest, FailToMapInvalidFile) {
+  EXPECT_EQ(util::MappedFile::Create("/path/that/does/not/exist"), nullptr);
+
+  // Directory is not a regular file
+  EXPECT_EQ(util::MappedFile::Create(filepath.parent_path().string()), nullptr);
+
+  // Empty file cannot be mapped
+  std::ofstream{filepath, std::ios::trunc}.close();
+  EXPECT_EQ(util::MappedFile::Create(filepath.string()), nullptr);
+}
+
+}  // namespace
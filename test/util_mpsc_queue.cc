@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "util/mpsc_queue.h"
+
+namespace {
+
+/**
+ * @brief Tests with MpscQueue class
+ */
+class MpscQueueTest : public ::testing::Test {
+ protected:
+  static constexpr size_t kCapacity = 8;  //!< Maximum number of elements
+
+  util::MpscQueue<int> queue{kCapacity};  //!< Lock-free queue
+};
+
+/* ********************************************************************************************** */
+
+TEST_F(MpscQueueTest, PushAndPop) {
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_EQ(queue.Front(), nullptr);
+
+  EXPECT_TRUE(queue.Push(1));
+  EXPECT_TRUE(queue.Push(2));
+  EXPECT_FALSE(queue.Empty());
+  EXPECT_EQ(queue.Size(), 2);
+
+  // Front does not consume element
+  ASSERT_NE(queue.Front(), nullptr);
+  EXPECT_EQ(*queue.Front(), 1);
+  EXPECT_EQ(queue.Size(), 2);
+
+  int value = 0;
+  EXPECT_TRUE(queue.Pop(value));
+  EXPECT_EQ(value, 1);
+  EXPECT_TRUE(queue.Pop(value));
+  EXPECT_EQ(value, 2);
+
+  EXPECT_FALSE(queue.Pop(value));
+  EXPECT_TRUE(queue.Empty());
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(MpscQueueTest, PushMoreThanCapacity) {
+  ASSERT_EQ(queue.Capacity(), kCapacity);
+
+  for (size_t i = 0; i < kCapacity; i++) EXPECT_TRUE(queue.Push(static_cast<int>(i)));
+
+  // Queue is full, so element is discarded
+  EXPECT_FALSE(queue.Push(-1));
+
+  // Slots are reused after consumer reads them
+  for (int lap = 0; lap < 3; lap++) {
+    int value = -1;
+    EXPECT_TRUE(queue.Pop(value));
+    EXPECT_TRUE(queue.Push(value));
+  }
+
+  std::vector<int> output;
+  for (int value = 0; queue.Pop(value);) output.push_back(value);
+
+  EXPECT_EQ(output, (std::vector<int>{3, 4, 5, 6, 7, 0, 1, 2}));
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(MpscQueueTest, ConcurrentProducers) {
+  static constexpr int kProducers = 4;
+  static constexpr int kElements = 20000;  //!< Elements pushed by each producer
+
+  std::vector<std::thread> producers;
+  for (int id = 0; id < kProducers; id++) {
+    producers.emplace_back([this, id] {
+      // Element holds producer in the upper bits, and its sequence in the lower bits
+      for (int i = 0; i < kElements; i++) {
+        while (!queue.Push(id << 20 | i)) std::this_thread::yield();
+      }
+    });
+  }
+
+  // Elements from different producers are interleaved, but each one must keep its own order
+  std::vector<int> expected(kProducers, 0);
+  int received = 0;
+
+  while (received < kProducers * kElements) {
+    int value = 0;
+    if (!queue.Pop(value)) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    int id = value >> 20;
+    EXPECT_EQ(value & 0xfffff, expected[id]);
+    expected[id]++;
+    received++;
+  }
+
+  for (auto& producer : producers) producer.join();
+
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_EQ(expected, std::vector<int>(kProducers, kElements));
+}
+
+}  // namespace
@@ -0,0 +1,141 @@
+#include <gmock/gmock-matchers.h>  // for ElementsAre, EXPECT_THAT
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "util/ring_buffer.h"
+
+namespace {
+
+using ::testing::ElementsAre;
+
+/**
+ * @brief Tests with RingBuffer class
+ */
+class RingBufferTest : public ::testing::Test {
+ protected:
+  void SetUp() override { buffer.Resize(kCapacity); }
+
+ protected:
+  static constexpr size_t kCapacity = 8;  //!< Maximum number of elements
+
+  util::RingBuffer<int16_t> buffer;  //!< Lock-free buffer
+};
+
+/* ********************************************************************************************** */
+
+TEST_F(RingBufferTest, WriteAndRead) {
+  const std::vector<int16_t> input{1, 2, 3, 4, 5};
+  EXPECT_EQ(buffer.Write(input.data(), input.size()), 5);
+  EXPECT_EQ(buffer.Size(), 5);
+
+  std::vector<int16_t> output(3);
+  EXPECT_EQ(buffer.Read(output.data(), output.size()), 3);
+  EXPECT_THAT(output, ElementsAre(1, 2, 3));
+  EXPECT_EQ(buffer.Size(), 2);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(RingBufferTest, WriteMoreThanCapacity) {
+  std::vector<int16_t> input(kCapacity + 4);
+  std::iota(input.begin(), input.end(), 0);
+
+  // Only fits until buffer is full
+  EXPECT_EQ(buffer.Write(input.data(), input.size()), kCapacity);
+  EXPECT_EQ(buffer.Write(input.data(), input.size()), 0);
+
+  std::vector<int16_t> output(input.size(), -1);
+  EXPECT_EQ(buffer.Read(output.data(), output.size()), kCapacity);
+  EXPECT_EQ(buffer.Read(output.data(), output.size()), 0);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(RingBufferTest, WrapAround) {
+  std::vector<int16_t> output(kCapacity);
+
+  // Move positions close to the end of internal storage
+  const std::vector<int16_t> first{1, 2, 3, 4, 5, 6};
+  buffer.Write(first.data(), first.size());
+  buffer.Read(output.data(), first.size());
+
+  // This one must be split between the end and the beginning of internal storage
+  const std::vector<int16_t> second{7, 8, 9, 10, 11};
+  EXPECT_EQ(buffer.Write(second.data(), second.size()), second.size());
+
+  output.resize(second.size());
+  EXPECT_EQ(buffer.Read(output.data(), output.size()), second.size());
+  EXPECT_THAT(output, ElementsAre(7, 8, 9, 10, 11));
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(RingBufferTest, FlushKeepsNewContent) {
+  const std::vector<int16_t> old_content{1, 2, 3};
+  buffer.Write(old_content.data(), old_content.size());
+
+  // Producer asks to discard everything written until now, and keeps writing
+  buffer.RequestFlush();
+
+  const std::vector<int16_t> new_content{4, 5};
+  buffer.Write(new_content.data(), new_content.size());
+
+  std::vector<int16_t> output(kCapacity);
+  EXPECT_EQ(buffer.Read(output.data(), output.size()), 2);
+
+  output.resize(2);
+  EXPECT_THAT(output, ElementsAre(4, 5));
+  EXPECT_EQ(buffer.Size(), 0);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(RingBufferTest, ProducerAndConsumerThreads) {
+  static constexpr int16_t kTotal = 10000;
+
+  std::vector<int16_t> received;
+  received.reserve(kTotal);
+
+  // Write a sequence using chunks with odd size, so they often wrap around storage
+  std::thread producer([this] {
+    std::vector<int16_t> chunk(3);
+    for (int16_t value = 0; value < kTotal;) {
+      std::iota(chunk.begin(), chunk.end(), value);
+      size_t count = std::min<size_t>(chunk.size(), kTotal - value);
+
+      // Give consumer a chance to run when buffer is full (e.g. on a single core)
+      size_t written = 0;
+      while (written < count) {
+        written += buffer.Write(chunk.data() + written, count - written);
+        if (written < count) std::this_thread::yield();
+      }
+
+      value += static_cast<int16_t>(count);
+    }
+  });
+
+  std::thread consumer([this, &received] {
+    std::vector<int16_t> chunk(5);
+    while (received.size() < kTotal) {
+      size_t count = buffer.Read(chunk.data(), chunk.size());
+      if (count == 0) std::this_thread::yield();
+
+      received.insert(received.end(), chunk.begin(), chunk.begin() + count);
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  std::vector<int16_t> expected(kTotal);
+  std::iota(expected.begin(), expected.end(), 0);
+
+  EXPECT_EQ(received, expected);
+}
+
+}  // namespace
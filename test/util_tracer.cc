@@ -0,0 +1,88 @@
+#include <gmock/gmock-matchers.h>  // for HasSubstr, StartsWith
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "util/tracer.h"
+
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+using ::testing::StartsWith;
+
+/**
+ * @brief Tests with Tracer class
+ */
+class TracerTest : public ::testing::Test {
+ protected:
+  void TearDown() override {
+    // Tracer is a singleton, so do not let it record events from other tests
+    util::Tracer::GetInstance().Disable();
+    std::filesystem::remove(kTracePath);
+  }
+
+  //! Read whole trace file
+  std::string ReadTraceFile() const {
+    std::ifstream file(kTracePath);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+  }
+
+  const std::string kTracePath{"/tmp/spectrum_tracer_test.json"};  //!< Trace file
+};
+
+/* ********************************************************************************************** */
+
+TEST_F(TracerTest, NothingRecordedWhileDisabled) {
+  auto& tracer = util::Tracer::GetInstance();
+  EXPECT_FALSE(tracer.IsEnabled());
+
+  // Call is still made, but nothing is recorded
+  EXPECT_EQ(TRACE_CALL("disabled_call", 6 * 7), 42);
+  { TRACE_SCOPE("disabled_scope"); }
+
+  std::stringstream out;
+  tracer.Write(out);
+
+  EXPECT_THAT(out.str(), Not(HasSubstr("disabled_call")));
+  EXPECT_THAT(out.str(), Not(HasSubstr("disabled_scope")));
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(TracerTest, DumpEventsFromEveryThread) {
+  auto& tracer = util::Tracer::GetInstance();
+  tracer.Configure(kTracePath);
+  ASSERT_TRUE(tracer.IsEnabled());
+
+  EXPECT_EQ(TRACE_CALL("main_call", 6 * 7), 42);
+
+  std::thread worker([] { TRACE_SCOPE("worker_scope"); });
+  worker.join();
+
+  tracer.Disable();
+  ASSERT_TRUE(tracer.Dump());
+
+  std::string content = ReadTraceFile();
+
+  // Each event is a complete event (with begin and duration), tagged with the thread recording it
+  EXPECT_THAT(content, StartsWith("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+  EXPECT_THAT(content, HasSubstr("{\"name\":\"main_call\",\"cat\":\"audio\",\"ph\":\"X\""));
+  EXPECT_THAT(content, HasSubstr("{\"name\":\"worker_scope\",\"cat\":\"audio\",\"ph\":\"X\""));
+
+  auto tid = [&content](const std::string& name) {
+    size_t event = content.find("\"name\":\"" + name + "\"");
+    size_t begin = content.find("\"tid\":", event) + 6;
+    return content.substr(begin, content.find(',', begin) - begin);
+  };
+
+  EXPECT_NE(tid("main_call"), tid("worker_scope"));
+}
+
+}  // namespace